@@ -29,6 +29,7 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <stdexcept>
@@ -47,11 +48,15 @@ namespace nami {
     out << "Header: {rows: " << header.rows 
         << ", cols: "        << header.cols 
         << ", level: "       << header.level 
+        << ", transform level: " << header.transform_level
         << ", scale: "       << header.scale
         << ", mean: "        << header.mean
         << ", threshold: "   << header.threshold
         << ", encoding: "    << header.enc_type
         << ", blocks: "      << header.blocks
+        << ", frames: "      << header.frames
+        << ", packet depth: " << header.basis.depth()
+        << ", tiled: "       << header.tiled
         << ", ezw_size: "    << header.ezw_size
         << ", rle_size: "    << header.rle_size
         << ", enc_size: "    << header.enc_size
@@ -95,10 +100,24 @@ namespace nami {
   }  
   
 
+  /// Set in the encoding byte of headers for volumes.
+  static const unsigned char volume_flag = 0x80;
+
+  /// Set in the encoding byte of headers for data in a wavelet packet basis.
+  static const unsigned char packet_flag = 0x40;
+
+  /// Set in the encoding byte of headers of tiled data.
+  static const unsigned char tiled_flag = 0x20;
+
+  /// Set in the encoding byte of headers whose transform went deeper than its 
+  /// zerotrees, e.g. for sides not divisible by 2 as often.
+  static const unsigned char deep_flag = 0x10;
+
+
   ezw_header::ezw_header(size_t r, size_t c, int l, quantized_t m, unsigned long long s, quantized_t t, 
-                         encoding_t et, size_t b, size_t p) 
-    : rows(r), cols(c), level(l), mean(m), scale(s), threshold(t), enc_type(et), blocks(b), 
-      passes(p), ezw_size(0), rle_size(0), enc_size(0)
+                         encoding_t et, size_t b, size_t p, size_t f) 
+    : rows(r), cols(c), level(l), transform_level(l), mean(m), scale(s), threshold(t), enc_type(et), blocks(b), 
+      passes(p), frames(f), tiled(false), ezw_size(0), rle_size(0), enc_size(0)
   { 
     if (threshold && (threshold & (threshold-1))) {
       cerr << "Error: threshold is not power of 2: " << threshold << endl;
@@ -121,9 +140,25 @@ namespace nami {
     out.write((char*)&log2_thresh, 1);
     size += 1;
 
+    // the high bits of the encoding byte mark a volume, whose frame count follows,
+    // a packet basis, whose tree follows, tiled data, and a transform deeper than the 
+    // zerotrees, whose level follows.  Pyramid matrices are written exactly as before.
     unsigned char et = (unsigned char)enc_type;
+    if (frames > 1) et |= volume_flag;
+    if (!basis.empty()) et |= packet_flag;
+    if (tiled) et |= tiled_flag;
+    if (transform_level != level) et |= deep_flag;
     out.write((char*)&et, 1);
     size += 1;
+    if (frames > 1) {
+      size += io_utils::vl_write(out, frames);
+    }
+    if (!basis.empty()) {
+      size += basis.write_out(out);
+    }
+    if (transform_level != level) {
+      size += io_utils::vl_write(out, transform_level);
+    }
 
     size += io_utils::vl_write(out, blocks);
     size += io_utils::vl_write(out, passes);
@@ -155,7 +190,15 @@ namespace nami {
 
     unsigned char enc_type;
     in.read((char*)&enc_type, 1);
-    header.enc_type = (encoding_t)enc_type;
+    header.enc_type = (encoding_t)(enc_type & ~(volume_flag | packet_flag | tiled_flag | deep_flag));
+    header.tiled = (enc_type & tiled_flag) != 0;
+    header.frames = (enc_type & volume_flag) ? io_utils::vl_read(in) : 1;
+    if (enc_type & packet_flag) {
+      packet_tree::read_in(in, header.basis);
+    } else {
+      header.basis = packet_tree();
+    }
+    header.transform_level = (enc_type & deep_flag) ? io_utils::vl_read(in) : header.level;
     
     header.blocks = io_utils::vl_read(in);
     header.passes = io_utils::vl_read(in);
@@ -166,4 +209,106 @@ namespace nami {
   }
 
 
+
+  packet_zerotree::packet_zerotree(const packet_tree& basis, size_t rows, size_t cols) 
+    : basis_(basis), bands_(basis.size(), subband(0, 0, rows, cols)), links_(basis.size())
+  {
+    find_bands(0, subband(0, 0, rows, cols));
+
+    // nodes along the pyramid in the basis, from the whole matrix to the roots.
+    const int level = basis_.pyramid_level();
+    vector<size_t> low(1, 0);
+    for (int i=0; i < level; i++) {
+      low.push_back(basis_.child(low.back(), 0));
+    }
+    low_rows_ = bands_[low.back()].rows;
+    low_cols_ = bands_[low.back()].cols;
+
+    // roots parent the other bands of the coarsest level in place, then each 
+    // band parents its counterpart one level finer.
+    if (level > 0) {
+      for (int q=1; q < 4; q++) {
+        same_scale(low[level], basis_.child(low[level-1], q));
+      }
+    }
+    for (int i=level-1; i > 0; i--) {
+      for (int q=1; q < 4; q++) {
+        scale_up(basis_.child(low[i], q), basis_.child(low[i-1], q));
+      }
+    }
+  }
+
+
+  void packet_zerotree::find_bands(size_t node, const subband& band) {
+    bands_[node] = band;
+    if (basis_.split(node)) {
+      for (int q=0; q < 4; q++) {
+        find_bands(basis_.child(node, q), band.quadrant(q));
+      }
+    }
+  }
+
+
+  // coarse and fine are the same size.
+  void packet_zerotree::same_scale(size_t coarse, size_t fine) {
+    if (basis_.split(coarse) && basis_.split(fine)) {
+      for (int q=0; q < 4; q++) {
+        same_scale(basis_.child(coarse, q), basis_.child(fine, q));
+      }
+    } else if (basis_.split(coarse)) {
+      add_low_link(basis_.child(coarse, 0), fine, 2);
+    } else {
+      links_[coarse].push_back(link(fine, 1));
+    }
+  }
+
+
+  // fine is twice the size of coarse.
+  void packet_zerotree::scale_up(size_t coarse, size_t fine) {
+    if (basis_.split(fine)) {
+      for (int q=0; q < 4; q++) {
+        same_scale(coarse, basis_.child(fine, q));
+      }
+    } else {
+      add_low_link(coarse, fine, 2);
+    }
+  }
+
+
+  // fine is <factor> times the size of coarse.
+  void packet_zerotree::add_low_link(size_t coarse, size_t fine, size_t factor) {
+    while (basis_.split(coarse)) {
+      coarse = basis_.child(coarse, 0);
+      factor <<= 1;
+    }
+    links_[coarse].push_back(link(fine, factor));
+  }
+
+
+  void packet_zerotree::children(const dom_elt& e, vector<dom_elt>& children) const {
+    // find the leaf holding e.
+    size_t node = 0;
+    while (basis_.split(node)) {
+      const bool high_row = (e.row >= bands_[basis_.child(node, 2)].row);
+      const bool high_col = (e.col >= bands_[basis_.child(node, 1)].col);
+      node = basis_.child(node, (high_row ? 2 : 0) | (high_col ? 1 : 0));
+    }
+
+    const subband& src = bands_[node];
+    const vector<link>& links = links_[node];
+    for (size_t i=0; i < links.size(); i++) {
+      const subband& dst = bands_[links[i].dst];
+      const size_t f = links[i].factor;
+      const size_t row = (e.row - src.row) * f;
+      const size_t col = (e.col - src.col) * f;
+      if (row >= dst.rows || col >= dst.cols) continue;
+
+      for (size_t r=row; r < min(row + f, dst.rows); r++) {
+        for (size_t c=col; c < min(col + f, dst.cols); c++) {
+          children.push_back(dom_elt(dst.row + r, dst.col + c, e.level + 1));
+        }
+      }
+    }
+  }
+
 } // namespace
@@ -34,6 +34,11 @@
 
 #include <climits>
 #include <deque>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "packet_tree.h"
 
 namespace nami {
 
@@ -42,6 +47,13 @@ namespace nami {
   
   /// Minimum value of a quantized_t; be sure to keep this synced.
   const quantized_t Q_MIN = LONG_LONG_MIN;  
+
+  /// Maximum value of a quantized_t; be sure to keep this synced.
+  const quantized_t Q_MAX = LONG_LONG_MAX;  
+
+  /// Matrix of quantized values.  The coder works on these internally, and 
+  /// integer transforms (see wt_int53.h) produce them directly.
+  typedef boost::numeric::ublas::matrix<quantized_t> quantized_matrix;
   
   /// Possible types of encoding to use for encoding after rle-encoding ezw data 
   typedef enum { NONE, RLE, HUFFMAN } encoding_t;
@@ -56,23 +68,27 @@ namespace nami {
     // initialized fields (set in constructor)
     size_t rows;               ///< Rows in encoded matrix
     size_t cols;               ///< Cols in encoded matrix
-    size_t level;              ///< Level of wavelet transform and ezw coding done on data
+    size_t level;              ///< Level of ezw coding done on data: the zerotrees' depth
+    size_t transform_level;    ///< Level of wavelet transform done on data; at least level
     quantized_t mean;          ///< Mean of data in this file (subtracted out before encoding)
     unsigned long long scale;  ///< Scaling factor applied to data before encoding
     quantized_t threshold;     ///< Initial ezw threshold for data in this file.
     encoding_t enc_type;       ///< Type of encoding used on rle buffer.
     size_t blocks;             ///< For parallel encoding -- count of independently encoded blocks
     size_t passes;             ///< Needed for block coding: total number of ezw passes encoded.
+    size_t frames;             ///< Frames in an encoded volume; 1 for a matrix.
+    packet_tree basis;         ///< Wavelet packet basis of the data; empty for the pyramid.
+    bool tiled;                ///< True if a tile directory and tiles follow; see tiled_ezw.h
 
     // un-initialized fields (must be set manually)
     size_t ezw_size;        ///< Size of ezw-encoded bitstream
     size_t rle_size;        ///< Size of ezw after rle coding
     size_t enc_size;        ///< Size of fully encoded rle buffer
 
-    ezw_header() { }
+    ezw_header() : frames(1), tiled(false) { }
 
     ezw_header(size_t r, size_t c, int l, quantized_t m, unsigned long long s, quantized_t t, 
-               encoding_t et = HUFFMAN, size_t b = 1, size_t p = 0);
+               encoding_t et = HUFFMAN, size_t b = 1, size_t p = 0, size_t f = 1);
     
     size_t write_out(std::ostream& out);
     static void read_in(std::istream& in, ezw_header& header);
@@ -129,7 +145,8 @@ namespace nami {
       if (code == STOP) return false;
 
       if (e.level == 0) {
-        // put children of level zero values on the queue
+        // put children of level zero values on the queue, if data was transformed.
+        if (low_rows == rows) continue;
         dom_queue.push_back(dom_elt(e.row,          e.col+low_cols, 1));
         dom_queue.push_back(dom_elt(e.row+low_rows, e.col,          1));
         dom_queue.push_back(dom_elt(e.row+low_rows, e.col+low_cols, 1));
@@ -176,7 +193,8 @@ namespace nami {
       if (code == STOP) return false;
 
       if (e.level == 0) {
-        // put children of level zero values on the queue
+        // put children of level zero values on the queue, if data was transformed.
+        if (low_rows == rows) continue;
         dom_queue.push_back(dom_elt(e.row+low_rows, e.col+low_cols, 1));
         dom_queue.push_back(dom_elt(e.row+low_rows, e.col,          1));
         dom_queue.push_back(dom_elt(e.row,          e.col+low_cols, 1));
@@ -199,6 +217,154 @@ namespace nami {
   }
 
 
+  /// Depth-first traversal of 3d zerotrees, for volumes from wt_3d.  The volume has
+  /// <frames> frames of rows x cols values, stacked in one matrix so that value 
+  /// (r, c) of frame f is at row f*rows + r; dom_elts use those stacked rows.  
+  /// Roots are the low_rows x low_cols x low_frames cube of lowest frequencies.  A
+  /// root's children are the values at its place in the 7 other subbands of the
+  /// coarsest level, and every other value has 8 children at twice its coordinates.
+  template <class Visitor>
+  bool depth_first_traversal_3d(Visitor visitor, size_t low_rows, size_t low_cols, 
+                                size_t low_frames, size_t rows, size_t cols, size_t frames) {
+    std::deque<dom_elt> dom_queue;
+
+    // queue up work for lowest frequency level
+    for (long long f=low_frames-1; f >= 0; f--) {
+      for (long long r=low_rows-1; r >= 0; r--) {
+        for (long long c=low_cols-1; c >= 0; c--) {
+          dom_queue.push_back(dom_elt(f*rows + r, c, 0));
+        }
+      }
+    }
+
+    while (!dom_queue.empty()) {
+      dom_elt e = dom_queue.back();
+      dom_queue.pop_back();
+
+      ezw_code code = visitor(e);
+      if (code == STOP) return false;
+
+      const size_t f = e.row / rows;
+      const size_t r = e.row % rows;
+
+      if (e.level == 0) {
+        // put children of level zero values on the queue, if data was transformed.
+        // Bit 2 of k picks the high temporal band, bit 1 rows, and bit 0 columns.
+        if (low_rows == rows) continue;
+        for (int k=7; k > 0; k--) {
+          const size_t cf = f     + ((k & 4) ? low_frames : 0);
+          const size_t cr = r     + ((k & 2) ? low_rows   : 0);
+          const size_t cc = e.col + ((k & 1) ? low_cols   : 0);
+          dom_queue.push_back(dom_elt(cf*rows + cr, cc, 1));
+        }
+
+      } else if (code != ZERO_TREE) {
+        // put children of this value on the queue.
+        const size_t frame = f << 1;
+        const size_t row   = r << 1;
+        const size_t col   = e.col << 1;
+
+        if (frame < frames && row < rows && col < cols) {
+          for (int k=7; k >= 0; k--) {
+            const size_t cf = frame + ((k >> 2) & 1);
+            const size_t cr = row   + ((k >> 1) & 1);
+            dom_queue.push_back(dom_elt(cf*rows + cr, col + (k & 1), e.level + 1));
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+
+  /// Parent/child relation of zerotrees over a wavelet packet basis (see 
+  /// packet_tree.h).  As in the pyramid, a subband's children are the subband of 
+  /// the same orientation one scale finer, i.e. with the leading low-low split 
+  /// dropped from its path in the tree, and roots are the low-low band.  A packet 
+  /// basis may split those bands differently, so the relation follows both trees:
+  ///
+  ///  - where the finer band is split, its quadrants are each children of the 
+  ///    coarser band, one value per value;
+  ///  - where the coarser band is split further than the finer one, the low-low 
+  ///    leaf within it is the parent, with a block of children per value, which 
+  ///    keeps children at the same place in the signal as their parents;
+  ///  - a leaf whose counterpart is split into coarser bands parents them one 
+  ///    value per value, in place.
+  ///
+  /// For a pyramid basis this is exactly the relation of depth_first_traversal().
+  /// The basis must split only even lengths, so that sizes halve exactly.
+  class packet_zerotree {
+  public:
+    /// Empty relation, with no values.
+    packet_zerotree() : low_rows_(0), low_cols_(0) { }
+
+    /// Relation for a rows x cols matrix in basis.
+    packet_zerotree(const packet_tree& basis, size_t rows, size_t cols);
+
+    /// True if there are no values.
+    bool empty() const { return bands_.empty(); }
+
+    size_t low_rows() const { return low_rows_; }   ///< Rows of roots
+    size_t low_cols() const { return low_cols_; }   ///< Columns of roots
+
+    /// Appends the children of e to children, in coding order.
+    void children(const dom_elt& e, std::vector<dom_elt>& children) const;
+
+  private:
+    /// Values of a leaf have factor x factor blocks of children in node dst.
+    struct link {
+      size_t dst;
+      size_t factor;
+      link(size_t d, size_t f) : dst(d), factor(f) { }
+    };
+
+    packet_tree basis_;                        ///< Basis of the coded values
+    std::vector<subband> bands_;               ///< Subband of each node of basis_
+    std::vector<std::vector<link> > links_;    ///< Links from each leaf of basis_
+    size_t low_rows_;
+    size_t low_cols_;
+
+    void find_bands(size_t node, const subband& band);
+    void same_scale(size_t coarse, size_t fine);
+    void scale_up(size_t coarse, size_t fine);
+    void add_low_link(size_t coarse, size_t fine, size_t factor);
+  };
+
+
+  /// Depth-first traversal of zerotrees over a wavelet packet basis.
+  /// @see packet_zerotree, depth_first_traversal()
+  template <class Visitor>
+  bool depth_first_traversal_packet(Visitor visitor, const packet_zerotree& trees) {
+    std::deque<dom_elt> dom_queue;
+    std::vector<dom_elt> children;
+
+    // queue up work for lowest frequency level
+    for (long long r=trees.low_rows()-1; r >= 0; r--) {
+      for (long long c=trees.low_cols()-1; c >= 0; c--) {
+        dom_queue.push_back(dom_elt(r, c, 0));
+      }
+    }
+
+    while (!dom_queue.empty()) {
+      dom_elt e = dom_queue.back();
+      dom_queue.pop_back();
+
+      ezw_code code = visitor(e);
+      if (code == STOP) return false;
+
+      // as in the pyramid, children of level zero values are always visited.
+      if (e.level == 0 || code != ZERO_TREE) {
+        children.clear();
+        trees.children(e, children);
+        for (size_t i=children.size(); i > 0; i--) {
+          dom_queue.push_back(children[i-1]);
+        }
+      }
+    }
+    return true;
+  }
+
+
   /// Dominant pass of EZW algorithm.  Needs to do the same traversal in the
   /// encoder and the decoder.  Both call this method.
   /// See Shapiro, 1993 for info.
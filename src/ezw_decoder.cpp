@@ -31,6 +31,8 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 #include <iostream>
 #include <fstream>
+#include <cassert>
+#include <stdexcept>
 
 #include "rle.h"
 #include "huffman.h"
@@ -53,7 +55,7 @@ using namespace std;
 
 namespace nami {
   
-  ezw_decoder::ezw_decoder() : pass_limit_(0), byte_budget_(0), bytes_read_(0) { }
+  ezw_decoder::ezw_decoder() : pass_limit_(0), byte_budget_(0), bytes_read_(0), frames_(1) { }
 
 
   ezw_decoder::~ezw_decoder() { }
@@ -148,13 +150,99 @@ namespace nami {
   }
   
   
+  template <class T>
+  void ezw_decoder::rescale(T *data, size_t pitch, const ezw_header& header) {
+    double invScale = 1.0/header.scale;
+    for (size_t i=0; i < quantized_.size1(); i++) {
+      T *row = data + i * pitch;
+      for (size_t j=0; j < quantized_.size2(); j++) {
+        row[j] = (quantized_(i,j) + header.mean) * invScale;
+      }
+    }
+  }
+
+
   int ezw_decoder::decode(istream& in, nami_matrix& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    mat.resize(quantized_.size1(), quantized_.size2(), false);
+    rescale(mat.data().begin(), mat.size2(), header);   // re-scale output values and put the mean back in.
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, nami_matrix_f& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    mat.resize(quantized_.size1(), quantized_.size2(), false);
+    rescale(mat.data().begin(), mat.size2(), header);
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, padded_matrix& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    mat.resize(quantized_.size1(), quantized_.size2());
+    rescale(mat.data(), mat.pitch(), header);
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, padded_matrix_f& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    mat.resize(quantized_.size1(), quantized_.size2());
+    rescale(mat.data(), mat.pitch(), header);
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, const matrix_view& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    assert(mat.size1() == quantized_.size1() && mat.size2() == quantized_.size2());
+    rescale(mat.data(), mat.pitch(), header);
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, const matrix_view_f& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, quantized_, level, existing_header, header);
+    assert(mat.size1() == quantized_.size1() && mat.size2() == quantized_.size2());
+    rescale(mat.data(), mat.pitch(), header);
+    return level;
+  }
+
+
+  int ezw_decoder::decode(istream& in, quantized_matrix& mat, int level, const ezw_header *existing_header) {
+    ezw_header header;
+    level = decode_quantized(in, mat, level, existing_header, header);
+
+    // put the mean back in.
+    for (size_t i=0; i < mat.size1(); i++) {
+      for (size_t j=0; j < mat.size2(); j++) {
+        mat(i,j) += header.mean;
+      }
+    }
+
+    return level;
+  }
+
+
+  int ezw_decoder::decode_quantized(istream& in, quantized_matrix& mat, int level, 
+                                    const ezw_header *existing_header, ezw_header& my_header) {
     // if the caller didn't pass in a header (that he's read already) then read it in.
-    ezw_header my_header;
     const ezw_header *header = existing_header;
     if (!existing_header) {
       ezw_header::read_in(in, my_header);
       header = &my_header;
+    } else {
+      my_header = *existing_header;
+    }
+    if (header->tiled) {
+      throw runtime_error("Error: data is tiled; decode it with tiled_ezw_decoder.");
     }
 
     // how many passes to actually process from the input.
@@ -169,18 +257,36 @@ namespace nami {
     if (!low_cols) low_cols = 1;
     
     // figure out how many frequency bands to decode into the matrix.
-    // This affects the size of the output.
-    if (level < 0) level = header->level;
-    mat.resize(low_rows << level, low_cols << level);
+    // This affects the size of the output.  Volumes are decoded whole, with their
+    // frames stacked.
+    frames_ = header->frames;
+    basis_ = header->basis;
+    if (level < 0 || frames_ > 1 || !basis_.empty()) level = header->level;
+    mat.resize((low_rows << level) * frames_, low_cols << level);
+
+    // levels of the transform past the zerotrees are all in the lowest band, so 
+    // they're undone along with the levels decoded.
+    const int inverse_level = level + (header->transform_level - header->level);
 
     mat.clear();
     decoded_ = &mat;  // set up decoded for dom and sub pass to use.
 
+    // a constant matrix codes to no bits at all: every value is the mean.
+    if (!header->ezw_size) {
+      in.ignore((header->enc_type == HUFFMAN) ? header->enc_size : header->rle_size);
+      bytes_read_ = 0;
+      return inverse_level;
+    }
+
     vector<unsigned char> bit_buffer(header->ezw_size);
     initial_decode(bit_buffer, in, *header);
     vector_ibitstream ibits(&bit_buffer[0], header->ezw_size);
 
     decode_visitor visitor(this, ibits);
+    packet_zerotree trees;
+    if (!basis_.empty()) {
+      trees = packet_zerotree(basis_, header->rows, header->cols);
+    }
     radix_iterator r(header->blocks);
     while (r.has_next()) {
       size_t block = r.next();
@@ -189,10 +295,17 @@ namespace nami {
       size_t pass_count = 0;
       
       while (threshold_ && ibits.good() && (!passes || pass_count < passes)) {
-        if (!dominant_pass(visitor, low_rows, low_cols, 
-                           header->rows, header->cols, header->blocks, block)) {
-          break;
+        bool more;
+        if (!trees.empty()) {
+          more = depth_first_traversal_packet(visitor, trees);
+        } else if (frames_ > 1) {
+          more = depth_first_traversal_3d(visitor, low_rows, low_cols, frames_ >> header->level,
+                                          header->rows, header->cols, frames_);
+        } else {
+          more = dominant_pass(visitor, low_rows, low_cols, 
+                               header->rows, header->cols, header->blocks, block);
         }
+        if (!more) break;
         DBG_OUT(endl);
 
         threshold_ >>= 1;
@@ -210,18 +323,9 @@ namespace nami {
       sub_list_.clear();     // clear this out for next time.
     }
 
-    // re-scale output values and put the mean back in.
-    double invScale = 1.0/header->scale;
-    for (size_t i=0; i < mat.size1(); i++) {
-      for (size_t j=0; j < mat.size2(); j++) {
-        mat(i,j) += header->mean;
-        mat(i,j) *= invScale;
-      }
-    }
-    
     bytes_read_ = ibits.in_bytes();
     
-    return level;
+    return inverse_level;
   }
 
   
@@ -248,6 +352,14 @@ namespace nami {
     return bytes_read_;
   }
 
+  size_t ezw_decoder::frames() {
+    return frames_;
+  }
+
+  const packet_tree& ezw_decoder::basis() {
+    return basis_;
+  }
+
 
 } //namespace
 
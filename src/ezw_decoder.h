@@ -56,20 +56,60 @@ namespace nami {
 
     /// Takes an EZW-encoded input stream and reads it into the provided
     /// matrix.  Returns the level of the transform that was applied
-    /// to the output data.
+    /// to the output data.  A volume's frames are decoded stacked one above 
+    /// the other (see basic_volume_view), and frames() gives their number.
+    /// Data coded in a wavelet packet basis is decoded in that basis, which 
+    /// basis() returns; undo it with wt_packet::iwt_packet().
     ///
     /// @param in            EZW-encoded stream.
     /// @param mat           Matrix for output data.  Will be resized to fit.
     /// @param level         If non-negative, produces a smaller output matrix with only the first <level>
     ///                      low-frequency bands.  Levels should be at most header->level (that is, 
-    ///                      the level of transform that encoded the data)
+    ///                      the level of transform that encoded the data).  Volumes and packet
+    ///                      bases are always decoded whole.
     /// @param header        Provide the header if it has already been read in.
     /// 
-    /// @return level of inverse transform to apply to decoded data.
+    /// @return level of inverse transform to apply to decoded data.  This counts 
+    ///         levels of the transform that the zerotrees don't span, e.g. for sides
+    ///         not divisible by 2 as often as the transform went deep.
     /// 
     /// TODO: move approx level to a setter for consistency
     int decode(std::istream& in, nami_matrix& mat, int level = -1, 
                const ezw_header *header = NULL);
+
+    /// Decodes into a single-precision matrix, e.g. for the inverse of wt_lift_f.
+    /// @see decode(std::istream&, nami_matrix&, int, const ezw_header*)
+    int decode(std::istream& in, nami_matrix_f& mat, int level = -1, 
+               const ezw_header *header = NULL);
+
+    /// Decodes into a padded matrix.
+    /// @see decode(std::istream&, nami_matrix&, int, const ezw_header*)
+    int decode(std::istream& in, padded_matrix& mat, int level = -1, 
+               const ezw_header *header = NULL);
+
+    /// Decodes into a padded single-precision matrix.
+    /// @see decode(std::istream&, nami_matrix&, int, const ezw_header*)
+    int decode(std::istream& in, padded_matrix_f& mat, int level = -1, 
+               const ezw_header *header = NULL);
+
+    /// Decodes into memory that mat views, e.g. an application's own buffer.  A view
+    /// can't be resized, so it must already be the size of the decoded output.
+    /// @see decode(std::istream&, nami_matrix&, int, const ezw_header*)
+    int decode(std::istream& in, const matrix_view& mat, int level = -1, 
+               const ezw_header *header = NULL);
+
+    /// Decodes into a view of a single-precision matrix.
+    /// @see decode(std::istream&, const matrix_view&, int, const ezw_header*)
+    int decode(std::istream& in, const matrix_view_f& mat, int level = -1, 
+               const ezw_header *header = NULL);
+
+    /// Decodes integer coefficients, e.g. for the inverse of wt_int53.  Output is
+    /// the coded values with the mean added back; the header's scale is not applied.
+    /// With no pass limit, this is bit-exact for data encoded from a quantized_matrix.
+    /// 
+    /// @see decode(std::istream&, nami_matrix&, int, const ezw_header*)
+    int decode(std::istream& in, quantized_matrix& mat, int level = -1, 
+               const ezw_header *header = NULL);
     
     size_t pass_limit();
     void   set_pass_limit(size_t limit);
@@ -78,15 +118,26 @@ namespace nami {
     void   set_byte_budget(size_t budget);
     
     size_t bytes_read();
+
+    /// Frames in the last stream decoded: 1 for a matrix, or the number of frames 
+    /// in a volume from wt_3d.
+    size_t frames();
+
+    /// Wavelet packet basis of the last stream decoded; empty unless it was coded
+    /// in a packet basis.
+    const packet_tree& basis();
     
   protected:
-    nami_matrix *decoded_;                 ///< Pointer to the destination matrix
+    quantized_matrix *decoded_;          ///< Pointer to the destination matrix
+    quantized_matrix quantized_;         ///< Decoded values, before scaling back to doubles
     quantized_t threshold_;              ///< Current threshold for the coder.
     std::vector<sub_elt> sub_list_;      ///< accumulated subordinate pass coefficients
 
     size_t pass_limit_;                  ///< Limit on number of passes to decode
     size_t byte_budget_;                 ///< Limit on number of passes to decode
     size_t bytes_read_;                  ///< Bytes read by last call to decode()
+    size_t frames_;                      ///< Frames in last call to decode()
+    packet_tree basis_;                  ///< Packet basis in last call to decode()
 
     /// EZW-codes a single value according to the current threshold.  Appends to
     /// dom_queue or sub_list as necessary.
@@ -95,6 +146,16 @@ namespace nami {
     /// Subordinate pass of EZW algorithm.  ee Shapiro, 1993 for info.
     bool subordinate_pass(ibitstream& in);
 
+    /// Decodes into mat without adding the mean or scaling.  Used by both decode() 
+    /// calls.  Returns the level of the output and sets header to the one read.
+    int decode_quantized(std::istream& in, quantized_matrix& mat, int level, 
+                         const ezw_header *existing_header, ezw_header& header);
+
+    /// Scales decoded values in quantized_ back into the matrix at data, whose rows
+    /// are <pitch> values apart, and puts the mean back in.
+    template <class T>
+    void rescale(T *data, size_t pitch, const ezw_header& header);
+
     /// Gets RLE encoded data out of file based on encoding info
     void initial_decode(std::vector<unsigned char>& dest, std::istream& in, const ezw_header& header);
     
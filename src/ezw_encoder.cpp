@@ -29,6 +29,7 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////////////////////////////
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -41,6 +42,8 @@
 
 #include "ezw_encoder.h"
 #include "matrix_utils.h"
+#include "wt_lift.h"
+#include "wt_stream.h"
 #include "wt_utils.h"
 #include "io_utils.h"
 #include "two_utils.h"
@@ -57,26 +60,89 @@ using namespace std;
 
 namespace nami {
 
-  ezw_encoder::ezw_encoder() : pass_limit_(0), scale_(1), enc_type_(HUFFMAN) { }
+  ezw_encoder::ezw_encoder() 
+    : sum_(0), min_(Q_MAX), max_(Q_MIN), frames_(1), pass_limit_(0), scale_(1), 
+      enc_type_(HUFFMAN) { }
 
   ezw_encoder::~ezw_encoder() { }
 
+
+  /// Quantizes n values into out, adding them to sum and widening [lo, hi] to 
+  /// hold them.
+  template <class T>
+  static inline void quantize_values(const T *values, size_t n, quantized_t scale, 
+                                     quantized_t *out, quantized_t& sum, 
+                                     quantized_t& lo, quantized_t& hi) {
+    for (size_t i=0; i < n; i++) {
+      const quantized_t q = isnan(values[i]) ? 0 : (quantized_t)round(values[i] * scale);
+      out[i] = q;
+      sum += q;
+      lo = min(lo, q);
+      hi = max(hi, q);
+    }
+  }
+
+
+  template <class T>
+  struct ezw_encoder::quantize_sink : public basic_row_sink<T> {
+    ezw_encoder *parent;
+    quantized_t scale;
+
+    quantize_sink(ezw_encoder *p, size_t rows, size_t cols, quantized_t s) 
+      : parent(p), scale(s) {
+      if (parent->quantized_.size1() != rows || parent->quantized_.size2() != cols) {
+        parent->quantized_.resize(rows, cols);
+      }
+      parent->frames_ = 1;
+      parent->sum_ = 0;
+      parent->min_ = Q_MAX;
+      parent->max_ = Q_MIN;
+    }
+
+    void write_row(size_t row, size_t col, const T *values, size_t n) {
+      quantized_t *out = parent->quantized_.data().begin() + row * parent->quantized_.size2() + col;
+      quantize_values(values, n, scale, out, parent->sum_, parent->min_, parent->max_);
+    }
+  };
+
+
   // PRE: low_rows and low_cols are set.
-  void ezw_encoder::build_zerotree_map() {
+  void ezw_encoder::build_zerotree_map(quantized_t mean) {
     // ensure matrices are the same size.
     if (zerotree_map_.size1() != quantized_.size1() || zerotree_map_.size2() != quantized_.size2()) {
       zerotree_map_.resize(quantized_.size1(), quantized_.size2());
     }
 
-    // copy quantized into zerotree map, replacing each w/largest power of 
-    // two less than the magnitude
+    // subtract out mean, and copy quantized into zerotree map, replacing each 
+    // w/largest power of two less than the magnitude
     for (size_t i=0; i < quantized_.size1(); i++) {
       for (size_t j=0; j < quantized_.size2(); j++) {
+        quantized_(i,j) -= mean;
         zerotree_map_(i,j) = le_power_of_2((uint64_t)matrix_utils::abs_val(quantized_(i,j)));
       }
     }
 
     // depth-first recursive encoding from each cell on the root level
+    if (!trees_.empty()) {
+      for (size_t r=0; r < low_rows_; r++) {
+        for (size_t c=0; c < low_cols_; c++) {
+          zerotree_map_encode_packet(dom_elt(r, c, 0));
+        }
+      }
+      return;
+    }
+
+    if (frames_ > 1) {
+      for (size_t f=0; f < low_frames_; f++) {
+        for (size_t r=0; r < low_rows_; r++) {
+          for (size_t c=0; c < low_cols_; c++) {
+            zerotree_map_encode_3d(f, r, c);
+          }
+        }
+      }
+      return;
+    }
+
     for (size_t r=0; r < low_rows_; r++) {
       for (size_t c=0; c < low_cols_; c++) {
         zerotree_map_encode(r, c);
@@ -88,6 +154,9 @@ namespace nami {
   quantized_t ezw_encoder::zerotree_map_encode(size_t r, size_t c) {
     // handle lowest frequency level case (3 children)
     if (r < low_rows_ && c < low_cols_) {
+      if (low_rows_ == quantized_.size1()) {   // untransformed data has no children
+        return zerotree_map_(r,c);
+      }
       zerotree_map_(r,c) |= zerotree_map_encode(r,          c+low_cols_) 
         |                   zerotree_map_encode(r+low_rows_, c         ) 
         |                   zerotree_map_encode(r+low_rows_, c+low_cols_);
@@ -111,6 +180,44 @@ namespace nami {
   }
 
 
+  quantized_t ezw_encoder::zerotree_map_encode_packet(const dom_elt& e) {
+    vector<dom_elt> children;
+    trees_.children(e, children);
+
+    quantized_t& map = zerotree_map_(e.row, e.col);
+    for (size_t i=0; i < children.size(); i++) {
+      map |= zerotree_map_encode_packet(children[i]);
+    }
+    return map;
+  }
+
+
+  quantized_t ezw_encoder::zerotree_map_encode_3d(size_t f, size_t r, size_t c) {
+    const size_t rows = quantized_.size1() / frames_;
+    const size_t cols = quantized_.size2();
+    quantized_t& map = zerotree_map_(f*rows + r, c);
+
+    if (r < low_rows_ && c < low_cols_ && f < low_frames_) {
+      // lowest frequency level: children in the 7 other subbands.
+      if (low_rows_ == rows) return map;
+      for (int k=1; k < 8; k++) {
+        map |= zerotree_map_encode_3d(f + ((k & 4) ? low_frames_ : 0),
+                                      r + ((k & 2) ? low_rows_   : 0),
+                                      c + ((k & 1) ? low_cols_   : 0));
+      }
+
+    } else if ((f << 1) < frames_ && (r << 1) < rows && (c << 1) < cols) {
+      // recursively process the 8 children
+      for (int k=0; k < 8; k++) {
+        map |= zerotree_map_encode_3d((f << 1) + ((k >> 2) & 1),
+                                      (r << 1) + ((k >> 1) & 1),
+                                      (c << 1) + (k & 1));
+      }
+    }
+    return map;
+  }
+
+
   ezw_code ezw_encoder::encode_value(const dom_elt& e, obitstream& out) {
     quantized_t value = quantized_(e.row, e.col);
     
@@ -158,35 +265,65 @@ namespace nami {
   }
 
 
-  void ezw_encoder::quantize(nami_matrix& mat, quantized_t scale) {
-    if (quantized_.size1() != mat.size1() || quantized_.size2() != mat.size2()) {
-      quantized_.resize(mat.size1(), mat.size2());
+  template <class T>
+  void ezw_encoder::quantize(const T *data, size_t rows, size_t cols, size_t pitch, 
+                             quantized_t scale, size_t frames, size_t frame_pitch) {
+    if (quantized_.size1() != rows * frames || quantized_.size2() != cols) {
+      quantized_.resize(rows * frames, cols);
     }
+    frames_ = frames;
+    sum_ = 0;
+    min_ = Q_MAX;
+    max_ = Q_MIN;
     
-    for (size_t r=0; r < mat.size1(); r++) {
-      for (size_t c=0; c < mat.size2(); c++) {
-        quantized_(r,c) = isnan(mat(r,c)) ? 0 : (quantized_t)round(mat(r,c) * scale);
+    for (size_t f=0; f < frames; f++) {
+      for (size_t r=0; r < rows; r++) {
+        const T *row = data + f * frame_pitch + r * pitch;
+        quantized_t *out = quantized_.data().begin() + (f*rows + r) * cols;
+        quantize_values(row, cols, scale, out, sum_, min_, max_);
       }
     }
   }
 
+  template void ezw_encoder::quantize(const double *data, size_t rows, size_t cols, 
+                                      size_t pitch, quantized_t scale, size_t frames,
+                                      size_t frame_pitch);
+  template void ezw_encoder::quantize(const float *data, size_t rows, size_t cols, 
+                                      size_t pitch, quantized_t scale, size_t frames,
+                                      size_t frame_pitch);
 
-  void ezw_encoder::subtract_scalar(quantized_t scalar) {
+
+  void ezw_encoder::find_stats() {
+    sum_ = 0;
+    min_ = Q_MAX;
+    max_ = Q_MIN;
     for (size_t r=0; r < quantized_.size1(); r++) {
       for (size_t c=0; c < quantized_.size2(); c++) {
-        quantized_(r,c) -= scalar;
+        sum_ += quantized_(r,c);
+        min_ = min(min_, quantized_(r,c));
+        max_ = max(max_, quantized_(r,c));
       }
     }
   }
 
 
+  quantized_t ezw_encoder::abs_max_about(quantized_t mean) {
+    if (min_ > max_) return 0;     // no values
+    return max(max_ - mean, mean - min_);
+  }
+
+
   void ezw_encoder::do_encode(obitstream& out, ezw_header& header, bool byte_align) {
     // Figure out bounds on the lowest transform level, so we can figure out
     // what kind of children we have.
-    low_rows_ = quantized_.size1() >> header.level;
+    const size_t rows = quantized_.size1() / frames_;
+    low_rows_ = rows >> header.level;
     low_cols_ = quantized_.size2() >> header.level;
+    low_frames_ = frames_ >> header.level;
 
-    build_zerotree_map();
+    trees_ = header.basis.empty() 
+      ? packet_zerotree() : packet_zerotree(header.basis, rows, quantized_.size2());
+    build_zerotree_map(header.mean);
 
     dom_sizes_.clear();
     sub_sizes_.clear();
@@ -196,7 +333,14 @@ namespace nami {
     while (threshold_ && (!pass_limit_ || (dom_sizes_.size() < pass_limit_))) {
       size_t start_bits = out.in_bits();
 
-      dominant_pass(visitor, low_rows_, low_cols_, quantized_.size1(), quantized_.size2());
+      if (!trees_.empty()) {
+        depth_first_traversal_packet(visitor, trees_);
+      } else if (frames_ > 1) {
+        depth_first_traversal_3d(visitor, low_rows_, low_cols_, low_frames_, 
+                                 rows, quantized_.size2(), frames_);
+      } else {
+        dominant_pass(visitor, low_rows_, low_cols_, quantized_.size1(), quantized_.size2());
+      }
       size_t mid_bits = out.in_bits();
 
       DBG_OUT(endl);
@@ -222,17 +366,28 @@ namespace nami {
   }
 
 
-  //TODO: make this method common to the coder and the wavelet transforms.
-  int ezw_encoder::compute_level(int level, size_t rows, size_t cols) {
+  int ezw_encoder::transform_level(int level, size_t rows, size_t cols, size_t frames) {
     // for negative level, assume maximally transformed data as the transforms do.
     if (level < 1) {
-      level = times_divisible_by_2(max(rows, cols));
+      level = levels_to_one(max(max(rows, cols), frames));
     }
+    return level;
+  }
 
-    // for irregular sizes, ignore extra transforms in the longer direction.  Use
-    // the level of the lowest frequency subband in the shorter direction to bound.
-    if (level > times_divisible_by_2(min(rows, cols))) {
-      level = times_divisible_by_2(min(rows, cols));
+
+  //TODO: make this method common to the coder and the wavelet transforms.
+  int ezw_encoder::compute_level(int level, size_t rows, size_t cols, size_t frames) {
+    level = transform_level(level, rows, cols, frames);
+
+    // for irregular sizes, ignore extra transforms in the longer direction.  Zerotrees
+    // span only levels that halve every dimension exactly; any further levels stay
+    // in the lowest frequency subband.
+    int tree_levels = min(times_divisible_by_2(rows), times_divisible_by_2(cols));
+    if (frames > 1) {
+      tree_levels = min(tree_levels, times_divisible_by_2(frames));
+    }
+    if (level > tree_levels) {
+      level = tree_levels;
     }
 
     return level;
@@ -240,22 +395,136 @@ namespace nami {
 
 
   size_t ezw_encoder::encode(nami_matrix& mat, ostream& out, int level) {
-    // First, compute values for header.
-    level = compute_level(level, mat.size1(), mat.size2());
+    // dump mat into quantized matrix
+    quantize(mat.data().begin(), mat.size1(), mat.size2(), mat.size2(), scale_);
+    return encode_quantized(out, level, scale_);
+  }
 
-    quantize(mat, scale_);   // dump mat into quantized matrix
 
-    // subtract out mean.
-    quantized_t mean = (quantized_t)round(matrix_utils::mean_val(quantized_));
-    subtract_scalar(mean);
+  size_t ezw_encoder::encode(nami_matrix_f& mat, ostream& out, int level) {
+    quantize(mat.data().begin(), mat.size1(), mat.size2(), mat.size2(), scale_);
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  size_t ezw_encoder::encode(const matrix_view& mat, ostream& out, int level) {
+    quantize(mat.data(), mat.size1(), mat.size2(), mat.pitch(), scale_);
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  size_t ezw_encoder::encode(const matrix_view_f& mat, ostream& out, int level) {
+    quantize(mat.data(), mat.size1(), mat.size2(), mat.pitch(), scale_);
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  size_t ezw_encoder::encode(const quantized_matrix& mat, ostream& out, int level) {
+    quantized_ = mat;        // already integers; nothing to quantize
+    frames_ = 1;
+    find_stats();
+    return encode_quantized(out, level, 1);
+  }
+
+
+  size_t ezw_encoder::encode(const volume_view& vol, ostream& out, int level) {
+    quantize(vol.data(), vol.size1(), vol.size2(), vol.pitch(), scale_, 
+             vol.size3(), vol.frame_pitch());
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  size_t ezw_encoder::encode(const volume_view_f& vol, ostream& out, int level) {
+    quantize(vol.data(), vol.size1(), vol.size2(), vol.pitch(), scale_, 
+             vol.size3(), vol.frame_pitch());
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  size_t ezw_encoder::encode(const matrix_view& mat, const packet_tree& basis, ostream& out) {
+    quantize(mat.data(), mat.size1(), mat.size2(), mat.pitch(), scale_);
+    return encode_quantized(out, basis.pyramid_level(), scale_, basis);
+  }
+
+
+  size_t ezw_encoder::encode(const matrix_view_f& mat, const packet_tree& basis, ostream& out) {
+    quantize(mat.data(), mat.size1(), mat.size2(), mat.pitch(), scale_);
+    return encode_quantized(out, basis.pyramid_level(), scale_, basis);
+  }
+
+
+  size_t ezw_encoder::encode(const double *data, size_t count, size_t rows, size_t cols,
+                             const vector<ostream*>& out, int level) {
+    return encode_batch(data, count, rows, cols, out, level);
+  }
+
+
+  size_t ezw_encoder::encode(const float *data, size_t count, size_t rows, size_t cols,
+                             const vector<ostream*>& out, int level) {
+    return encode_batch(data, count, rows, cols, out, level);
+  }
+
+
+  size_t ezw_encoder::encode(basic_wt_lift<double>& wt, const matrix_view& mat, ostream& out, 
+                             int level) {
+    return encode_transform(wt, mat, out, level);
+  }
+
+
+  size_t ezw_encoder::encode(basic_wt_lift<float>& wt, const matrix_view_f& mat, ostream& out, 
+                             int level) {
+    return encode_transform(wt, mat, out, level);
+  }
+
+
+  template <class T>
+  size_t ezw_encoder::encode_transform(basic_wt_lift<T>& wt, const basic_matrix_view<T>& mat,
+                                       ostream& out, int level) {
+    quantize_sink<T> sink(this, mat.size1(), mat.size2(), scale_);
+    level = wt.fwt_2d(mat, sink, level);
+    return encode_quantized(out, level, scale_);
+  }
+
+
+  template <class T>
+  size_t ezw_encoder::encode_batch(const T *data, size_t count, size_t rows, size_t cols,
+                                   const vector<ostream*>& out, int level) {
+    assert(out.size() >= count);
+    size_t bytes = 0;
+    for (size_t i=0; i < count; i++) {
+      quantize(data + i * rows * cols, rows, cols, cols, scale_);
+      bytes += encode_quantized(*out[i], level, scale_);
+    }
+    return bytes;
+  }
+
+
+  size_t ezw_encoder::encode_quantized(ostream& out, int level, quantized_t scale,
+                                       const packet_tree& basis) {
+    // First, compute values for header.
+    const size_t rows = quantized_.size1() / frames_;
+    int wt_level = level;
+    if (basis.empty()) {
+      wt_level = transform_level(level, rows, quantized_.size2(), frames_);
+      level = compute_level(level, rows, quantized_.size2(), frames_);
+    } else if (basis.depth() > min(times_divisible_by_2(rows), 
+                                   times_divisible_by_2(quantized_.size2()))) {
+      throw runtime_error("Error: packet basis splits a subband with an odd side.");
+    }
 
-    quantized_t abs_max = matrix_utils::abs_max_val(quantized_);
-    threshold_ = le_power_of_2((uint64_t)abs_max);
+    // mean is subtracted out as the zerotree map is built.
+    const size_t size = quantized_.size1() * quantized_.size2();
+    quantized_t mean = size ? (quantized_t)round(sum_ / (double)size) : 0;
+    threshold_ = le_power_of_2((uint64_t)abs_max_about(mean));
 
     // construct and write out the header with relevant info
-    ezw_header header(mat.size1(), mat.size2(), level, mean, scale_, threshold_, enc_type_);
+    ezw_header header(rows, quantized_.size2(), level, mean, scale, threshold_, enc_type_, 
+                      1, 0, frames_);
+    header.transform_level = wt_level;
+    header.basis = basis;
 
-    vector_obitstream obits;
+    if (code_buf_.empty()) code_buf_.resize(DEFAULT_BIT_BUFSIZE);
+    vector_obitstream obits(code_buf_);
     do_encode(obits, header, false);
     obits.flush();
 
@@ -271,7 +540,8 @@ namespace nami {
     // RLE encode everything first, unless it is already
     if (!rle) {
       const size_t rle_bound = (size_t)ceil(header.ezw_size * 257.0/256 + 1);
-      vector<unsigned char> rle_buffer(rle_bound);
+      vector<unsigned char>& rle_buffer = rle_buf_;
+      rle_buffer.assign(rle_bound, 0);
 
       header.rle_size = RLE_Compress(&buffer[0], &rle_buffer[0], buf_size);
       rle_buffer.resize(header.rle_size);
@@ -282,7 +552,8 @@ namespace nami {
     if (enc_type_ == HUFFMAN) {
       // Huffman code RLE buffer, then write out the results.
       const size_t huff_bound = (size_t)ceil(buf_size * 101.0/100 + 384);
-      vector<unsigned char> huff_buffer(huff_bound);
+      vector<unsigned char>& huff_buffer = huff_buf_;
+      huff_buffer.assign(huff_bound, 0);     // the coder ORs bits into it
       header.enc_size = Huffman_Compress(&buffer[0], &huff_buffer[0], buf_size);
       huff_buffer.resize(header.enc_size);
       huff_buffer.swap(buffer);
@@ -42,6 +42,8 @@
 
 namespace nami {
 
+  template <class T> class basic_wt_lift;      // see wt_lift.h
+
   /// This class provides methods for encoding wavelet matrices 
   /// using Shapiro's EZW method.
   class ezw_encoder {
@@ -67,7 +69,101 @@ namespace nami {
     /// @return            Number of bytes written out.
     /// 
     size_t encode(nami_matrix& mat, std::ostream& out, int level = -1);
+
+    /// Encodes a single-precision matrix, e.g. from wt_lift_f.  The output is the
+    /// same format as for nami_matrix, and decodes into either.
+    /// 
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    /// 
+    size_t encode(nami_matrix_f& mat, std::ostream& out, int level = -1);
+
+    /// Encodes the matrix mat views, e.g. a padded matrix or an application's own
+    /// buffer, without copying it first.  Only values within each row are read.
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    size_t encode(const matrix_view& mat, std::ostream& out, int level = -1);
+
+    /// Encodes a view of a single-precision matrix.
+    /// @see encode(const matrix_view&, std::ostream&, int)
+    size_t encode(const matrix_view_f& mat, std::ostream& out, int level = -1);
+
+    ///
+    /// Encodes a matrix of integer wavelet coefficients, e.g. from wt_int53.  No
+    /// quantization is done and the scale is recorded as 1.  With no pass limit, 
+    /// coding runs down to threshold zero, so decoding is bit-exact.
+    /// 
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    /// 
+    size_t encode(const quantized_matrix& mat, std::ostream& out, int level = -1);
+
+    ///
+    /// Encodes a volume transformed by wt_3d with 3d zerotrees, which also find
+    /// the zeros shared by successive frames.  Zerotrees span the levels that halve
+    /// all three dimensions exactly, so frame counts divisible by 2^level code best.
+    /// The decoder returns the volume with its frames stacked in one matrix.
+    /// 
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    /// 
+    size_t encode(const volume_view& vol, std::ostream& out, int level = -1);
+
+    /// Encodes a single-precision volume, e.g. from a wt_3d_f.
+    /// @see encode(const volume_view&, std::ostream&, int)
+    size_t encode(const volume_view_f& vol, std::ostream& out, int level = -1);
+
+    ///
+    /// Encodes a matrix transformed into a wavelet packet basis, e.g. by 
+    /// wt_packet::best_basis(), with zerotrees that follow the basis (see 
+    /// packet_zerotree).  The basis is recorded in the header, and the decoder's
+    /// basis() returns it.  Throws std::runtime_error if the basis splits a subband 
+    /// with an odd side.
+    /// 
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    /// 
+    size_t encode(const matrix_view& mat, const packet_tree& basis, std::ostream& out);
+
+    /// Encodes a single-precision matrix in a wavelet packet basis.
+    /// @see encode(const matrix_view&, const packet_tree&, std::ostream&)
+    size_t encode(const matrix_view_f& mat, const packet_tree& basis, std::ostream& out);
+
+    ///
+    /// Encodes <count> rows x cols matrices stored one after another at data, e.g.
+    /// transformed by wt_batch, each onto its own stream: matrix i goes to out[i],
+    /// exactly as encode() would write it.  The coder's buffers are reused from 
+    /// one matrix to the next.
+    /// 
+    /// @return            Total number of bytes written out.
+    /// @see encode(nami_matrix&, std::ostream&, int)
+    /// 
+    size_t encode(const double *data, size_t count, size_t rows, size_t cols,
+                  const std::vector<std::ostream*>& out, int level = -1);
+
+    /// Encodes a batch of single-precision matrices.
+    /// @see encode(const double*, size_t, size_t, size_t, const std::vector<std::ostream*>&, int)
+    size_t encode(const float *data, size_t count, size_t rows, size_t cols,
+                  const std::vector<std::ostream*>& out, int level = -1);
     
+    ///
+    /// Transforms mat with wt and encodes the result.  The coefficients are quantized
+    /// as the transform's last pass writes them out, instead of being put back into
+    /// mat in the usual order and quantized afterwards (see wt_lift::fwt_2d(view_type,
+    /// basic_row_sink<T>&, int)), and their mean and magnitude are found in the same 
+    /// pass.  Output is the same as for encode(nami_matrix&, std::ostream&, int) on 
+    /// the transformed matrix, but mat is left in the transform's own order.
+    /// 
+    /// @param wt          Transform to apply to mat.
+    /// @param mat         Input data; overwritten.
+    /// @param out         Output stream to write encoded data to.
+    /// @param level       Level of the transform to apply.  Maximal if not provided.
+    /// 
+    /// @return            Number of bytes written out.
+    /// 
+    size_t encode(basic_wt_lift<double>& wt, const matrix_view& mat, std::ostream& out, 
+                  int level = -1);
+
+    /// Transforms and encodes a single-precision matrix.
+    /// @see encode(basic_wt_lift<double>&, const matrix_view&, std::ostream&, int)
+    size_t encode(basic_wt_lift<float>& wt, const matrix_view_f& mat, std::ostream& out, 
+                  int level = -1);
+
     /// Number of EZW passes to encode; 0 for no limit.
     int pass_limit();
 
@@ -88,13 +184,20 @@ namespace nami {
 
   protected:
     /// Values from input matrix, quantized.
-    boost::numeric::ublas::matrix<quantized_t> quantized_;
+    quantized_matrix quantized_;
+
+    quantized_t sum_;                   ///< Sum of quantized_, found as it is filled
+    quantized_t min_;                   ///< Least value in quantized_
+    quantized_t max_;                   ///< Greatest value in quantized_
 
     /// map of zero trees for encoding step
-    boost::numeric::ublas::matrix<quantized_t> zerotree_map_;
+    quantized_matrix zerotree_map_;
 
+    size_t frames_;                     ///< Frames stacked in quantized_; 1 for a matrix
     size_t low_rows_;                   ///< Rows in lowest frequency pass
     size_t low_cols_;                   ///< Cols in lowest frequency pass
+    size_t low_frames_;                 ///< Frames in lowest frequency pass
+    packet_zerotree trees_;             ///< Zerotrees of a packet basis; empty for the pyramid
 
     size_t pass_limit_;                 ///< Max number of EZW passes to output
     quantized_t scale_;                 ///< pre-transform scaling factor.
@@ -107,6 +210,10 @@ namespace nami {
     quantized_t threshold_;              ///< Current threshold for the coder.   
     std::vector<quantized_t> sub_list_;  ///< accumulated subordinate pass coefficients
 
+    /// Buffers for the coded bits and their RLE and Huffman coding, kept between 
+    /// calls so that coding many small matrices doesn't reallocate them each time.
+    std::vector<unsigned char> code_buf_, rle_buf_, huff_buf_;
+
 
     /// EZW-codes a single value according to the current threshold.  
     /// Appends to dom_queue, and sub_list if necessary.
@@ -115,29 +222,71 @@ namespace nami {
     /// Subordinate pass of EZW algorithm.  ee Shapiro, 1993 for info.
     void subordinate_pass(obitstream& out);
 
-    /// gets level of transform based on size of matrix.
-    int compute_level(int level, size_t rows, size_t cols);
+    /// gets level of transform based on size of matrix, or of volume with <frames> frames:
+    /// level, or as deep as the transforms go by default if level is less than 1.
+    int transform_level(int level, size_t rows, size_t cols, size_t frames = 1);
+
+    /// gets depth of the zerotrees for data transformed at <level>.  Zerotrees span only
+    /// the levels that halve every side exactly.
+    int compute_level(int level, size_t rows, size_t cols, size_t frames = 1);
+
+    /// Multiplies each value in the rows x cols matrix at data, whose rows are <pitch>
+    /// values apart, by a scale factor then casts it to quantized_t.  Stored results
+    /// in an internal matrix of quantized values.  Instantiated for double and float.
+    /// For a volume, <frames> such matrices, <frame_pitch> values apart, are stacked.
+    /// Also finds the sum and range of the quantized values.
+    template <class T>
+    void quantize(const T *data, size_t rows, size_t cols, size_t pitch, quantized_t scale,
+                  size_t frames = 1, size_t frame_pitch = 0);
+
+    /// Quantizes coefficients into quantized_ as a transform writes them out; 
+    /// used by the encode() calls that transform.
+    template <class T>
+    struct quantize_sink;
 
-    /// Multiplies each value in the matrix by a scale factor then casts it to quantized_t.
-    /// Stored results in an internal matrix of quantized values.
-    void quantize(nami_matrix& mat, quantized_t scale);
+    /// Finds the sum and range of values already in quantized_.
+    void find_stats();
+
+    /// Largest magnitude of the values in quantized_ once mean is subtracted from
+    /// them, from the range found by quantize().
+    quantized_t abs_max_about(quantized_t mean);
     
     /// Build zerotree map.  Map is constructed from quantized and stored in zerotree_map.
     /// Threshold can be simply ANDed with zerotree_map values to determine if a cell is a 
-    /// zerotree root.
+    /// zerotree root.  mean is subtracted from quantized_ along the way.
     /// See Shapiro 1996, "A Fast Technique for Finding Zerotrees in the EZW Algorithm".
-    void build_zerotree_map();
+    void build_zerotree_map(quantized_t mean);
 
     /// Recursive helper for build_zerotree_map().  
     quantized_t zerotree_map_encode(size_t r, size_t c);
 
-    /// Subtracts the provided scalar value from the entire quantized matrix.
-    void subtract_scalar(quantized_t scalar);
+    /// Recursive helper for build_zerotree_map() in a packet basis.
+    quantized_t zerotree_map_encode_packet(const dom_elt& e);
+
+    /// Recursive helper for build_zerotree_map() on volumes.  r is the row within
+    /// frame f.
+    quantized_t zerotree_map_encode_3d(size_t f, size_t r, size_t c);
+
+    /// Encodes the values in quantized_ onto out.  Used by both encode() calls.
+    /// scale is recorded in the header for the decoder, as is basis, unless empty.
+    size_t encode_quantized(std::ostream& out, int level, quantized_t scale,
+                            const packet_tree& basis = packet_tree());
+
+    /// Transforms and encodes a matrix; used by both encode() calls that transform.
+    template <class T>
+    size_t encode_transform(basic_wt_lift<T>& wt, const basic_matrix_view<T>& mat, 
+                            std::ostream& out, int level);
+
+    /// Encodes a batch of matrices; used by both batched encode() calls.
+    template <class T>
+    size_t encode_batch(const T *data, size_t count, size_t rows, size_t cols,
+                        const std::vector<std::ostream*>& out, int level);
     
     /// Does the actual work of the EZW algorithm; used by both sequential and parallel
     /// calls above.
     /// 
-    /// @pre threshold has been set according to max value in array.
+    /// @pre threshold has been set according to max value in array, once the mean
+    ///      in header is subtracted.
     /// 
     /// @param out         Output stream to write encoded data to.
     /// @param byte_align  If true, beginning of each pass is aligned to bytes in the output.
@@ -0,0 +1,365 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include "ezw_stream.h"
+#include "vector_obitstream.h"
+#include "vector_ibitstream.h"
+#include "io_utils.h"
+#include "two_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  /// Trees per block if none are chosen: about 4096 samples' worth.
+  static size_t default_block_trees(int levels) {
+    return (levels < 12) ? (size_t(4096) >> levels) : 1;
+  }
+
+
+  void stream_block::set(int l, size_t k, size_t trees, bool last, size_t n) {
+    levels = l;
+    start.resize(levels + 1);
+    end.resize(levels + 1);
+    values.resize(levels + 1);
+    map.resize(levels + 1);
+
+    // band b < levels has 2^(levels-1-b) coefficients per tree; the low band one.
+    for (int b=0; b <= levels; b++) {
+      const int shift = (b < levels) ? (levels - 1 - b) : 0;
+      start[b] = (k * trees) << shift;
+      if (!last) {
+        end[b] = ((k + 1) * trees) << shift;
+      } else if (b < levels) {
+        end[b] = low_band_size(n, b) - low_band_size(n, b + 1);
+      } else {
+        end[b] = low_band_size(n, levels);
+      }
+      if (end[b] < start[b]) {
+        throw runtime_error("Error: stream block ends before it starts.");
+      }
+      values[b].resize(size(b));
+    }
+  }
+
+
+  size_t stream_block::orphans(int b) const {
+    const size_t first = max(2 * end[b+1], start[b]);
+    return min(first, end[b]) - start[b];
+  }
+
+
+  void stream_block::children(int b, size_t i, size_t& first, size_t& last) const {
+    const size_t g = start[b] + i;
+    first = (b == levels) ? g : 2 * g;
+    last  = (b == levels) ? g + 1 : 2 * g + 2;
+    first = min(first, end[b-1]) - start[b-1];
+    last  = min(last,  end[b-1]) - start[b-1];
+  }
+
+
+  void stream_block::build_map() {
+    for (int b=0; b <= levels; b++) {
+      map[b].assign(size(b), 0);
+    }
+
+    // children are in the next finer band, so finer bands' maps are done first.
+    for (int b=1; b <= levels; b++) {
+      for (size_t i=0; i < size(b); i++) {
+        size_t first, last;
+        children(b, i, first, last);
+        quantized_t m = 0;
+        for (size_t c = first; c < last; c++) {
+          m |= abs(values[b-1][c]) | map[b-1][c];
+        }
+        map[b][i] = m;
+      }
+    }
+  }
+
+
+  template <class T>
+  basic_ezw_stream_encoder<T>::basic_ezw_stream_encoder(ostream& out) 
+    : out_(out), scale_(1), pass_limit_(0), block_trees_(0), bytes_(0), 
+      levels_(0), blocks_(0), buf_(DEFAULT_BIT_BUFSIZE) { }
+
+
+  template <class T>
+  basic_ezw_stream_encoder<T>::~basic_ezw_stream_encoder() { }
+
+
+  template <class T>
+  void basic_ezw_stream_encoder<T>::begin(int levels) {
+    levels_ = levels;
+    blocks_ = 0;
+    if (!block_trees_) {
+      block_trees_ = default_block_trees(levels);
+    }
+    pending_.assign(levels + 1, vector<quantized_t>());
+    base_.assign(levels + 1, 0);
+
+    bytes_  = io_utils::vl_write(out_, levels);
+    bytes_ += io_utils::vl_write(out_, scale_);
+    bytes_ += io_utils::vl_write(out_, block_trees_);
+    bytes_ += io_utils::vl_write(out_, pass_limit_);
+  }
+
+
+  template <class T>
+  void basic_ezw_stream_encoder<T>::put(int band, size_t i, T value) {
+    vector<quantized_t>& pending = pending_[band];
+    assert(i == base_[band] + pending.size());
+    pending.push_back(isnan(value) ? 0 : (quantized_t)round(value * scale_));
+
+    // a block is done when its last band fills, so only check when one does.
+    const int shift = (band < levels_) ? (levels_ - 1 - band) : 0;
+    if (i + 1 != ((blocks_ + 1) * block_trees_) << shift) return;
+    for (int b=0; b <= levels_; b++) {
+      const int s = (b < levels_) ? (levels_ - 1 - b) : 0;
+      if (base_[b] + pending_[b].size() < ((blocks_ + 1) * block_trees_) << s) return;
+    }
+    write_block(false);
+  }
+
+
+  template <class T>
+  void basic_ezw_stream_encoder<T>::end(size_t n) {
+    write_block(true, n);
+  }
+
+
+  template <class T>
+  void basic_ezw_stream_encoder<T>::write_block(bool last, size_t n) {
+    block_.set(levels_, blocks_, block_trees_, last, n);
+    for (int b=0; b <= levels_; b++) {
+      vector<quantized_t>& pending = pending_[b];
+      const size_t count = block_.size(b);
+      assert(count <= pending.size());
+      copy(pending.begin(), pending.begin() + count, block_.values[b].begin());
+      pending.erase(pending.begin(), pending.begin() + count);
+      base_[b] += count;
+    }
+    block_.build_map();
+
+    vector_obitstream bits(buf_);
+    const quantized_t threshold = encode_block(bits);
+    bits.flush();
+    const size_t size = bits.in_bytes();
+
+    // each block starts with a flag for the last, which records the signal length.
+    const unsigned char flag = last ? 1 : 0;
+    out_.write((const char*)&flag, 1);
+    bytes_ += 1;
+    if (last) {
+      bytes_ += io_utils::vl_write(out_, n);
+    }
+    const signed char log2_thresh = log2_pow2(threshold);
+    out_.write((const char*)&log2_thresh, 1);
+    bytes_ += 1;
+    bytes_ += io_utils::vl_write(out_, size);
+    out_.write((const char*)&buf_[0], size);
+    bytes_ += size;
+    blocks_++;
+  }
+
+
+  template <class T>
+  quantized_t basic_ezw_stream_encoder<T>::encode_block(obitstream& out) {
+    quantized_t max_abs = 0;
+    for (int b=0; b <= levels_; b++) {
+      for (size_t i=0; i < block_.size(b); i++) {
+        max_abs = max(max_abs, (quantized_t)abs(block_.values[b][i]));
+      }
+    }
+    const quantized_t initial = le_power_of_2(max_abs);
+
+    sub_list_.clear();
+    quantized_t threshold = initial;
+    for (size_t passes = 0; threshold && (!pass_limit_ || passes < pass_limit_); passes++) {
+      encode_visitor visitor(this, out, threshold);
+      block_.depth_first(visitor);
+
+      threshold >>= 1;
+      if (threshold > 0) {
+        for (size_t i=0; i < sub_list_.size(); i++) {
+          out.write_bit(sub_list_[i] & threshold);
+        }
+      }
+    }
+    return initial;
+  }
+
+
+  template <class T>
+  ezw_code basic_ezw_stream_encoder<T>::encode_visitor::operator()(int b, size_t i) {
+    quantized_t& value = parent->block_.values[b][i];
+    if (abs(value) >= threshold) {
+      parent->sub_list_.push_back(abs(value));
+      out.write_one();
+      out.write_bit(value >= 0);
+      value = 0;
+      return POSITIVE;
+
+    } else if (threshold & parent->block_.map[b][i]) {
+      out.write_zero();
+      out.write_one();
+      return ZERO;
+
+    } else {
+      out.write_zero();
+      out.write_zero();
+      return ZERO_TREE;
+    }
+  }
+
+
+  template class basic_ezw_stream_encoder<double>;
+  template class basic_ezw_stream_encoder<float>;
+
+
+  ezw_stream_decoder::ezw_stream_decoder() { }
+
+
+  ezw_stream_decoder::~ezw_stream_decoder() { }
+
+
+  size_t ezw_stream_decoder::decode(istream& in, basic_coeff_sink<double>& sink) {
+    return decode_stream(in, sink);
+  }
+
+
+  size_t ezw_stream_decoder::decode(istream& in, basic_coeff_sink<float>& sink) {
+    return decode_stream(in, sink);
+  }
+
+
+  template <class T>
+  size_t ezw_stream_decoder::decode_stream(istream& in, basic_coeff_sink<T>& sink) {
+    const int levels          = io_utils::vl_read(in);
+    const quantized_t scale   = io_utils::vl_read(in);
+    const size_t block_trees  = io_utils::vl_read(in);
+    const size_t pass_limit   = io_utils::vl_read(in);
+    if (!in || !scale || !block_trees) {
+      throw runtime_error("Error: malformed ezw stream header.");
+    }
+    sink.begin(levels);
+
+    for (size_t k=0; ; k++) {
+      unsigned char last;
+      in.read((char*)&last, 1);
+      const size_t n = last ? io_utils::vl_read(in) : 0;
+      signed char log2_thresh;
+      in.read((char*)&log2_thresh, 1);
+      const size_t size = io_utils::vl_read(in);
+      if (!in) {
+        throw runtime_error("Error: ezw stream ended early.");
+      }
+
+      buf_.resize(size + 1);
+      in.read((char*)&buf_[0], size);
+      if (!in) {
+        throw runtime_error("Error: ezw stream ended early.");
+      }
+
+      block_.set(levels, k, block_trees, last, n);
+      for (int b=0; b <= levels; b++) {
+        fill(block_.values[b].begin(), block_.values[b].end(), 0);
+      }
+      // a block of zeros, e.g. the empty last block of a signal, has no code.
+      if (log2_thresh >= 0) {
+        if (!size) throw runtime_error("Error: ezw stream block is empty.");
+        vector_ibitstream bits(&buf_[0], size);
+        decode_block(bits, 1ll << log2_thresh, pass_limit);
+      }
+
+      for (int b=0; b <= levels; b++) {
+        for (size_t i=0; i < block_.size(b); i++) {
+          sink.put(b, block_.start[b] + i, (T)(block_.values[b][i] / (double)scale));
+        }
+      }
+      if (last) {
+        sink.end(n);
+        return n;
+      }
+    }
+  }
+
+
+  void ezw_stream_decoder::decode_block(vector_ibitstream& in, quantized_t threshold,
+                                        size_t pass_limit) {
+    sub_list_.clear();
+    for (size_t passes = 0; threshold && (!pass_limit || passes < pass_limit); passes++) {
+      decode_visitor visitor(this, in, threshold);
+      block_.depth_first(visitor);
+
+      threshold >>= 1;
+      if (threshold > 0) {
+        for (size_t i=0; i < sub_list_.size(); i++) {
+          if (!in.good()) throw runtime_error("Error: ezw stream block ended early.");
+          if (in.read_bit()) {
+            quantized_t& value = *sub_list_[i];
+            value += (value < 0) ? -threshold : threshold;
+          }
+        }
+      }
+    }
+
+    // values cut off by the pass limit go to the middle of their intervals.
+    const quantized_t half = threshold >> 1;
+    for (size_t i=0; i < sub_list_.size(); i++) {
+      quantized_t& value = *sub_list_[i];
+      value += (value < 0) ? -half : half;
+    }
+  }
+
+
+  ezw_code ezw_stream_decoder::decode_visitor::operator()(int b, size_t i) {
+    if (!in.good()) throw runtime_error("Error: ezw stream block ended early.");
+    const unsigned first  = in.read_bit();
+    const unsigned second = in.read_bit();
+    if (first) {
+      quantized_t& value = parent->block_.values[b][i];
+      value = second ? threshold : -threshold;
+      parent->sub_list_.push_back(&value);
+      return second ? POSITIVE : NEGATIVE;
+    }
+    return second ? ZERO : ZERO_TREE;
+  }
+
+} // namespace nami
@@ -0,0 +1,230 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef EZW_STREAM_H
+#define EZW_STREAM_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "ezw.h"
+#include "wt_1d_stream.h"
+
+namespace nami {
+
+  class obitstream;
+  class vector_ibitstream;
+
+  /// Coefficients of one block of 1d zerotrees, band by band.  Block k holds 
+  /// trees k*trees through (k+1)*trees - 1: each has a low coefficient, the
+  /// high coefficient of the coarsest level at the same place, and under each high 
+  /// coefficient the two of the next finer level.  Bands end early in the last 
+  /// block of a signal, and coefficients whose parents are cut off there become
+  /// roots of their own trees.
+  struct stream_block {
+    int levels;                                   ///< Levels of transform
+    std::vector<size_t> start;                    ///< First index of each band in the block
+    std::vector<size_t> end;                      ///< End of each band in the block
+    std::vector<std::vector<quantized_t> > values;  ///< Coefficients of each band
+    std::vector<std::vector<quantized_t> > map;     ///< Zerotree map of each band
+
+    /// Sets up block k of <trees> trees.  If last, the block is the last of a 
+    /// signal of n samples, and holds all the coefficients past k*trees.
+    void set(int levels, size_t k, size_t trees, bool last = false, size_t n = 0);
+
+    /// Coefficients in band b of the block.
+    size_t size(int b) const { return end[b] - start[b]; }
+
+    /// Sets map to the OR of the magnitudes of each value's descendants.
+    void build_map();
+
+    /// Calls visit(b, i) for each coefficient, where i is the index in the block, 
+    /// and visits its children unless visit returns ZERO_TREE.
+    template <class Visitor>
+    void depth_first(Visitor& visit) {
+      const int low = levels;
+      for (size_t i=0; i < size(low); i++) {
+        depth_first(visit, low, i);
+      }
+      for (int b=levels-2; b >= 0; b--) {
+        for (size_t i = orphans(b); i < size(b); i++) {
+          depth_first(visit, b, i);
+        }
+      }
+    }
+
+  private:
+    /// Index in the block of the first coefficient in band b without a parent.
+    size_t orphans(int b) const;
+
+    /// Range [first, last) of the children in band b-1 of coefficient i of band b.
+    void children(int b, size_t i, size_t& first, size_t& last) const;
+
+    template <class Visitor>
+    void depth_first(Visitor& visit, int b, size_t i) {
+      if (visit(b, i) == ZERO_TREE || b == 0) return;
+      size_t first, last;
+      children(b, i, first, last);
+      for (size_t c = first; c < last; c++) {
+        depth_first(visit, b - 1, c);
+      }
+    }
+  };
+
+
+  /// EZW coder for 1d signals of any length, in constant memory.  Coefficients
+  /// come in from a basic_wt_1d_stream as they are finished, and each block of 
+  /// zerotrees is coded and written out as soon as it is complete, so only about
+  /// a block per band is held at a time:
+  ///
+  ///   std::ofstream out("timeline.ezw", std::ios::binary);
+  ///   ezw_stream_encoder encoder(out);
+  ///   wt_1d_stream wt;
+  ///   wt.start(encoder, 6);
+  ///   for (each sample) wt.push(sample);
+  ///   wt.finish();
+  ///
+  /// Each block is coded by EZW passes from its own largest threshold down, with
+  /// the same dominant and subordinate symbols as ezw_encoder.  Blocks are stored
+  /// raw, without run-length or Huffman coding.  Decode with ezw_stream_decoder.
+  ///
+  template <class T>
+  class basic_ezw_stream_encoder : public basic_coeff_sink<T> {
+  public:
+    /// Constructs an encoder that writes to out.
+    explicit basic_ezw_stream_encoder(std::ostream& out);
+
+    /// Destructor
+    virtual ~basic_ezw_stream_encoder();
+
+    /// Scaling factor by which values are multiplied before being quantized.
+    quantized_t scale() const { return scale_; }
+
+    /// Sets the scaling factor.  Must be called before the stream begins.
+    void set_scale(quantized_t scale) { scale_ = scale; }
+
+    /// Number of EZW passes to code per block; 0 for no limit.
+    size_t pass_limit() const { return pass_limit_; }
+
+    /// Sets the number of EZW passes per block.  Must be called before the stream
+    /// begins.
+    void set_pass_limit(size_t limit) { pass_limit_ = limit; }
+
+    /// Trees per block; 0 chooses about 4096 samples' worth.
+    size_t block_trees() const { return block_trees_; }
+
+    /// Sets the trees per block.  Must be called before the stream begins.
+    void set_block_trees(size_t trees) { block_trees_ = trees; }
+
+    /// Bytes written so far.
+    size_t bytes() const { return bytes_; }
+
+    virtual void begin(int levels);
+    virtual void put(int band, size_t i, T value);
+    virtual void end(size_t n);
+
+  protected:
+    std::ostream& out_;                  ///< Destination of the code
+    quantized_t scale_;                  ///< Scale applied before quantization
+    size_t pass_limit_;                  ///< Passes per block; 0 for no limit
+    size_t block_trees_;                 ///< Trees in each block
+    size_t bytes_;                       ///< Bytes written out
+
+    int levels_;                                   ///< Levels of the transform
+    size_t blocks_;                                ///< Blocks written out
+    std::vector<std::vector<quantized_t> > pending_;  ///< Coefficients of each band not yet coded
+    std::vector<size_t> base_;                     ///< Index of the first pending coefficient
+    stream_block block_;                           ///< Block being coded
+    std::vector<unsigned char> buf_;               ///< Code of a block
+    std::vector<quantized_t> sub_list_;            ///< Magnitudes of significant values
+
+    /// Codes and writes out block_.  If last, it ends a signal of n samples.
+    void write_block(bool last, size_t n = 0);
+
+    /// Codes the values of block_ onto out, and returns the initial threshold.
+    quantized_t encode_block(obitstream& out);
+
+    /// Codes a value of block_ against threshold in the dominant pass.
+    struct encode_visitor {
+      basic_ezw_stream_encoder *parent;
+      obitstream& out;
+      quantized_t threshold;
+      encode_visitor(basic_ezw_stream_encoder *p, obitstream& o, quantized_t t) 
+        : parent(p), out(o), threshold(t) { }
+      ezw_code operator()(int b, size_t i);
+    };
+  };
+
+  typedef basic_ezw_stream_encoder<double> ezw_stream_encoder;
+  typedef basic_ezw_stream_encoder<float>  ezw_stream_encoder_f;
+
+
+  /// Decodes the output of basic_ezw_stream_encoder a block at a time, into a 
+  /// basic_coeff_sink.  Use a basic_coeff_vector to get the whole transform back.
+  class ezw_stream_decoder {
+  public:
+    ezw_stream_decoder();
+    virtual ~ezw_stream_decoder();
+
+    /// Reads a coded signal from in, and sends its coefficients to sink, in the 
+    /// same order as basic_wt_1d_stream does.  Returns the length of the signal.  
+    /// Throws std::runtime_error if the code is malformed.
+    size_t decode(std::istream& in, basic_coeff_sink<double>& sink);
+
+    /// Decodes into single-precision coefficients.
+    /// @see decode(std::istream&, basic_coeff_sink<double>&)
+    size_t decode(std::istream& in, basic_coeff_sink<float>& sink);
+
+  protected:
+    stream_block block_;                   ///< Block being decoded
+    std::vector<unsigned char> buf_;       ///< Code of a block
+    std::vector<quantized_t*> sub_list_;   ///< Significant values, in order found
+
+    template <class T>
+    size_t decode_stream(std::istream& in, basic_coeff_sink<T>& sink);
+
+    /// Decodes the values of block_ from in, from initial threshold down.
+    void decode_block(vector_ibitstream& in, quantized_t threshold, size_t pass_limit);
+
+    /// Decodes a value of block_ in the dominant pass.
+    struct decode_visitor {
+      ezw_stream_decoder *parent;
+      vector_ibitstream& in;
+      quantized_t threshold;
+      decode_visitor(ezw_stream_decoder *p, vector_ibitstream& i, quantized_t t) 
+        : parent(p), in(i), threshold(t) { }
+      ezw_code operator()(int b, size_t i);
+    };
+  };
+
+} // namespace nami
+
+#endif // EZW_STREAM_H
@@ -0,0 +1,117 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef NAMI_FILTER_KERNELS_H
+#define NAMI_FILTER_KERNELS_H
+
+#include <cstdlib>
+
+/// \file filter_kernels.h
+/// This file provides the inner products used by the direct wavelet transforms.
+/// Each kernel computes one output sample, sum(f[d] * x[d*stride]), so the same
+/// kernel serves contiguous rows and panels of interleaved columns.  Kernels are
+/// small function objects; the convolution loops are templated on them, so a 
+/// fixed-length kernel is fully inlined and unrolled into the loop.
+namespace nami {
+
+  /// Kernel for filters whose length is only known at runtime.  Sums taps in
+  /// order.
+  struct fir_kernel {
+    const size_t size;   ///< Number of taps
+
+    explicit fir_kernel(size_t n) : size(n) { }
+
+    template <class T>
+    T operator()(const double *f, const T *x, size_t stride) const {
+      T sum = 0;
+      for (size_t d=0; d < size; d++) {
+        sum += f[d] * x[d * stride];
+      }
+      return sum;
+    }
+  };
+
+
+  /// Folds taps D and N-1-D of a symmetric filter, then recurses inward.  R is 
+  /// the number of taps left in the middle: 2 or more recurses, 1 is the center
+  /// tap of an odd-length filter, and 0 ends an even-length one.
+  template <size_t D, size_t N, int R = (int(N) - 2*int(D) >= 2) ? 2 : int(N) - 2*int(D)>
+  struct fold_taps {
+    template <class T>
+    static T sum(const double *f, const T *x, size_t stride) {
+      return f[D] * (x[D * stride] + x[(N-1-D) * stride]) 
+        + fold_taps<D+1, N>::sum(f, x, stride);
+    }
+  };
+
+  template <size_t D, size_t N>
+  struct fold_taps<D, N, 1> {
+    template <class T>
+    static T sum(const double *f, const T *x, size_t stride) {
+      return f[D] * x[D * stride];
+    }
+  };
+
+  template <size_t D, size_t N>
+  struct fold_taps<D, N, 0> {
+    template <class T>
+    static T sum(const double *, const T *, size_t) {
+      return 0;
+    }
+  };
+
+
+  /// Kernel for symmetric filters of length N, fixed at compile time.  Mirrored
+  /// taps share a multiply, so an N-tap filter costs (N+1)/2 multiplies, and 
+  /// the tap loop unrolls completely.  Only valid for filters where 
+  /// f[d] == f[N-1-d]; see is_symmetric().
+  template <size_t N>
+  struct sym_fir_kernel {
+    static const size_t size = N;
+
+    template <class T>
+    T operator()(const double *f, const T *x, size_t stride) const {
+      return fold_taps<0, N>::sum(f, x, stride);
+    }
+  };
+
+
+  /// True if f[d] == f[n-1-d] for all taps of f.
+  inline bool is_symmetric(const double *f, size_t n) {
+    for (size_t d=0; d < n/2; d++) {
+      if (f[d] != f[n-1-d]) return false;
+    }
+    return true;
+  }
+
+} // namespace
+
+#endif // NAMI_FILTER_KERNELS_H
@@ -0,0 +1,142 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "lift_factor.h"
+
+using namespace std;
+
+namespace nami {
+
+  /// Largest offset from center of a tap of f larger than tol.  Taps of f are
+  /// stored at f[r + j] for offsets j in [-r, r].
+  static int radius(const vector<double>& f, int r, double tol) {
+    for (int j=r; j > 0; j--) {
+      if (fabs(f[r+j]) > tol || fabs(f[r-j]) > tol) return j;
+    }
+    return 0;
+  }
+
+
+  /// True if f[r + j] matches f[r - j] to within tol for all offsets.
+  static bool symmetric(const vector<double>& f, int r, double tol) {
+    for (int j=1; j <= r; j++) {
+      if (fabs(f[r+j] - f[r-j]) > tol) return false;
+    }
+    return true;
+  }
+
+
+  /// Undoes a two-tap symmetric step on filter f, whose neighbors in the other
+  /// band come from g: f[j] -= a * (g[j-1] + g[j+1]) for offsets up to m.
+  /// Offsets past the new radius are cleared, so rounding doesn't accumulate.
+  static int unlift(vector<double>& f, const vector<double>& g, double a, 
+                    int m, int r, double tol) {
+    for (int j=-m; j <= m; j++) {
+      f[r+j] -= a * (g[r+j-1] + g[r+j+1]);
+    }
+    const int m2 = radius(f, r, tol);
+    for (int j=m2+1; j <= m; j++) {
+      f[r+j] = f[r-j] = 0;
+    }
+    return m2;
+  }
+
+
+  bool factor_lifting(const filter_bank& f, lift_scheme& scheme) {
+    // Filters by offset from the sample each output is centered on.  Steps
+    // only shorten them, so offsets stay within +/- r.
+    const int r = f.size;
+    const int c = f.size / 2;
+    vector<double> lo(2*r + 1), hi(2*r + 1);
+    double largest = 0;
+    for (int d=0; d < r; d++) {
+      lo[r + d - c] = f.lpf[d];
+      hi[r + d - c] = f.hpf[d];
+      largest = max(largest, max(fabs(f.lpf[d]), fabs(f.hpf[d])));
+    }
+
+    // Taps smaller than this are taken to be zero.  Coefficients are usually
+    // given to a dozen or so digits, so steps leave residue at about that level.
+    const double tol = 1e-8 * largest;
+    if (largest == 0 || !symmetric(lo, r, tol) || !symmetric(hi, r, tol)) return false;
+
+    // Lo is the low band row times its final scale, and hi the high band row 
+    // times its scale.  Peel steps off the end of the scheme until both are 
+    // single taps; steps come off last first.
+    vector<lift_step_t> types;
+    vector<double> coeffs;
+    int ml = radius(lo, r, tol);
+    int mh = radius(hi, r, tol);
+    while (ml > 0 || mh > 0) {
+      if (ml == mh + 1) {
+        // an update, s[i] += a * (d[i-1] + d[i]), made lo longer than hi
+        const double a = lo[r + ml] / hi[r + mh];
+        const int m = unlift(lo, hi, a, ml, r, tol);
+        if (m >= ml) return false;
+        ml = m;
+        types.push_back(UPDATE_2);
+        coeffs.push_back(a);
+
+      } else if (mh == ml + 1) {
+        // a predict, d[i] += a * (s[i] + s[i+1]), made hi longer than lo
+        const double a = hi[r + mh] / lo[r + ml];
+        const int m = unlift(hi, lo, a, mh, r, tol);
+        if (m >= mh) return false;
+        mh = m;
+        types.push_back(PREDICT_2);
+        coeffs.push_back(a);
+
+      } else {
+        return false;   // would need a longer step than two taps
+      }
+    }
+
+    const double low = lo[r];
+    const double high = hi[r];
+    if (fabs(low) <= tol || fabs(high) <= tol) return false;
+
+    // Steps were found on scaled rows.  An update adds high-band values to the
+    // low band, so its coefficient is off by low/high; a predict by high/low.
+    lift_scheme result("factored");
+    for (int k=types.size()-1; k >= 0; k--) {
+      const double a = (types[k] == UPDATE_2) ? coeffs[k] * high / low : coeffs[k] * low / high;
+      result.add_step(types[k], a);
+    }
+    result.set_scale(low, 1/high);
+    scheme = result;
+    return true;
+  }
+
+} // namespace
@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef NAMI_LIFT_FACTOR_H
+#define NAMI_LIFT_FACTOR_H
+
+#include "filter_bank.h"
+#include "lift_scheme.h"
+
+/// \file lift_factor.h
+/// This file provides factorization of filter banks into lifting schemes, so that
+/// banks without a hand-written scheme can still use wt_lift, which needs about 
+/// half the arithmetic of the direct convolution in wt_direct.
+namespace nami {
+
+  /// Factors the analysis filters of f into lifting steps and a final scaling.
+  /// This is the Euclidean algorithm on the filters' polyphase components: each 
+  /// round removes the outermost taps of the longer filter with one two-tap 
+  /// symmetric step (PREDICT_2 or UPDATE_2), and what is left when both filters 
+  /// are single taps is the scaling of the two bands.
+  ///
+  /// Filters are centered as in wt_1d_direct: tap d of lpf applies to sample 
+  /// 2i + d - size/2 for low output i, and tap d of hpf to sample 
+  /// 2i + 1 + d - size/2 for high output i.  Both must be whole-sample 
+  /// symmetric, and their lengths must differ by two at each round, as with 
+  /// the CDF family.  The synthesis filters are not used; the inverse transform
+  /// of the factored scheme is the exact inverse of the analysis filters.
+  ///
+  /// Returns true and fills scheme on success.  Returns false, leaving scheme 
+  /// alone, for banks that cannot be written with the steps in lift_scheme.h.
+  bool factor_lifting(const filter_bank& f, lift_scheme& scheme);
+
+} // namespace
+
+#endif // NAMI_LIFT_FACTOR_H
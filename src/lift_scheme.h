@@ -0,0 +1,155 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef NAMI_LIFT_SCHEME_H
+#define NAMI_LIFT_SCHEME_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+/// \file lift_scheme.h
+/// This file provides the lifting schemes that wt_1d_lift runs.
+///
+/// A lifting scheme is a struct with no state.  It lists its steps and final scaling
+/// through static members:
+///
+///   enum { steps = N };                  number of lifting steps
+///   static lift_step_t type(int k);      shape of step k (see lift_step_t)
+///   static double coeff(int k);          coefficient of step k
+///   static double scale();               low band is scaled by this, high band by its inverse
+///   static const char *name();           short name for output
+///
+/// Steps are applied in order by the forward transform, and undone in reverse order by
+/// the inverse.  Boundaries are extended symmetrically.  User-defined schemes follow the
+/// same pattern; see wt_1d_lift::set_scheme().  Schemes can also be built at runtime
+/// as a lift_scheme object, e.g. by factoring a filter bank with factor_lifting().
+namespace nami {
+
+  /// Shape of one lifting step.  s is the band of even samples, d the band of odd
+  /// samples.  Predict steps modify d from s; update steps modify s from d.
+  typedef enum {
+    PREDICT_1,   ///< d[i] += a * s[i]
+    PREDICT_2,   ///< d[i] += a * (s[i] + s[i+1])
+    UPDATE_1,    ///< s[i] += a * d[i]
+    UPDATE_2     ///< s[i] += a * (d[i-1] + d[i])
+  } lift_step_t;
+
+
+  /// Haar wavelet.
+  struct haar {
+    enum { steps = 2 };
+    static lift_step_t type(int k)  { return k ? UPDATE_1 : PREDICT_1; }
+    static double coeff(int k)      { return k ? 0.5 : -1.0; }
+    static double scale()           { return M_SQRT2; }
+    static const char *name()       { return "haar"; }
+  };
+
+
+  /// Cohen-Daubechies-Feauveau 5/3 (LeGall) wavelet.
+  struct cdf53 {
+    enum { steps = 2 };
+    static lift_step_t type(int k)  { return k ? UPDATE_2 : PREDICT_2; }
+    static double coeff(int k)      { return k ? 0.25 : -0.5; }
+    static double scale()           { return M_SQRT2; }
+    static const char *name()       { return "cdf53"; }
+  };
+
+
+  /// Cohen-Daubechies-Feauveau 9/7 wavelet.
+  struct cdf97 {
+    enum { steps = 4 };
+    static lift_step_t type(int k)  { return (k & 1) ? UPDATE_2 : PREDICT_2; }
+    static double coeff(int k) {
+      static const double c[] = {
+        -1.5861343420693648,
+        -0.0529801185718856,
+        0.8829110755411875,
+        0.4435068520511142
+      };
+      return c[k];
+    }
+    static double scale()           { return 1.1496043988602418; }
+    static const char *name()       { return "cdf97"; }
+  };
+
+
+  /// A lifting scheme held as data: its steps, coefficients and scaling.  This is 
+  /// what wt_1d_lift runs; static schemes are converted with lift_scheme::of<S>().
+  /// The forward transform multiplies the low band by low_scale() and divides the 
+  /// high band by high_scale().  The two are equal for the static schemes, but a
+  /// factored filter bank may normalize its bands differently.
+  class lift_scheme {
+  public:
+    /// Constructs an empty scheme with unit scaling.
+    explicit lift_scheme(const std::string& name = "") 
+      : low_scale_(1), high_scale_(1), name_(name) { }
+
+    /// Copies the steps and scaling of static scheme S.
+    template <class S>
+    static lift_scheme of() {
+      lift_scheme scheme(S::name());
+      for (int k=0; k < S::steps; k++) {
+        scheme.add_step(S::type(k), S::coeff(k));
+      }
+      scheme.set_scale(S::scale(), S::scale());
+      return scheme;
+    }
+
+    /// Appends a step after the existing ones.
+    void add_step(lift_step_t type, double coeff) {
+      types_.push_back(type);
+      coeffs_.push_back(coeff);
+    }
+
+    /// Sets the final scaling of the two bands.
+    void set_scale(double low, double high) {
+      low_scale_ = low;
+      high_scale_ = high;
+    }
+
+    int steps() const                  { return types_.size(); }
+    lift_step_t type(int k) const      { return types_[k]; }
+    double coeff(int k) const          { return coeffs_[k]; }
+    double low_scale() const           { return low_scale_; }
+    double high_scale() const          { return high_scale_; }
+    const char *name() const           { return name_.c_str(); }
+
+  private:
+    std::vector<lift_step_t> types_;   ///< Shape of each step
+    std::vector<double> coeffs_;       ///< Coefficient of each step
+    double low_scale_;                 ///< Low band is multiplied by this
+    double high_scale_;                ///< High band is divided by this
+    std::string name_;                 ///< Short name for output
+  };
+
+} // namespace nami
+
+#endif // NAMI_LIFT_SCHEME_H
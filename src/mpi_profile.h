@@ -36,18 +36,32 @@
 
 #ifdef NAMI_USE_PMPI
 #define MPI_Bcast         PMPI_Bcast
+#define MPI_Comm_compare  PMPI_Comm_compare
+#define MPI_Comm_dup      PMPI_Comm_dup
+#define MPI_Comm_free     PMPI_Comm_free
 #define MPI_Comm_rank     PMPI_Comm_rank
 #define MPI_Comm_size     PMPI_Comm_size
 #define MPI_Gather        PMPI_Gather
 #define MPI_Gatherv       PMPI_Gatherv
 #define MPI_Allgather     PMPI_Allgather
 #define MPI_Allreduce     PMPI_Allreduce
+#define MPI_Cart_coords   PMPI_Cart_coords
+#define MPI_Cart_get      PMPI_Cart_get
+#define MPI_Cart_rank     PMPI_Cart_rank
+#define MPI_Cartdim_get   PMPI_Cartdim_get
+#define MPI_Finalized     PMPI_Finalized
 #define MPI_Irecv         PMPI_Irecv
 #define MPI_Isend         PMPI_Isend
 #define MPI_Ibsend        PMPI_Ibsend
 #define MPI_Recv          PMPI_Recv
+#define MPI_Recv_init     PMPI_Recv_init
 #define MPI_Reduce        PMPI_Reduce
+#define MPI_Request_free  PMPI_Request_free
 #define MPI_Send          PMPI_Send
+#define MPI_Send_init     PMPI_Send_init
+#define MPI_Scatter       PMPI_Scatter
+#define MPI_Startall      PMPI_Startall
+#define MPI_Topo_test     PMPI_Topo_test
 #define MPI_Type_commit   PMPI_Type_commit
 #define MPI_Type_free     PMPI_Type_free
 #define MPI_Type_vector   PMPI_Type_vector
@@ -32,6 +32,10 @@
 #ifndef NAMI_MATRIX_H
 #define NAMI_MATRIX_H
 
+#include <cstddef>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
 #include <boost/numeric/ublas/matrix.hpp>
 
 ///\file nami_matrix.h
@@ -41,6 +45,253 @@ namespace nami {
   /// Matrix type used for all wavelet transforms in NAMI.
   typedef boost::numeric::ublas::matrix<double> nami_matrix;
 
+  /// Single-precision matrix, for the float instantiations of the transforms.
+  typedef boost::numeric::ublas::matrix<float> nami_matrix_f;
+
+  ///
+  /// Row-major matrix with padded rows.  Each row starts on a 64-byte boundary,
+  /// and rows are pitch() values apart instead of size2().  The pitch is an odd 
+  /// number of cache lines, so the rows of a power-of-two wide matrix don't all
+  /// map to the same cache sets, which makes column transforms slow.  
+  /// 
+  /// The transforms, par_wt and the EZW coder all accept padded matrices through
+  /// basic_matrix_view.  Values in the padding are never read.
+  /// 
+  template <class T>
+  class basic_padded_matrix {
+  public:
+    /// Bytes rows are aligned to.
+    static const size_t alignment = 64;
+
+    /// Constructs an empty matrix.
+    basic_padded_matrix() : rows_(0), cols_(0), pitch_(0), offset_(0) { }
+
+    /// Constructs an uninitialized rows x cols matrix.
+    basic_padded_matrix(size_t rows, size_t cols) 
+      : rows_(0), cols_(0), pitch_(0), offset_(0) {
+      resize(rows, cols);
+    }
+
+    /// Copies a ublas matrix into a padded one.
+    explicit basic_padded_matrix(const boost::numeric::ublas::matrix<T>& mat) 
+      : rows_(0), cols_(0), pitch_(0), offset_(0) {
+      resize(mat.size1(), mat.size2());
+      for (size_t i=0; i < rows_; i++) {
+        std::copy(&mat(i,0), &mat(i,0) + cols_, row(i));
+      }
+    }
+
+    /// Copy constructor.  Storage is realigned, so it can't just be copied.
+    basic_padded_matrix(const basic_padded_matrix& other) 
+      : rows_(0), cols_(0), pitch_(0), offset_(0) {
+      *this = other;
+    }
+
+    /// Assignment; resizes this matrix to match other.
+    basic_padded_matrix& operator=(const basic_padded_matrix& other) {
+      if (this == &other) return *this;
+      resize(other.rows_, other.cols_);
+      for (size_t i=0; i < rows_; i++) {
+        std::copy(other.row(i), other.row(i) + cols_, row(i));
+      }
+      return *this;
+    }
+
+    /// Resizes the matrix.  Values are not preserved.
+    void resize(size_t rows, size_t cols) {
+      rows_  = rows;
+      cols_  = cols;
+      pitch_ = padded_pitch(cols);
+      storage_.resize(rows * pitch_ + alignment / sizeof(T));
+
+      const size_t misalign = reinterpret_cast<uintptr_t>(&storage_[0]) % alignment;
+      offset_ = misalign ? (alignment - misalign) / sizeof(T) : 0;
+    }
+
+    /// Number of rows.
+    size_t size1() const { return rows_; }
+
+    /// Number of columns.
+    size_t size2() const { return cols_; }
+
+    /// Number of values from the start of one row to the start of the next.
+    size_t pitch() const { return pitch_; }
+
+    /// First value in the matrix.
+    T *data() { return &storage_[offset_]; }
+    const T *data() const { return &storage_[offset_]; }
+
+    /// First value in row i.
+    T *row(size_t i) { return data() + i * pitch_; }
+    const T *row(size_t i) const { return data() + i * pitch_; }
+
+    /// Element access.
+    T& operator()(size_t i, size_t j) { return data()[i * pitch_ + j]; }
+    const T& operator()(size_t i, size_t j) const { return data()[i * pitch_ + j]; }
+
+    /// Copies this matrix into a ublas matrix, resizing it to fit.
+    void copy_to(boost::numeric::ublas::matrix<T>& mat) const {
+      mat.resize(rows_, cols_, false);
+      for (size_t i=0; i < rows_; i++) {
+        std::copy(row(i), row(i) + cols_, &mat(i,0));
+      }
+    }
+
+    /// Pitch used for rows of <cols> values: a whole, odd number of cache lines.
+    static size_t padded_pitch(size_t cols) {
+      const size_t line = alignment / sizeof(T);
+      size_t lines = (cols + line - 1) / line;
+      if (lines % 2 == 0) lines++;
+      return lines * line;
+    }
+
+  private:
+    size_t rows_;              ///< Rows in the matrix.
+    size_t cols_;              ///< Columns in the matrix.
+    size_t pitch_;             ///< Values from one row to the next.
+    size_t offset_;            ///< Index of the first aligned value in storage_.
+    std::vector<T> storage_;   ///< Values, with room to align the first row.
+  };
+
+  /// Padded matrix of doubles.
+  typedef basic_padded_matrix<double> padded_matrix;
+
+  /// Padded matrix of floats.
+  typedef basic_padded_matrix<float> padded_matrix_f;
+
+
+  ///
+  /// Non-owning view of a row-major matrix that lives somewhere else: a pointer to 
+  /// the first value, a size, and the number of values from one row to the next.
+  /// The transforms, par_wt and the EZW coder take views, so data in an 
+  /// application's own buffers can be transformed and coded without copying it 
+  /// into a ublas matrix first.  ublas and padded matrices convert to views
+  /// implicitly.
+  /// 
+  template <class T>
+  class basic_matrix_view {
+  public:
+    /// View of rows x cols values at data, with rows <pitch> values apart.
+    basic_matrix_view(T *data, size_t rows, size_t cols, size_t pitch)
+      : data_(data), rows_(rows), cols_(cols), pitch_(pitch) { }
+
+    /// View of rows x cols contiguous values at data.
+    basic_matrix_view(T *data, size_t rows, size_t cols)
+      : data_(data), rows_(rows), cols_(cols), pitch_(cols) { }
+
+    /// View of a whole ublas matrix.
+    basic_matrix_view(boost::numeric::ublas::matrix<T>& mat)
+      : data_(mat.data().begin()), rows_(mat.size1()), cols_(mat.size2()), 
+        pitch_(mat.size2()) { }
+
+    /// View of a whole padded matrix.
+    basic_matrix_view(basic_padded_matrix<T>& mat)
+      : data_(mat.data()), rows_(mat.size1()), cols_(mat.size2()), 
+        pitch_(mat.pitch()) { }
+
+    /// Number of rows.
+    size_t size1() const { return rows_; }
+
+    /// Number of columns.
+    size_t size2() const { return cols_; }
+
+    /// Number of values from the start of one row to the start of the next.
+    size_t pitch() const { return pitch_; }
+
+    /// First value in the matrix.
+    T *data() const { return data_; }
+
+    /// First value in row i.
+    T *row(size_t i) const { return data_ + i * pitch_; }
+
+    /// Element access.
+    T& operator()(size_t i, size_t j) const { return data_[i * pitch_ + j]; }
+
+  private:
+    T *data_;        ///< First value.
+    size_t rows_;    ///< Rows in the view.
+    size_t cols_;    ///< Columns in the view.
+    size_t pitch_;   ///< Values from one row to the next.
+  };
+
+  /// View of a matrix of doubles.
+  typedef basic_matrix_view<double> matrix_view;
+
+  /// View of a matrix of floats.
+  typedef basic_matrix_view<float> matrix_view_f;
+
+
+  ///
+  /// Non-owning view of a volume: <frames> matrices of rows x cols values, e.g. the
+  /// same matrix at successive timesteps.  Rows are pitch() values apart and frames
+  /// frame_pitch() values apart.  A ublas matrix with the frames stacked one above 
+  /// the other, so that value (r, c) of frame f is at (f*rows + r, c), converts
+  /// to a volume view; this is also the layout the EZW decoder produces for 3d data.
+  /// 
+  template <class T>
+  class basic_volume_view {
+  public:
+    /// View of frames of rows x cols values at data.
+    basic_volume_view(T *data, size_t rows, size_t cols, size_t frames, 
+                      size_t pitch, size_t frame_pitch)
+      : data_(data), rows_(rows), cols_(cols), frames_(frames), pitch_(pitch), 
+        frame_pitch_(frame_pitch) { }
+
+    /// View of frames of rows x cols contiguous values at data.
+    basic_volume_view(T *data, size_t rows, size_t cols, size_t frames)
+      : data_(data), rows_(rows), cols_(cols), frames_(frames), pitch_(cols), 
+        frame_pitch_(rows * cols) { }
+
+    /// View of a ublas matrix holding <frames> frames stacked vertically.  The 
+    /// matrix's rows must divide evenly into frames.
+    basic_volume_view(boost::numeric::ublas::matrix<T>& mat, size_t frames)
+      : data_(mat.data().begin()), rows_(frames ? mat.size1() / frames : 0), 
+        cols_(mat.size2()), frames_(frames), pitch_(mat.size2()), 
+        frame_pitch_(rows_ * mat.size2()) { }
+
+    /// Rows in each frame.
+    size_t size1() const { return rows_; }
+
+    /// Columns in each frame.
+    size_t size2() const { return cols_; }
+
+    /// Number of frames.
+    size_t size3() const { return frames_; }
+
+    /// Number of values from the start of one row to the start of the next.
+    size_t pitch() const { return pitch_; }
+
+    /// Number of values from the start of one frame to the start of the next.
+    size_t frame_pitch() const { return frame_pitch_; }
+
+    /// First value in the volume.
+    T *data() const { return data_; }
+
+    /// View of frame f.
+    basic_matrix_view<T> frame(size_t f) const {
+      return basic_matrix_view<T>(data_ + f * frame_pitch_, rows_, cols_, pitch_);
+    }
+
+    /// Element access.
+    T& operator()(size_t i, size_t j, size_t f) const { 
+      return data_[f * frame_pitch_ + i * pitch_ + j]; 
+    }
+
+  private:
+    T *data_;             ///< First value.
+    size_t rows_;         ///< Rows in each frame.
+    size_t cols_;         ///< Columns in each frame.
+    size_t frames_;       ///< Frames in the view.
+    size_t pitch_;        ///< Values from one row to the next.
+    size_t frame_pitch_;  ///< Values from one frame to the next.
+  };
+
+  /// View of a volume of doubles.
+  typedef basic_volume_view<double> volume_view;
+
+  /// View of a volume of floats.
+  typedef basic_volume_view<float> volume_view_f;
+
 } // namespaces
 
 #endif // NAMI_MATRIX_H
@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include "packet_tree.h"
+#include "io_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  packet_tree::packet_tree() { }
+
+
+  packet_tree::packet_tree(int level) {
+    // the pyramid's flags: each level splits the low-low band ahead of 3 leaves.
+    vector<bool> preorder;
+    for (int i=0; i < level; i++) {
+      preorder.push_back(true);
+    }
+    preorder.push_back(false);
+    preorder.insert(preorder.end(), 3 * level, false);
+
+    size_t pos = 0;
+    build(preorder, pos);
+  }
+
+
+  packet_tree::packet_tree(const vector<bool>& preorder) {
+    size_t pos = 0;
+    build(preorder, pos);
+    if (pos != preorder.size()) {
+      throw runtime_error("Error: extra flags after packet tree.");
+    }
+  }
+
+
+  size_t packet_tree::build(const vector<bool>& preorder, size_t& pos) {
+    if (pos >= preorder.size()) {
+      throw runtime_error("Error: packet tree flags end early.");
+    }
+
+    const size_t n = nodes_.size();
+    nodes_.push_back(node());
+    nodes_[n].split = preorder[pos++];
+    fill(nodes_[n].child, nodes_[n].child + 4, 0);
+
+    if (nodes_[n].split) {
+      for (int q=0; q < 4; q++) {
+        const size_t c = build(preorder, pos);
+        nodes_[n].child[q] = c;
+      }
+    }
+    return n;
+  }
+
+
+  int packet_tree::depth() const {
+    return empty() ? 0 : depth(0);
+  }
+
+
+  int packet_tree::depth(size_t n) const {
+    if (!split(n)) return 0;
+    int d = 0;
+    for (int q=0; q < 4; q++) {
+      d = max(d, depth(child(n, q)));
+    }
+    return d + 1;
+  }
+
+
+  int packet_tree::pyramid_level() const {
+    int level = 0;
+    for (size_t n=0; !empty() && split(n); n = child(n, 0)) {
+      level++;
+    }
+    return level;
+  }
+
+
+  vector<bool> packet_tree::preorder() const {
+    // nodes_ are kept in preorder.
+    vector<bool> flags(nodes_.size());
+    for (size_t i=0; i < nodes_.size(); i++) {
+      flags[i] = nodes_[i].split;
+    }
+    return flags;
+  }
+
+
+  bool packet_tree::operator==(const packet_tree& other) const {
+    return preorder() == other.preorder();
+  }
+
+
+  size_t packet_tree::write_out(ostream& out) const {
+    const vector<bool> flags = preorder();
+    size_t size = io_utils::vl_write(out, flags.size());
+
+    vector<unsigned char> bytes((flags.size() + 7) / 8, 0);
+    for (size_t i=0; i < flags.size(); i++) {
+      if (flags[i]) bytes[i >> 3] |= (0x80 >> (i & 7));
+    }
+    if (!bytes.empty()) {
+      out.write((char*)&bytes[0], bytes.size());
+    }
+    return size + bytes.size();
+  }
+
+
+  void packet_tree::read_in(istream& in, packet_tree& tree) {
+    vector<bool> flags(io_utils::vl_read(in));
+
+    vector<unsigned char> bytes((flags.size() + 7) / 8);
+    if (!bytes.empty()) {
+      in.read((char*)&bytes[0], bytes.size());
+    }
+    for (size_t i=0; i < flags.size(); i++) {
+      flags[i] = bytes[i >> 3] & (0x80 >> (i & 7));
+    }
+    tree = flags.empty() ? packet_tree() : packet_tree(flags);
+  }
+
+} // namespace nami
@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef NAMI_PACKET_TREE_H
+#define NAMI_PACKET_TREE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+/// \file packet_tree.h
+/// Wavelet packet bases for 2d transforms.  The pyramid done by wt_2d::fwt_2d() 
+/// splits only the lowest-frequency subband at each level; a packet basis can 
+/// split any subband, so energetic high-frequency bands (e.g. periodic patterns 
+/// across ranks) are compacted too.  See wt_packet.h for the transforms.
+namespace nami {
+
+  /// Rectangle of a matrix occupied by one subband of a packet basis.
+  struct subband {
+    size_t row;    ///< First row of the subband
+    size_t col;    ///< First column of the subband
+    size_t rows;   ///< Rows in the subband
+    size_t cols;   ///< Columns in the subband
+
+    subband(size_t r, size_t c, size_t nr, size_t nc) 
+      : row(r), col(c), rows(nr), cols(nc) { }
+
+    /// Subband that quadrant q of this one becomes when it is split by one level 
+    /// of fwt_2d().  Bit 1 of q selects the high rows and bit 0 the high columns,
+    /// so quadrant 0 is the low-low band.  Low bands get the extra value of an 
+    /// odd length.
+    subband quadrant(int q) const {
+      const size_t low_rows = (rows + 1) / 2;
+      const size_t low_cols = (cols + 1) / 2;
+      return subband((q & 2) ? row + low_rows : row, 
+                     (q & 1) ? col + low_cols : col,
+                     (q & 2) ? rows - low_rows : low_rows,
+                     (q & 1) ? cols - low_cols : low_cols);
+    }
+  };
+
+
+  /// Quadtree of the subbands in a wavelet packet basis.  Node 0 is the whole 
+  /// matrix; a split node has four children, one per quadrant (see 
+  /// subband::quadrant()), and leaves are the subbands of the basis.
+  class packet_tree {
+  public:
+    /// Empty tree.  Used in headers of data coded without a packet basis.
+    packet_tree();
+
+    /// The usual pyramid of wt_2d::fwt_2d(), which splits only the low-low band,
+    /// <level> times.  Level 0 is a single leaf for untransformed data.
+    explicit packet_tree(int level);
+
+    /// Builds a tree from split flags in preorder: each node's flag is followed by
+    /// the flags of its children's subtrees, if it is split.  Throws 
+    /// std::runtime_error if the flags do not describe a whole tree.
+    explicit packet_tree(const std::vector<bool>& preorder);
+
+    /// True if the tree has no nodes.
+    bool empty() const { return nodes_.empty(); }
+
+    /// Number of nodes in the tree.
+    size_t size() const { return nodes_.size(); }
+
+    /// True if node is split into four children.
+    bool split(size_t node) const { return nodes_[node].split; }
+
+    /// Child of a split node for quadrant q.
+    size_t child(size_t node, int q) const { return nodes_[node].child[q]; }
+
+    /// Greatest number of splits from the root to a leaf.
+    int depth() const;
+
+    /// Number of times the low-low band is split, i.e. the level of the pyramid 
+    /// within this basis.
+    int pyramid_level() const;
+
+    /// Split flags of the tree in preorder.  @see packet_tree(const std::vector<bool>&)
+    std::vector<bool> preorder() const;
+
+    bool operator==(const packet_tree& other) const;
+    bool operator!=(const packet_tree& other) const { return !(*this == other); }
+
+    /// Writes the tree's split flags, packed into bytes.  Returns bytes written.
+    size_t write_out(std::ostream& out) const;
+
+    /// Reads a tree written by write_out().
+    static void read_in(std::istream& in, packet_tree& tree);
+
+  private:
+    struct node {
+      bool split;
+      size_t child[4];
+    };
+    std::vector<node> nodes_;   ///< Nodes of the tree, in preorder.
+
+    /// Appends the subtree whose flags start at preorder[pos]; returns its root.
+    size_t build(const std::vector<bool>& preorder, size_t& pos);
+    int depth(size_t n) const;
+  };
+
+} // namespace nami
+
+#endif // NAMI_PACKET_TREE_H
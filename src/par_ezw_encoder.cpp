@@ -39,7 +39,6 @@
 #include "par_ezw_encoder.h"
 #include "mpi_profile.h"
 #include "mpi_utils.h"
-#include "matrix_utils.h"
 #include "io_utils.h"
 #include "two_utils.h"
 #include "wt_utils.h"
@@ -338,28 +337,39 @@ namespace nami {
   size_t par_ezw_encoder::encode(nami_matrix& mat, ostream& out, int level, MPI_Comm comm) {
     timer_.clear();
 
+    // quantize entire matrix
+    quantize(mat.data().begin(), mat.size1(), mat.size2(), mat.size2(), scale_);
+    return encode_distributed(out, level, comm);
+  }
+
+
+  size_t par_ezw_encoder::encode(const matrix_view& mat, ostream& out, int level, MPI_Comm comm) {
+    timer_.clear();
+    quantize(mat.data(), mat.size1(), mat.size2(), mat.pitch(), scale_);
+    return encode_distributed(out, level, comm);
+  }
+
+
+  size_t par_ezw_encoder::encode_distributed(ostream& out, int level, MPI_Comm comm) {
     int size, rank;
     MPI_Comm_size(comm, &size);
     MPI_Comm_rank(comm, &rank);
 
-    level = compute_level(level, mat.size1(), mat.size2());
-
-    // quantize entire matrix
-    quantize(mat, scale_);
+    level = compute_level(level, quantized_.size1(), quantized_.size2());
 
     // get the mean of the quantized matrix to subtract out
-    quantized_t total = matrix_utils::sum(quantized_);
+    quantized_t total = sum_;
 
     quantized_t all_total;
     MPI_Allreduce(&total, &all_total, 1, MPI_QUANTIZED_T, MPI_SUM, comm);
 
     quantized_t elts = (quantized_.size1() * quantized_.size2() * size);
     quantized_t all_mean = (quantized_t)round(all_total / (double)elts);
-    subtract_scalar(all_mean);
 
     // First set up the header data
     // max and mean need to be computed across entire system.  Allreduces do this here.
-    quantized_t abs_max = matrix_utils::abs_max_val(quantized_);
+    // The mean is subtracted out as the zerotree map is built.
+    quantized_t abs_max = abs_max_about(all_mean);
     quantized_t all_abs_max;
     MPI_Allreduce(&abs_max, &all_abs_max, 1, MPI_QUANTIZED_T, MPI_MAX, comm);
 
@@ -368,10 +378,11 @@ namespace nami {
     // Compute threshold and level in standard way.
     threshold_ = le_power_of_2((uint64_t)all_abs_max);
 
-    vector_obitstream local_bits(mat.size1() * mat.size2() * sizeof(double));
+    vector_obitstream local_bits(quantized_.size1() * quantized_.size2() * sizeof(double));
 
     // construct header
-    ezw_header header(mat.size1() * size, mat.size2(), level, all_mean, scale_, threshold_, enc_type_);
+    ezw_header header(quantized_.size1() * size, quantized_.size2(), level, all_mean, scale_, 
+                      threshold_, enc_type_);
 
     if (use_sequential_order_) {
       // first encode data into a local buffer, but output byte-aligned passes
@@ -57,6 +57,12 @@ namespace nami {
     /// process size/2.
     size_t encode(nami_matrix& mat, std::ostream& out, int level = -1, 
                   MPI_Comm comm = MPI_COMM_WORLD);
+
+    /// Parallel encode of a view, e.g. of a padded matrix or an application's own
+    /// buffer transformed in place by par_wt.
+    /// @see encode(nami_matrix&, std::ostream&, int, MPI_Comm)
+    size_t encode(const matrix_view& mat, std::ostream& out, int level = -1, 
+                  MPI_Comm comm = MPI_COMM_WORLD);
     
 
     /// Sets whether this uses a traversal ordering that's compatible with the 
@@ -75,6 +81,10 @@ namespace nami {
     /// Whether we output EZW bits in same order as sequential coder.  Defaults to false.
     bool use_sequential_order_;
 
+    /// Encodes the values in quantized_ with the rest of comm.  Used by both 
+    /// encode() calls.
+    size_t encode_distributed(std::ostream& out, int level, MPI_Comm comm);
+
     size_t bit_stitch_encode(const unsigned char *passes, size_t total_bytes, std::ostream& out, 
 			     ezw_header& header, MPI_Comm comm);
     
@@ -45,56 +45,60 @@ using namespace std;
 namespace nami {
 
   // Just delegates to superclass.
-  par_wt::par_wt(filter_bank& f) : wt_1d_direct(f) { }
+  template <class T>
+  basic_par_wt<T>::basic_par_wt(filter_bank& f) 
+    : basic_wt_1d_direct<T>(f), plan_rows_(0), plan_cols_(0), plan_pitch_(0), 
+      plan_comm_(MPI_COMM_NULL), grid_rows_(1), grid_cols_(1), north_(MPI_PROC_NULL), 
+      south_(MPI_PROC_NULL), west_(MPI_PROC_NULL), east_(MPI_PROC_NULL) { }
+
+  // Frees the communication plan.
+  template <class T>
+  basic_par_wt<T>::~basic_par_wt() { 
+    free_plan();
+  }
 
-  // Does nothing.
-  par_wt::~par_wt() { }
 
+  template <class T>
+  int basic_par_wt<T>::fwt_2d(view_type mat, int level, MPI_Comm comm) {
+    T *local = mat.data();
+    const size_t size1 = mat.size1();
+    const size_t size2 = mat.size2();
+    const size_t pitch = mat.pitch();
 
-  int par_wt::fwt_2d(nami_matrix& local, int level, MPI_Comm comm) {
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
-    
-    // This pushes the level as low as possible without requiring 
-    // more than nearest-neighbor communication
+    // set up communication, unless it's already set up for this shape.
+    plan(size1, size2, pitch, comm);
     if (level < 0) {
-      size_t rows = local.size1();
-      for (level = 0; rows > f_.size/2+1; level++) {
-        rows >>= 1;
-      }
+      level = default_level(size1, size2);
     }
 
     // ensure local size is divisible by 2 level times.
-    assert(times_divisible_by_2(local.size1()) >= level);
-
-    nami_matrix left, right;
+    assert(times_divisible_by_2(size1) >= level);
+    assert(grid_cols_ == 1 || times_divisible_by_2(size2) >= level);
+    plan_levels(level);
 
     for (int l=0; l < level; l++) {
-      size_t rows = local.size1() >> l;
-      size_t cols = local.size2() >> l;
-
-      // do local transform within rows using direct convolution method.
-      for (size_t r=0; r < rows; r++) {
-        fwt_row(local, r, cols);
+      size_t rows = size1 >> l;
+      size_t cols = size2 >> l;
+
+      if (grid_cols_ > 1) {
+        // rows are split over columns of the grid; exchange their ends, too.
+        exchange& ex = fwt_row_plan_[l];
+        start_exchange(ex, local, pitch);
+        transform_lines(local, pitch, cols, rows, true, ex.reqs, false);
+
+      } else {
+        // do local transform within rows using direct convolution method.
+        for (size_t r=0; r < rows; r++) {
+          fwt_row(local + r * pitch, cols);
+        }
       }
 
-      // async requests for sends/recvs of remove columns
-      vector<MPI_Request> reqs;
-      fwt_exchange(left, local, right, rows, cols, reqs, comm);
-
-      // wait on communication (TODO: overlap comm & local computation) 
-      MPI_Status statuses[reqs.size()];
-      MPI_Waitall(reqs.size(), &reqs[0], statuses);
-
-      size_t tsize = rows + 2 * (f_.size/2) + 1;
-      if (temp_.size() < tsize) temp_.resize(tsize);
+      // start sends/recvs of remote columns
+      exchange& ex = fwt_plan_[l];
+      start_exchange(ex, local, pitch);
 
-      // now do all column computations 
-      for (size_t c=0; c < cols; c++) {	
-        build_temp(left, local, right, rows, c, rank, size);
-        fwt_col(local, c, rows);
-      }
+      // now do all column computations, the interior while communication is in flight
+      transform_lines(local, pitch, rows, cols, false, ex.reqs, false);
     }
 
     // return level so that caller knows what's needed to get a full transform
@@ -102,46 +106,45 @@ namespace nami {
   }
 
 
-  int par_wt::iwt_2d(nami_matrix& local, int level, MPI_Comm comm) {
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
-    
-    // push level as low as possible without losing nearest-neighbor comm
+  template <class T>
+  int basic_par_wt<T>::iwt_2d(view_type mat, int level, MPI_Comm comm) {
+    T *local = mat.data();
+    const size_t size1 = mat.size1();
+    const size_t size2 = mat.size2();
+    const size_t pitch = mat.pitch();
+
+    plan(size1, size2, pitch, comm);
     if (level < 0) {
-      size_t rows = local.size1();
-      for (level = 0; rows > f_.size/2+1; level++) {
-        rows >>= 1;
-      }
+      level = default_level(size1, size2);
     }
 
     // ensure divisible by 2 level times.
-    assert(times_divisible_by_2(local.size1()) >= level);
-
-    nami_matrix left, right;
+    assert(times_divisible_by_2(size1) >= level);
+    assert(grid_cols_ == 1 || times_divisible_by_2(size2) >= level);
+    plan_levels(level);
 
     size_t rows, cols;
     for (int l=level-1; l >= 0; l--) {
-      rows = local.size1() >> l;
-      cols = local.size2() >> l;
+      rows = size1 >> l;
+      cols = size2 >> l;
 
-      // async requests for sends/recvs of remove columns
-      vector<MPI_Request> reqs;
-      iwt_exchange(left, local, right, rows, cols, reqs, comm);
+      // start sends/recvs of remote columns
+      exchange& ex = iwt_plan_[l];
+      start_exchange(ex, local, pitch);
 
-      // wait on communication (TODO: overlap comm & computation) 
-      MPI_Status statuses[reqs.size()];
-      MPI_Waitall(reqs.size(), &reqs[0], statuses);
+      // now do all column computations, the interior while communication is in flight
+      transform_lines(local, pitch, rows, cols, false, ex.reqs, true);
 
-      // now do all column computations 
-      for (size_t c=0; c < cols; c++) {	
-        build_temp(left, local, right, rows, c, rank, size, true);
-        iwt_col(local, c, rows);
-      }
+      if (grid_cols_ > 1) {
+        exchange& ex = iwt_row_plan_[l];
+        start_exchange(ex, local, pitch);
+        transform_lines(local, pitch, cols, rows, true, ex.reqs, true);
 
-      // do local iwt within rows using convolution method.
-      for (size_t r=0; r < rows; r++) {
-        iwt_row(local, r, cols);
+      } else {
+        // do local iwt within rows using convolution method.
+        for (size_t r=0; r < rows; r++) {
+          iwt_row(local + r * pitch, cols);
+        }
       }
     }
 
@@ -150,7 +153,42 @@ namespace nami {
   }
 
 
-  void par_wt::aggregate(nami_matrix& mat, vector<double>& local, int m, int set,
+  template <class T>
+  int basic_par_wt<T>::default_level(size_t rows, size_t cols) {
+    // This pushes the level as low as possible without requiring 
+    // more than nearest-neighbor communication, in each dimension split over processes.
+    int level;
+    for (level = 0; rows > f_.size/2+1; level++) {
+      rows >>= 1;
+    }
+    if (grid_cols_ > 1) {
+      int col_level;
+      for (col_level = 0; cols > f_.size/2+1; col_level++) {
+        cols >>= 1;
+      }
+      level = min(level, col_level);
+    }
+    return level;
+  }
+
+
+  template <class T>
+  bool basic_par_wt<T>::grid_dims(MPI_Comm comm, int dims[2], int coords[2]) {
+    int topo, ndims = 0;
+    MPI_Topo_test(comm, &topo);
+    if (topo == MPI_CART) {
+      MPI_Cartdim_get(comm, &ndims);
+    }
+    if (ndims != 2) return false;
+
+    int periods[2];
+    MPI_Cart_get(comm, 2, dims, periods, coords);
+    return true;
+  }
+
+
+  template <class T>
+  void basic_par_wt<T>::aggregate(matrix_type& mat, vector<T>& local, int m, int set,
                               vector<MPI_Request>& reqs, MPI_Comm comm) {
     int rank;
     MPI_Comm_rank(comm, &rank);
@@ -163,7 +201,7 @@ namespace nami {
       for (int i=0; i < m; i++) {
         if (i == set) continue;
         reqs.push_back(MPI_REQUEST_NULL);
-        MPI_Irecv(&mat(i,0), local.size(), MPI_DOUBLE, base+i, 0, comm, &reqs.back());
+        MPI_Irecv(&mat(i,0), local.size(), mpi_typeof(T()), base+i, 0, comm, &reqs.back());
       }
 
       for (size_t i=0; i < local.size(); i++) {  // copy local data into matrix, too
@@ -173,12 +211,13 @@ namespace nami {
     } else {
       // send this process's data to the aggregating process
       reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local[0], local.size(), MPI_DOUBLE, base+set, 0, comm, &reqs.back());
+      MPI_Isend(&local[0], local.size(), mpi_typeof(T()), base+set, 0, comm, &reqs.back());
     }
   }
 
 
-  void par_wt::distribute(nami_matrix& mat, vector<double>& local, int m, int set,
+  template <class T>
+  void basic_par_wt<T>::distribute(matrix_type& mat, vector<T>& local, int m, int set,
                                vector<MPI_Request>& reqs, MPI_Comm comm) {
     int rank;
     MPI_Comm_rank(comm, &rank);
@@ -189,7 +228,7 @@ namespace nami {
       for (int i=0; i < m; i++) {
         if (i == set) continue;
         reqs.push_back(MPI_REQUEST_NULL);
-        MPI_Isend(&mat(i,0), local.size(), MPI_DOUBLE, base+i, 0, comm, &reqs.back());
+        MPI_Isend(&mat(i,0), local.size(), mpi_typeof(T()), base+i, 0, comm, &reqs.back());
       }
 
       for (size_t i=0; i < local.size(); i++) {  // copy local data into matrix, too
@@ -199,12 +238,13 @@ namespace nami {
     } else {
       // send this process's data to the aggregating process
       reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&local[0], local.size(), MPI_DOUBLE, base+set, 0, comm, &reqs.back());
+      MPI_Irecv(&local[0], local.size(), mpi_typeof(T()), base+set, 0, comm, &reqs.back());
     }
   }
 
 
-  void par_wt::gather(nami_matrix& mat, nami_matrix& remote, MPI_Comm comm, int root) {
+  template <class T>
+  void basic_par_wt<T>::gather(matrix_type& mat, matrix_type& remote, MPI_Comm comm, int root) {
     int rank, size;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
@@ -217,37 +257,103 @@ namespace nami {
     } 
 
     // gather remote matrices to root
-    MPI_Gather(&remote(0,0), remote.size1() * remote.size2(), MPI_DOUBLE,
-               recvbuf,      remote.size1() * remote.size2(), MPI_DOUBLE, 
+    MPI_Gather(&remote(0,0), remote.size1() * remote.size2(), mpi_typeof(T()),
+               recvbuf,      remote.size1() * remote.size2(), mpi_typeof(T()), 
                root, comm);
+
+    // blocks from a 2d grid arrive in rank order; put each where it is in the grid.
+    int dims[2], coords[2];
+    if (rank == root && grid_dims(comm, dims, coords) && dims[1] > 1) {
+      const size_t R = remote.size1();
+      const size_t C = remote.size2();
+      matrix_type blocks(mat);
+      mat.resize(dims[0] * R, dims[1] * C, false);
+      for (int p=0; p < size; p++) {
+        MPI_Cart_coords(comm, p, 2, coords);
+        for (size_t i=0; i < R; i++) {
+          for (size_t j=0; j < C; j++) {
+            mat(coords[0] * R + i, coords[1] * C + j) = blocks(p * R + i, j);
+          }
+        }
+      }
+    }
   }
 
 
-  void par_wt::scatter(nami_matrix& mat, nami_matrix& remote, MPI_Comm comm, int root) {
+  template <class T>
+  void basic_par_wt<T>::scatter(matrix_type& local, matrix_type& mat, MPI_Comm comm, int root) {
     int rank, size;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
 
-    void *recvbuf = NULL;
-    if (rank == root) {
-      // root needs space enough for all data
-      mat.resize(size * remote.size1(), remote.size2());
-      recvbuf = &mat(0,0);
-    } 
+    // only root has the whole matrix, but everyone needs the size of their block.
+    unsigned long shape[2] = { mat.size1(), mat.size2() };
+    MPI_Bcast(shape, 2, MPI_UNSIGNED_LONG, root, comm);
+
+    int dims[2], coords[2];
+    const bool grid = grid_dims(comm, dims, coords) && dims[1] > 1;
+    const int P = grid ? dims[0] : size;
+    const int Q = grid ? dims[1] : 1;
+    assert(shape[0] % P == 0 && shape[1] % Q == 0);
+    const size_t R = shape[0] / P;
+    const size_t C = shape[1] / Q;
+    local.resize(R, C, false);
+
+    // empty blocks have no first element to point at, and MPI needs none.
+    void *sendbuf = NULL;
+    void *recvbuf = (R * C > 0) ? &local(0,0) : NULL;
+    matrix_type blocks;
+    if (rank == root && R * C > 0) {
+      sendbuf = &mat(0,0);
+
+      // blocks for a 2d grid go out in rank order; take each from where it is in the grid.
+      if (grid) {
+        blocks.resize(size * R, C, false);
+        for (int p=0; p < size; p++) {
+          MPI_Cart_coords(comm, p, 2, coords);
+          for (size_t i=0; i < R; i++) {
+            for (size_t j=0; j < C; j++) {
+              blocks(p * R + i, j) = mat(coords[0] * R + i, coords[1] * C + j);
+            }
+          }
+        }
+        sendbuf = &blocks(0,0);
+      }
+    }
 
-    // gather remote matrices to root
-    MPI_Gather(&remote(0,0), remote.size1() * remote.size2(), MPI_DOUBLE,
-               recvbuf,      remote.size1() * remote.size2(), MPI_DOUBLE, 
-               root, comm);
+    // scatter blocks from root to everyone
+    MPI_Scatter(sendbuf, R * C, mpi_typeof(T()),
+                recvbuf, R * C, mpi_typeof(T()), 
+                root, comm);
+  }
+
+
+
+  template <class T>
+  void basic_par_wt<T>::reassemble(matrix_type& mat, int P, int level) {
+    reassemble_rows(mat, P, level, mat.size2());
   }
 
 
+  template <class T>
+  void basic_par_wt<T>::reassemble(matrix_type& mat, int P, int Q, int level) {
+    // Rows first.  Columns are still in each process's own order, so which levels 
+    // a column took part in depends on where it is in its block.
+    reassemble_rows(mat, P, level, mat.size2() / Q);
 
-  void par_wt::reassemble(nami_matrix& mat, int P, int level) {
+    // Then columns, the same way.  Rows are now in the usual order.
+    matrix_type cols = trans(mat);
+    reassemble_rows(cols, Q, level, cols.size2());
+    mat = trans(cols);
+  }
+
+
+  template <class T>
+  void basic_par_wt<T>::reassemble_rows(matrix_type& mat, int P, int level, size_t block) {
     size_t rows = mat.size1();
     size_t cols = mat.size2();
 
-    nami_matrix temp = mat;
+    matrix_type temp = mat;
     size_t S = rows / P;   // rows per process
 
     // range of columns to process per outer-loop iteration.  
@@ -258,7 +364,7 @@ namespace nami {
     //size_t cend = cols >> (level-1);
 
     for (int i=0; i < level; i++) {
-      size_t cend = cols >> (level-i-1); // upper bound on columns to swap on this iteration
+      size_t cend = block >> (level-i-1); // upper bound on columns to swap on this iteration
       size_t L = S >> (level-i);         // number of elements to copy per level
       size_t row = 0;                    // destination row counter for both loops below
       
@@ -266,8 +372,10 @@ namespace nami {
       // these are just at the lowest level.
       for (int p = 0; p < P; p++) {
         for (size_t l=0; l < L; l++) {
-          for (size_t c=cstart; c < cend; c++) {
-            mat(row, c) = temp(p*S+l, c);
+          for (size_t b=0; b < cols; b += block) {
+            for (size_t c=b+cstart; c < b+cend; c++) {
+              mat(row, c) = temp(p*S+l, c);
+            }
           }
           row++;
         }
@@ -279,8 +387,10 @@ namespace nami {
         // grab difference coefficients in proper order
         for (int p = 0; p < P; p++) {
           for (size_t l=0; l < L; l++) {
-            for (size_t c=cstart; c < cend; c++) {
-              mat(row, c) = temp(p*S+roff+l, c);
+            for (size_t b=0; b < cols; b += block) {
+              for (size_t c=b+cstart; c < b+cend; c++) {
+                mat(row, c) = temp(p*S+roff+l, c);
+              }
             }
             row++;
           }
@@ -293,138 +403,378 @@ namespace nami {
   }
 
 
-  // PRE: temp has been filled in by fwt_2d()
-  void par_wt::fwt_col(nami_matrix& mat, size_t col, size_t n) {
+  template <class T>
+  void basic_par_wt<T>::transform_lines(T *local, size_t pitch, size_t n, size_t lines, 
+                                        bool across, vector<MPI_Request>& reqs, bool inverse) {
+    // Lines are columns, or rows if across.  step is between values of a line, and 
+    // line_pitch between lines.
+    const size_t step = across ? 1 : pitch;
+    const size_t line_pitch = across ? pitch : 1;
+    matrix_type& lo_halo = across ? west_cols_ : north_rows_;
+    matrix_type& hi_halo = across ? east_cols_ : south_rows_;
+    const bool has_lo = (across ? west_ : north_) != MPI_PROC_NULL;
+    const bool has_hi = (across ? east_ : south_) != MPI_PROC_NULL;
+
+    // Output pair p of a line reads temp_[2p, 2p + f_.size], and the line's local 
+    // values are temp_[h, n + h).  Pairs in [lo, hi) read no remote values.
     assert(even(n));
+    const size_t h = f_.size/2;
+    const size_t lo = (h + 1) / 2;
+    const size_t hi = (n + h > f_.size) ? min((n + h - 1 - f_.size) / 2 + 1, n/2) : 0;
+
+    if (lo >= hi) {
+      // no interior to speak of; wait for the remote values, then do whole lines.
+      if (!reqs.empty()) MPI_Waitall(reqs.size(), &reqs[0], MPI_STATUSES_IGNORE);
+      for (size_t c=0; c < lines; c++) {	
+        T *line = local + c * line_pitch;
+        build_temp(lo_halo, line, step, hi_halo, n, c, has_lo, has_hi, inverse);
+        if (inverse) iwt_col(line, step, 0, n/2);
+        else         fwt_col(line, step, n, 0, n/2);
+      }
+      return;
+    }
 
-    size_t len = n >> 1;
-    for (size_t i=0; i < len; i++) {
-      mat(i, col) = mat(len+i, col) = 0;
+    // Interior pairs of each line are done while messages are in flight.  The 
+    // transform is in place, so the values at the ends of the line that the 
+    // boundary pairs and the symmetric extension need are saved first.
+    const size_t edge = min(n, f_.size + h + 2);
+    if (edges_.size() < 2 * edge * lines) edges_.resize(2 * edge * lines);
+    for (size_t c=0; c < lines; c++) {
+      T *line = local + c * line_pitch;
+      fill_temp(line, step, n, inverse);
+      T *saved = &edges_[2 * edge * c];
+      copy(&temp_[h], &temp_[h + edge], saved);
+      copy(&temp_[n + h - edge], &temp_[n + h], saved + edge);
+      if (inverse) iwt_col(line, step, lo, hi);
+      else         fwt_col(line, step, n, lo, hi);
+    }
 
-      for (size_t d=0; d < f_.size; d++) {
-        mat(i, col) += f_.lpf[d] * temp_[2*i+d];
-        mat(len+i, col) += f_.hpf[d] * temp_[2*i+d+1];
+    if (!reqs.empty()) MPI_Waitall(reqs.size(), &reqs[0], MPI_STATUSES_IGNORE);
+
+    // Then the boundary pairs, with the remote values.
+    for (size_t c=0; c < lines; c++) {
+      T *line = local + c * line_pitch;
+      const T *saved = &edges_[2 * edge * c];
+      copy(saved, saved + edge, &temp_[h]);
+      copy(saved + edge, saved + 2 * edge, &temp_[n + h - edge]);
+      fill_halo(lo_halo, hi_halo, n, c, has_lo, has_hi);
+      if (inverse) {
+        iwt_col(line, step, 0, lo);
+        iwt_col(line, step, hi, n/2);
+      } else {
+        fwt_col(line, step, n, 0, lo);
+        fwt_col(line, step, n, hi, n/2);
       }
     }
   }
-  
+
+
+  // PRE: temp has been filled in by fwt_2d()
+  template <class T>
+  void basic_par_wt<T>::fwt_col(T *col, size_t pitch, size_t n, size_t first, size_t last) {
+    if (this->folded_) {
+      fwt_col(sym_fir_kernel<basic_wt_1d_direct<T>::folded_size>(), col, pitch, n, first, last);
+    } else {
+      fwt_col(fir_kernel(f_.size), col, pitch, n, first, last);
+    }
+  }
+
 
   // PRE: temp has been filled in by iwt_2d()
-  void par_wt::iwt_col(nami_matrix& mat, size_t col, size_t n) {
+  template <class T>
+  void basic_par_wt<T>::iwt_col(T *col, size_t pitch, size_t first, size_t last) {
+    if (this->folded_) {
+      iwt_col(sym_fir_kernel<basic_wt_1d_direct<T>::folded_size>(), col, pitch, first, last);
+    } else {
+      iwt_col(fir_kernel(f_.size), col, pitch, first, last);
+    }
+  }
+
+
+  template <class T> template <class K>
+  void basic_par_wt<T>::fwt_col(const K& fir, T *col, size_t pitch, size_t n, 
+                                size_t first, size_t last) {
     assert(even(n));
 
-    for (size_t i=0; i < n; i++) {
-      mat(i,col) = 0.0;
-      for (size_t d=0; d < f_.size; d++) {
-        // this check upsamples the two bands in the input data
-        if ((i+d) & 1) mat(i,col) += f_.ihpf[d] * temp_[i+d];
-        else           mat(i,col) += f_.ilpf[d] * temp_[i+d];
+    const double *lpf = f_.lpf;
+    const double *hpf = f_.hpf;
+
+    size_t len = n >> 1;
+    for (size_t i=first; i < last; i++) {
+      const T *t = &temp_[2*i];
+      col[i * pitch] = fir(lpf, t, 1);
+      col[(len+i) * pitch] = fir(hpf, t+1, 1);
+    }
+  }
+  
+
+  template <class T> template <class K>
+  void basic_par_wt<T>::iwt_col(const K& fir, T *col, size_t pitch, 
+                                size_t first, size_t last) {
+    // temp holds the bands interleaved; each output phase has its own taps.
+    const double *even = &even_taps_[0];
+    const double *odd = &odd_taps_[0];
+
+    for (size_t i=2*first; i < 2*last; i += 2) {
+      const T *t = &temp_[i];
+      col[i * pitch] = fir(even, t, 1);
+      col[(i+1) * pitch] = fir(odd, t+1, 1);
+    }
+  }
+
+
+  template <class T>
+  void basic_par_wt<T>::plan(size_t rows, size_t cols, size_t pitch, MPI_Comm comm) {
+    if (!planned_for(comm)) {
+      // The plan keeps its own duplicate of comm, so its requests stay valid after 
+      // the caller frees comm, and its messages never mix with the caller's.
+      free_plan();
+      MPI_Comm_dup(comm, &plan_comm_);
+
+      // Neighbors in a 2d grid come from its coordinates; otherwise rows are split 
+      // over ranks in order.  Grids don't wrap around, even if periodic.
+      int dims[2], coords[2];
+      north_ = south_ = west_ = east_ = MPI_PROC_NULL;
+      if (grid_dims(plan_comm_, dims, coords)) {
+        grid_rows_ = dims[0];
+        grid_cols_ = dims[1];
+        int c[2];
+        if (coords[0] > 0)           { c[0] = coords[0]-1; c[1] = coords[1]; MPI_Cart_rank(plan_comm_, c, &north_); }
+        if (coords[0] < dims[0] - 1) { c[0] = coords[0]+1; c[1] = coords[1]; MPI_Cart_rank(plan_comm_, c, &south_); }
+        if (coords[1] > 0)           { c[0] = coords[0]; c[1] = coords[1]-1; MPI_Cart_rank(plan_comm_, c, &west_);  }
+        if (coords[1] < dims[1] - 1) { c[0] = coords[0]; c[1] = coords[1]+1; MPI_Cart_rank(plan_comm_, c, &east_);  }
+
+      } else {
+        int rank, size;
+        MPI_Comm_rank(plan_comm_, &rank);
+        MPI_Comm_size(plan_comm_, &size);
+        grid_rows_ = size;
+        grid_cols_ = 1;
+        if (rank-1 >= 0)  north_ = rank-1;
+        if (rank+1 < size) south_ = rank+1;
       }
     }
+
+    if (rows == plan_rows_ && cols == plan_cols_ && pitch == plan_pitch_) {
+      return;
+    }
+    free_levels();
+    plan_rows_ = rows;
+    plan_cols_ = cols;
+    plan_pitch_ = pitch;
+
+    // requests are bound to these buffers, so they're sized for all levels up front.
+    north_rows_.resize(f_.size/2, pitch, false);
+    south_rows_.resize(f_.size/2+1, pitch, false);
+    west_cols_.resize(f_.size/2, rows, false);
+    east_cols_.resize(f_.size/2+1, rows, false);
+    send_buf_.resize((f_.size+1) * max(rows, cols));
   }
 
 
-  void par_wt::fwt_exchange(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-                                 size_t rows, size_t cols, vector<MPI_Request>& reqs, MPI_Comm comm) {
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
+  template <class T>
+  bool basic_par_wt<T>::planned_for(MPI_Comm comm) {
+    if (plan_comm_ == MPI_COMM_NULL) return false;
 
-    // create strided datatypes for the rows we'll send.  We only need to 
-    // send <cols> columns from each row.
-    MPI_Datatype left_type, right_type;
-    MPI_Type_vector(f_.size/2, cols, local.size2(), MPI_DOUBLE, &left_type);
-    MPI_Type_commit(&left_type);
+    // Handles are reused once freed, so compare what the plan depends on instead: 
+    // the same ranks in the same order, and the same grid.
+    int result;
+    MPI_Comm_compare(comm, plan_comm_, &result);
+    if (result != MPI_IDENT && result != MPI_CONGRUENT) return false;
 
-    MPI_Type_vector(f_.size/2+1, cols, local.size2(), MPI_DOUBLE, &right_type);
-    MPI_Type_commit(&right_type);
+    int dims[2], coords[2];
+    if (!grid_dims(comm, dims, coords)) {
+      MPI_Comm_size(comm, &dims[0]);
+      dims[1] = 1;
+    }
+    return dims[0] == grid_rows_ && dims[1] == grid_cols_;
+  }
 
-    // Now do the sends and receives to both neighbors.
-    if (rank-1 >= 0) {                  // exchange border rows w/left neighbor.
-      left.resize(f_.size/2, local.size2());  // keep cols at full size, to avoid reallocating
 
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(0,0), 1, right_type, rank-1, 0, comm, &reqs.back());
+  template <class T>
+  void basic_par_wt<T>::plan_levels(int levels) {
+    // add exchanges for any levels not planned yet.
+    for (int l=fwt_plan_.size(); l < levels; l++) {
+      const size_t rows = plan_rows_ >> l;
+      const size_t cols = plan_cols_ >> l;
+      fwt_plan_.push_back(exchange(false, cols));
+      fwt_exchange(fwt_plan_.back(), rows);
+      iwt_plan_.push_back(exchange(false, cols));
+      iwt_exchange(iwt_plan_.back(), rows);
+
+      fwt_row_plan_.push_back(exchange(true, rows));
+      iwt_row_plan_.push_back(exchange(true, rows));
+      if (grid_cols_ > 1) {
+        fwt_exchange(fwt_row_plan_.back(), cols);
+        iwt_exchange(iwt_row_plan_.back(), cols);
+      }
+    }
+  }
 
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&left(0,0), 1, left_type, rank-1, 0, comm, &reqs.back());
+
+  template <class T>
+  void basic_par_wt<T>::free_plan() {
+    free_levels();
+    // nothing to free once MPI is gone, e.g. for a transform destroyed after MPI_Finalize.
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized && plan_comm_ != MPI_COMM_NULL) {
+      MPI_Comm_free(&plan_comm_);
     }
+    plan_comm_ = MPI_COMM_NULL;
+  }
 
-    if (rank+1 < size) {                   // exchange border rows w/right neighbor.
-      right.resize(f_.size/2+1, local.size2());  // keep cols at full size, to prevent realloc
 
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(rows-f_.size/2,0), 1, left_type, rank+1, 0, comm, &reqs.back());
-      
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&right(0,0), 1, right_type, rank+1, 0, comm, &reqs.back());
+  template <class T>
+  void basic_par_wt<T>::free_levels() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+      for (size_t l=0; l < fwt_plan_.size(); l++) {
+        free_requests(fwt_plan_[l]);
+        free_requests(iwt_plan_[l]);
+        free_requests(fwt_row_plan_[l]);
+        free_requests(iwt_row_plan_[l]);
+      }
+      for (size_t i=0; i < types_.size(); i++) MPI_Type_free(&types_[i]);
     }
+    fwt_plan_.clear();
+    iwt_plan_.clear();
+    fwt_row_plan_.clear();
+    iwt_row_plan_.clear();
+    types_.clear();
+    plan_rows_ = plan_cols_ = plan_pitch_ = 0;
+  }
+
 
-    MPI_Type_free(&left_type);
-    MPI_Type_free(&right_type);
+  template <class T>
+  void basic_par_wt<T>::free_requests(exchange& ex) {
+    for (size_t i=0; i < ex.reqs.size(); i++) {
+      MPI_Request_free(&ex.reqs[i]);
+    }
   }
 
 
-  void par_wt::iwt_exchange(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-                                 size_t rows, size_t cols, std::vector<MPI_Request>& reqs, MPI_Comm comm) {
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
+  template <class T>
+  MPI_Datatype basic_par_wt<T>::recv_type(size_t rows, size_t cols, size_t stride) {
+    MPI_Datatype type;
+    MPI_Type_vector(rows, cols, stride, mpi_typeof(T()), &type);
+    MPI_Type_commit(&type);
+    types_.push_back(type);
+    return type;
+  }
 
-    // create strided datatypes for the rows we'll send in each of the subbands
-    // We send with single-column stride and receive 2-column stride, so that the
-    // colums from subbands are interleaved on the destination process
-    MPI_Datatype long_send_type, short_send_type, long_recv_type, short_recv_type;
-    MPI_Type_vector(f_.size/4,   cols, local.size2(),   MPI_DOUBLE, &short_send_type);
-    MPI_Type_vector(f_.size/4+1, cols, local.size2(),   MPI_DOUBLE, &long_send_type);
-    MPI_Type_vector(f_.size/4,   cols, local.size2()*2, MPI_DOUBLE, &short_recv_type);
-    MPI_Type_vector(f_.size/4+1, cols, local.size2()*2, MPI_DOUBLE, &long_recv_type);
 
-    MPI_Type_commit(&long_send_type);
-    MPI_Type_commit(&short_send_type);
-    MPI_Type_commit(&long_recv_type);
-    MPI_Type_commit(&short_recv_type);
+  template <class T>
+  void basic_par_wt<T>::send_lines(exchange& ex, size_t first, size_t count, int dest, int tag) {
+    // blocks are packed one after another in send_buf_.
+    size_t offset = 0;
+    for (size_t i=0; i < ex.count.size(); i++) {
+      offset += ex.count[i] * ex.width;
+    }
+    ex.first.push_back(first);
+    ex.count.push_back(count);
+    ex.reqs.push_back(MPI_REQUEST_NULL);
+    MPI_Send_init(&send_buf_[offset], count * ex.width, mpi_typeof(T()), dest, tag, plan_comm_, 
+                  &ex.reqs.back());
+  }
 
-    // Now do the sends and receives to both neighbors.
-    if (rank-1 >= 0) {                       // exchange border rows w/left neighbor.
-      left.resize(f_.size/2, local.size2());  // keep cols at full size, to avoid reallocating
 
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(0,0), 1, long_send_type, rank-1, 0, comm, &reqs.back());
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(rows/2,0), 1, short_send_type, rank-1, 0, comm, &reqs.back());
+  template <class T>
+  void basic_par_wt<T>::recv_lines(exchange& ex, T *dest, MPI_Datatype type, int source, int tag) {
+    ex.reqs.push_back(MPI_REQUEST_NULL);
+    MPI_Recv_init(dest, 1, type, source, tag, plan_comm_, &ex.reqs.back());
+  }
 
-      // receive rows from left process.  receive automatically interleaves.
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&left(1,0), 1, short_recv_type, rank-1, 0, comm, &reqs.back());
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&left(0,0), 1, short_recv_type, rank-1, 0, comm, &reqs.back());
+
+  template <class T>
+  void basic_par_wt<T>::start_exchange(exchange& ex, const T *local, size_t pitch) {
+    T *send = &send_buf_[0];
+    for (size_t i=0; i < ex.first.size(); i++) {
+      if (ex.across) {
+        send = pack_cols(local + ex.first[i], ex.count[i], pitch, ex.width, send);
+      } else {
+        send = pack_rows(local + ex.first[i] * pitch, ex.count[i], pitch, ex.width, send);
+      }
     }
+    if (!ex.reqs.empty()) MPI_Startall(ex.reqs.size(), &ex.reqs[0]);
+  }
 
-    if (rank+1 < size) {                        // exchange border rows w/right neighbor.
-      right.resize(f_.size/2+1, local.size2());  // keep cols at full size, to prevent realloc
 
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(rows-f_.size/4,0), 1, short_send_type, rank+1, 0, comm, &reqs.back());
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Isend(&local(rows/2-f_.size/4,0), 1, short_send_type, rank+1, 0, comm, &reqs.back());
+  template <class T>
+  void basic_par_wt<T>::fwt_exchange(exchange& ex, size_t n) {
+    // create strided datatypes for the lines we'll receive.  We only need 
+    // <width> values from each line.
+    const int lo = ex.across ? west_ : north_;
+    const int hi = ex.across ? east_ : south_;
+    T *lo_halo = ex.across ? &west_cols_(0,0) : &north_rows_(0,0);
+    T *hi_halo = ex.across ? &east_cols_(0,0) : &south_rows_(0,0);
+    const size_t stride = ex.across ? plan_rows_ : plan_pitch_;
+
+    MPI_Datatype left_type = recv_type(f_.size/2, ex.width, stride);
+    MPI_Datatype right_type = recv_type(f_.size/2+1, ex.width, stride);
+
+    // Now set up the sends and receives to both neighbors.  What we send toward
+    // one neighbor, it receives from the other direction, with the same tag.
+    if (lo != MPI_PROC_NULL) {              // exchange border lines w/left neighbor.
+      send_lines(ex, 0, f_.size/2+1, lo, to_lo_tag);
+      recv_lines(ex, lo_halo, left_type, lo, to_hi_tag);
+    }
 
-      // receive rows from right process.  receive automatically interleaves.
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&right(0,0), 1, long_recv_type, rank+1, 0, comm, &reqs.back());
-      reqs.push_back(MPI_REQUEST_NULL);
-      MPI_Irecv(&right(1,0), 1, short_recv_type, rank+1, 0, comm, &reqs.back());
+    if (hi != MPI_PROC_NULL) {              // exchange border lines w/right neighbor.
+      send_lines(ex, n-f_.size/2, f_.size/2, hi, to_hi_tag);
+      recv_lines(ex, hi_halo, right_type, hi, to_lo_tag);
+    }
+  }
+
+
+  template <class T>
+  void basic_par_wt<T>::iwt_exchange(exchange& ex, size_t n) {
+    // create strided datatypes for the lines we'll receive in each of the subbands.
+    // Lines are received with 2-line stride, so that the lines from subbands are 
+    // interleaved on the destination process.
+    const int lo = ex.across ? west_ : north_;
+    const int hi = ex.across ? east_ : south_;
+    matrix_type& lo_halo = ex.across ? west_cols_ : north_rows_;
+    matrix_type& hi_halo = ex.across ? east_cols_ : south_rows_;
+    const size_t stride = ex.across ? plan_rows_ : plan_pitch_;
+
+    MPI_Datatype short_recv_type = recv_type(f_.size/4,   ex.width, stride*2);
+    MPI_Datatype long_recv_type  = recv_type(f_.size/4+1, ex.width, stride*2);
+
+    // Now set up the sends and receives to both neighbors.  Each subband's block
+    // has its own tag, so the receives can't swap them.
+    if (lo != MPI_PROC_NULL) {              // exchange border lines w/left neighbor.
+      send_lines(ex, 0, f_.size/4+1, lo, to_lo_tag);
+      send_lines(ex, n/2, f_.size/4, lo, to_lo_tag+1);
+
+      // receive lines from left process.  receive automatically interleaves.
+      recv_lines(ex, &lo_halo(1,0), short_recv_type, lo, to_hi_tag);
+      recv_lines(ex, &lo_halo(0,0), short_recv_type, lo, to_hi_tag+1);
+    }
+
+    if (hi != MPI_PROC_NULL) {              // exchange border lines w/right neighbor.
+      send_lines(ex, n-f_.size/4, f_.size/4, hi, to_hi_tag);
+      send_lines(ex, n/2-f_.size/4, f_.size/4, hi, to_hi_tag+1);
+
+      // receive lines from right process.  receive automatically interleaves.
+      recv_lines(ex, &hi_halo(0,0), long_recv_type, hi, to_lo_tag);
+      recv_lines(ex, &hi_halo(1,0), short_recv_type, hi, to_lo_tag+1);
     }
+  }
 
-    MPI_Type_free(&long_send_type);
-    MPI_Type_free(&short_send_type);
-    MPI_Type_free(&long_recv_type);
-    MPI_Type_free(&short_recv_type);
+
+  template <class T>
+  void basic_par_wt<T>::build_temp(matrix_type& left, const T *local, size_t step, 
+                                   matrix_type& right, size_t n, size_t line, 
+                                   bool has_left, bool has_right, bool interleave) {
+    fill_temp(local, step, n, interleave);
+    fill_halo(left, right, n, line, has_left, has_right);
   }
 
 
-  void par_wt::build_temp(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-                               size_t n, size_t col, int rank, int comm_size, bool interleave) {
+  template <class T>
+  void basic_par_wt<T>::fill_temp(const T *local, size_t step, size_t n, bool interleave) {
     size_t tsize = n + 2 * (f_.size/2) + 1;
     if (temp_.size() < tsize) temp_.resize(tsize);
     
@@ -432,31 +782,59 @@ namespace nami {
     if (interleave) {
       // this interleaves first and second half of x in temp
       for (size_t i=0; i < n/2; i++) {
-        temp_[f_.size/2+(2*i)] = local(i, col);
-        temp_[f_.size/2+(2*i+1)] = local((n/2+i), col);
+        temp_[f_.size/2+(2*i)] = local[i*step];
+        temp_[f_.size/2+(2*i+1)] = local[(n/2+i)*step];
       }
 
     } else {
       // this just copies x straight into temp
       for (size_t i=0; i < n; i++) {
-        temp_[f_.size/2+i] = local(i, col);
+        temp_[f_.size/2+i] = local[i*step];
       }
     }
+  }
 
+
+  template <class T>
+  void basic_par_wt<T>::fill_halo(matrix_type& left, matrix_type& right, size_t n, size_t line, 
+                                  bool has_left, bool has_right) {
     // symmetrically extend left and right border around data
     size_t l = f_.size/2-1;
     size_t r = n + f_.size/2;
     for (size_t i=1; i<=f_.size/2; i++) {
-      temp_[l] = (rank - 1 >= 0) ? left(l, col) : temp_[l+2*i];
-      temp_[r] = (rank + 1 < comm_size) ? right(r-n-f_.size/2, col) : temp_[l+n-1];
+      temp_[l] = has_left ? left(l, line) : temp_[l+2*i];
+      temp_[r] = has_right ? right(r-n-f_.size/2, line) : temp_[l+n-1];
       l--;
       r++;
     }
     // last elt on right
-    temp_[r] = (rank + 1 < comm_size) ? right(r-n-f_.size/2, col) : temp_[l+n-1];
+    temp_[r] = has_right ? right(r-n-f_.size/2, line) : temp_[l+n-1];
   }
 
-  
-} // namespace
 
+  template <class T>
+  T *basic_par_wt<T>::pack_rows(const T *rows, size_t n, size_t pitch, size_t cols, T *buf) {
+    for (size_t r=0; r < n; r++) {
+      copy(rows + r * pitch, rows + r * pitch + cols, buf);
+      buf += cols;
+    }
+    return buf;
+  }
 
+
+  template <class T>
+  T *basic_par_wt<T>::pack_cols(const T *cols, size_t n, size_t pitch, size_t rows, T *buf) {
+    for (size_t c=0; c < n; c++) {
+      for (size_t r=0; r < rows; r++) {
+        buf[r] = cols[r * pitch + c];
+      }
+      buf += rows;
+    }
+    return buf;
+  }
+
+
+  template class basic_par_wt<double>;
+  template class basic_par_wt<float>;
+
+} // namespace
@@ -51,13 +51,25 @@
 /// 
 namespace nami { 
 
-  class par_wt : private wt_1d_direct {
+  /// T is the type of the values transformed, double or float.  Data is sent
+  /// between processes in that type, so the float transform moves half the bytes.
+  template <class T>
+  class basic_par_wt : private basic_wt_1d_direct<T> {
   public:
+    /// Type of matrix this class transforms.
+    typedef boost::numeric::ublas::matrix<T> matrix_type;
+
+    /// Padded matrix type this class also transforms.
+    typedef basic_padded_matrix<T> padded_type;
+
+    /// View type the transforms take.  matrix_type and padded_type convert to it.
+    typedef basic_matrix_view<T> view_type;
+
     /// Constructor -- just delegates to wt_direct.
-    par_wt(filter_bank& f = filter::getCDF97());
+    basic_par_wt(filter_bank& f = filter::getCDF97());
 
     /// Destructor
-    virtual ~par_wt();
+    virtual ~basic_par_wt();
 
     /// Forward transform for matrix.  
     /// This is a collective operation -- all processes in the communicator
@@ -71,18 +83,32 @@ namespace nami {
     ///        ranks in the communicator provided.  If your data is not laid out
     ///        this way, consider using aggregate(), above, with MPI_Comm_split().
     ///
-    /// @param mat     a nami_matrix containing the data to be transformed
+    /// If comm is a 2d Cartesian communicator (see MPI_Cart_create()), mat is instead
+    /// the block at this process's coordinates in the grid: rows are split over the 
+    /// first dimension and columns over the second.  Halos are exchanged in both 
+    /// directions, so square-ish blocks go as deep as tall slabs would with far less 
+    /// data exchanged per process.  Then mat.size2() must also be divisible by 2 
+    /// level times.
+    ///
+    /// Communication is planned on a duplicate of comm that this object keeps until
+    /// it is called with a communicator of other ranks or another grid, or destroyed.
+    /// So comm may be freed right after the call, but those calls and the destructor
+    /// are collective over the planned communicator, as MPI_Comm_free() is.
+    ///
+    /// @param mat     a matrix containing the data to be transformed.  Halo rows are 
+    ///                sent and received with its pitch, so padded matrices and views
+    ///                of application buffers work as well as ublas matrices.
     /// @param level   number of level iterations to perform
     ///                level is the maximum level of the tranform to be conducted.
     ///                must be <= log2(min(mat.size1(), mat.size2())
     ///
-    /// @return the level of the transform performed.  This may be less than
-    ///         the level provided, depending on the data's layout 
-    int fwt_2d(nami_matrix& mat, int level = -1, MPI_Comm comm = MPI_COMM_WORLD);
-
+    /// @return the level of the transform performed.  By default this is as deep
+    ///         as the local block allows without more than nearest-neighbor 
+    ///         communication, in each dimension split over processes.
+    int fwt_2d(view_type mat, int level = -1, MPI_Comm comm = MPI_COMM_WORLD);
 
     
-    int iwt_2d(nami_matrix& mat, int level = -1, MPI_Comm comm = MPI_COMM_WORLD);
+    int iwt_2d(view_type mat, int level = -1, MPI_Comm comm = MPI_COMM_WORLD);
 
 
     /// Use this function to gather distributed data onto fewer processors.
@@ -93,7 +119,7 @@ namespace nami {
     ///       system size is power of two
     /// @post Data in local is aggregated into mat on all processors where 
     ///       (size % m == set)
-    static void aggregate(nami_matrix& mat, std::vector<double>& local, 
+    static void aggregate(matrix_type& mat, std::vector<T>& local, 
 			  int m, int set, 
 			  std::vector<MPI_Request>& reqs, 
 			  MPI_Comm comm = MPI_COMM_WORLD);
@@ -106,19 +132,22 @@ namespace nami {
     ///        system size is power of two
     /// @post  Rows of matrix are distributed to all processors where
     ///        (size % m == set)
-    static void distribute(nami_matrix& mat, std::vector<double>& local, 
+    static void distribute(matrix_type& mat, std::vector<T>& local, 
 			  int m, int set, 
 			  std::vector<MPI_Request>& reqs, 
 			  MPI_Comm comm = MPI_COMM_WORLD);
     
 
     /// Gathers all pieces of a distributed matrix together into a local matrix.
-    static void gather(nami_matrix& dest, nami_matrix& mat, 
+    /// Blocks from a 2d Cartesian communicator are placed by their grid coordinates.
+    static void gather(matrix_type& dest, matrix_type& mat, 
 		       MPI_Comm comm, int root = 0);
 
 
-    /// Scatters per-process chunks of a matrix out to all members of comm.
-    static void scatter(nami_matrix& dest, nami_matrix& mat, 
+    /// Inverse of gather(): splits mat, which is only read on root, into equal blocks 
+    /// in dest on all members of comm.  Blocks for a 2d Cartesian communicator are 
+    /// taken by their grid coordinates.
+    static void scatter(matrix_type& dest, matrix_type& mat, 
 		       MPI_Comm comm, int root = 0);
 
 
@@ -126,43 +155,193 @@ namespace nami {
     /// This just rearranges the rows so that they're in the order we're used to.
     /// This algorithm is O(M*N) for an M row by N column matrix.
     /// @post  mat's elements have been rearranged to the standard wavelet transform order.
-    static void reassemble(nami_matrix& mat, int P, int level);
+    static void reassemble(matrix_type& mat, int P, int level);
+
+    /// Reassembles a matrix transformed with fwt_2d() on a P x Q process grid, 
+    /// after gather().
+    static void reassemble(matrix_type& mat, int P, int Q, int level);
+
+    /// Gets dims and this process's coords if comm is a 2d Cartesian communicator.
+    /// @return false if it isn't.
+    static bool grid_dims(MPI_Comm comm, int dims[2], int coords[2]);
 
 
   protected:
-    /// Wrapper around wt_1d_direct method that knows about matrix.
-    void fwt_row(nami_matrix& mat, size_t row, size_t n) {
-      fwt_1d_single(&mat(row, 0), n);
+    using basic_wt_1d_direct<T>::f_;
+    using basic_wt_1d_direct<T>::even_taps_;
+    using basic_wt_1d_direct<T>::odd_taps_;
+
+    /// Wrapper around wt_1d_direct method for one matrix row.
+    void fwt_row(T *row, size_t n) {
+      this->fwt_1d_single(row, n);
     }
 
-    /// Wrapper around wt_1d_direct method that knows about matrix.
-    void iwt_row(nami_matrix& mat, size_t row, size_t n) {
-      iwt_1d_single(&mat(row, 0), n);
+    /// Wrapper around wt_1d_direct method for one matrix row.
+    void iwt_row(T *row, size_t n) {
+      this->iwt_1d_single(row, n);
     }
 
     ///
-    /// Parallel column transform.  
+    /// Parallel column transform of the column at col, whose values are <pitch>
+    /// apart.  Computes the pairs of output values in [first, last): the low and
+    /// high values at first for the forward transform, and values 2*first and 
+    /// 2*first+1 for the inverse.
     /// @pre temp data has been filled in by fwt_2d().
     ///
-    void fwt_col(nami_matrix& mat, size_t col, size_t n);
+    void fwt_col(T *col, size_t pitch, size_t n, size_t first, size_t last);
 
     ///
-    /// Parallel column transform.  
+    /// Parallel column transform.  Computes pairs of output values as fwt_col() 
+    /// does; the column's length is implied by temp.
     /// @pre temp data has been filled in by iwt_2d().
     ///
-    void iwt_col(nami_matrix& mat, size_t col, size_t n);
+    void iwt_col(T *col, size_t pitch, size_t first, size_t last);
+
+    /// Column convolutions for a kernel type K.
+    template <class K> 
+    void fwt_col(const K& fir, T *col, size_t pitch, size_t n, size_t first, size_t last);
+    template <class K> 
+    void iwt_col(const K& fir, T *col, size_t pitch, size_t first, size_t last);
     
   private:
+    /// Column of local and remote data being transformed; see build_temp().
+    std::vector<T> temp_;
+
+    /// Rearranges the rows of a matrix gathered from P processes, whose columns are 
+    /// in blocks of <block> columns each transformed in the same order; see reassemble().
+    static void reassemble_rows(matrix_type& mat, int P, int level, size_t block);
+
+    /// Values at the ends of each line, kept for the boundary phase of
+    /// transform_lines().
+    std::vector<T> edges_;
+
+    /// Copies of the border rows being sent to neighbors; see start_exchange().
+    std::vector<T> send_buf_;
+
     ///
-    /// Copies one column of local and remote data into temporary array: left 
-    /// first, then local, then right.  If this process has no left or right neighbor
-    /// then the local data is extended symmetrically to the appropriate side(s).
+    /// Copies one line (column, or row split over the grid) of local and remote data
+    /// into temporary array: left first, then local, then right.  If this process has
+    /// no left or right neighbor then the local data is extended symmetrically to the 
+    /// appropriate side(s).  Remote values of the line are in column <line> of the halos.
     /// 
-    void build_temp(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-		    size_t rows, size_t col, int rank, int comm_size, bool interleave = false);
+    void build_temp(matrix_type& left, const T *local, size_t step, matrix_type& right, 
+		    size_t n, size_t line, bool has_left, bool has_right, bool interleave = false);
+
+    /// Copies the n local values of a line, <step> apart, into the middle of temp; see
+    /// build_temp().
+    void fill_temp(const T *local, size_t step, size_t n, bool interleave);
+
+    /// Fills in the remote or extended values around the local ones in temp; see
+    /// build_temp().
+    void fill_halo(matrix_type& left, matrix_type& right, size_t n, size_t line, 
+                   bool has_left, bool has_right);
+
+    ///
+    /// Transforms of a level along <lines> lines of n values, once start_exchange() has
+    /// started the requests in reqs.  Lines are columns, or rows if across.  Output 
+    /// values that need only local data are computed while the requests are in flight;
+    /// the rest are computed once they complete.
+    ///
+    void transform_lines(T *local, size_t pitch, size_t n, size_t lines, bool across,
+                         std::vector<MPI_Request>& reqs, bool inverse);
+
+    /// Copies n rows of cols values, <pitch> apart, to buf one after another.  
+    /// Returns the end of the copied rows in buf.
+    static T *pack_rows(const T *rows, size_t n, size_t pitch, size_t cols, T *buf);
+
+    /// Copies the first <rows> values of n columns to buf one column after another, 
+    /// so they're received like rows.  Returns the end of the copied columns in buf.
+    static T *pack_cols(const T *cols, size_t n, size_t pitch, size_t rows, T *buf);
 
+    /// Halo exchange for one level of a transform: persistent requests that send
+    /// blocks of border lines, packed in send_buf_, and receive neighbors' lines into 
+    /// the halos.  Lines are rows exchanged with north and south neighbors, or 
+    /// columns exchanged with west and east ones if across.
+    struct exchange {
+      bool across;                      ///< Whether lines are columns
+      size_t width;                     ///< Values of each line exchanged
+      std::vector<MPI_Request> reqs;    ///< Persistent sends and receives
+      std::vector<size_t> first;        ///< First local line of each block sent
+      std::vector<size_t> count;        ///< Lines in each block sent
+
+      exchange(bool a, size_t w) : across(a), width(w) { }
+    };
+
+    // Communication is planned once for a shape and communicator, and reused by
+    // every transform of that shape; see plan().
+    size_t plan_rows_;                  ///< Local rows of the planned shape
+    size_t plan_cols_;                  ///< Cols of the planned shape
+    size_t plan_pitch_;                 ///< Pitch of the planned shape
+    MPI_Comm plan_comm_;                ///< Duplicate of the planned communicator, owned
+    int grid_rows_;                     ///< Processes over which rows are split
+    int grid_cols_;                     ///< Processes over which columns are split
+    int north_;                         ///< Neighbor with the rows above, or MPI_PROC_NULL
+    int south_;                         ///< Neighbor with the rows below, or MPI_PROC_NULL
+    int west_;                          ///< Neighbor with the columns left, or MPI_PROC_NULL
+    int east_;                          ///< Neighbor with the columns right, or MPI_PROC_NULL
+    std::vector<exchange> fwt_plan_;    ///< Column exchange for each level of fwt_2d()
+    std::vector<exchange> iwt_plan_;    ///< Column exchange for each level of iwt_2d()
+    std::vector<exchange> fwt_row_plan_; ///< Row exchange for each level of fwt_2d()
+    std::vector<exchange> iwt_row_plan_; ///< Row exchange for each level of iwt_2d()
+    std::vector<MPI_Datatype> types_;   ///< Committed receive types of all levels
+    matrix_type north_rows_;            ///< Rows received from north neighbor
+    matrix_type south_rows_;            ///< Rows received from south neighbor
+    matrix_type west_cols_;             ///< Columns received from west neighbor, as rows
+    matrix_type east_cols_;             ///< Columns received from east neighbor, as rows
+
+    /// Not copyable; the plan's requests are bound to this object's buffers.
+    basic_par_wt(const basic_par_wt&);
+    basic_par_wt& operator=(const basic_par_wt&);
+
+    ///
+    /// Finds this process's neighbors and sets up the buffers for halo exchanges of 
+    /// transforms of a matrix with rows x cols local values, <pitch> apart, on comm.
+    /// Does nothing if this shape and communicator are already planned, so repeated 
+    /// transforms of one shape pay for it once.  A new communicator is duplicated, 
+    /// which is collective; a new shape alone is planned locally.
     ///
-    /// This routine handles data exchange between neighbors in the parallel wavelet transform.
+    void plan(size_t rows, size_t cols, size_t pitch, MPI_Comm comm);
+
+    /// Sets up the datatypes and persistent requests for any of the first <levels> 
+    /// levels of the planned shape that aren't set up yet.
+    void plan_levels(int levels);
+
+    /// True if the plan's communicator has the same ranks and grid as comm.
+    bool planned_for(MPI_Comm comm);
+
+    /// Frees the plan's requests, datatypes and communicator.  Collective over 
+    /// the communicator, like MPI_Comm_free().
+    void free_plan();
+
+    /// Frees the requests and datatypes of all planned levels.
+    void free_levels();
+
+    /// Frees the persistent requests of ex.
+    static void free_requests(exchange& ex);
+
+    /// Default transform level for a local block of rows x cols; see fwt_2d().
+    int default_level(size_t rows, size_t cols);
+
+    /// Makes a committed datatype for receiving <rows> rows of cols values, <stride> 
+    /// apart, that is freed with the plan.
+    MPI_Datatype recv_type(size_t rows, size_t cols, size_t stride);
+
+    /// Tags of halo messages.  MPI_Startall() starts an exchange's requests in no
+    /// particular order, so each block sent toward the lower or higher neighbor gets
+    /// its own tag: the direction's base plus the block's place among those sent.
+    enum { to_lo_tag = 0, to_hi_tag = 2 };
+
+    /// Adds a persistent send of <count> local lines starting at first to ex.
+    void send_lines(exchange& ex, size_t first, size_t count, int dest, int tag);
+
+    /// Adds a persistent receive of one <type> into dest to ex.
+    void recv_lines(exchange& ex, T *dest, MPI_Datatype type, int source, int tag);
+
+    /// Packs the lines that ex sends from local, and starts its requests.
+    void start_exchange(exchange& ex, const T *local, size_t pitch);
+
+    ///
+    /// This routine plans data exchange between neighbors in the parallel wavelet transform.
     /// Matrices in the parallel transform are distributed by rows, and this fetches all remote
     /// rows necessary for the local column transform.
     ///
@@ -170,30 +349,27 @@ namespace nami {
     /// we receive D/2+1 rows from the right and D/2 rows from the left.  Rows are not transferred
     /// in their entirety; only data from those columns that are necessary for the transform.
     /// 
-    /// This procedure issues requests for these sends/recvs, but does not wait for them to
-    /// complete.  Instead, this adds requests to the supplied vector, which the caller can wait
-    /// on later.
-    ///
-    /// @param left   destination matrix for columns from caller's left.
-    /// @param local  handle to local data, low and high rows of which ard sent left and right.
-    /// @param right  destination matrix for columns from caller's right.
-    /// @param rows   number of rows in local data still being transformed.
-    /// @param cols   number of cols in local data still being transformed.
-    /// @param reqs   All requests issued here are appended to this vector.
-    /// @param comm   Communicator on which transform is being performed.
+    /// Requests for these sends/recvs are added to ex, and started for each transform by
+    /// start_exchange().  Rows sent are packed into send_buf_ first, so the local data may
+    /// change while they are in flight.
+    ///
+    /// Across the grid, columns are exchanged with west and east neighbors the same way.
+    ///
+    /// @param ex     exchange to add requests to; its width is the number of values
+    ///               still being transformed in each line.
+    /// @param n      number of lines in local data still being transformed.
     /// 
-    void fwt_exchange(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-		      size_t rows, size_t cols, std::vector<MPI_Request>& reqs, 
-		      MPI_Comm comm);
+    void fwt_exchange(exchange& ex, size_t n);
 
     ///
-    /// This routine handles data exchange for the inverse wavelet transform.  Parameters
+    /// This routine plans data exchange for the inverse wavelet transform.  Parameters
     /// are as for fwt_exchange, but data laout is slightly different.
     ///
-    void iwt_exchange(nami_matrix& left, nami_matrix& local, nami_matrix& right, 
-		      size_t rows, size_t cols, std::vector<MPI_Request>& reqs, 
-		      MPI_Comm comm);
+    void iwt_exchange(exchange& ex, size_t n);
   };
+
+  typedef basic_par_wt<double> par_wt;
+  typedef basic_par_wt<float>  par_wt_f;
   
 } // namespace 
 
@@ -0,0 +1,548 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "simd_lift.h"
+
+// Vector kernels are compiled with per-function target attributes, so the rest
+// of the library does not need to be built for any particular instruction set.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NAMI_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace nami { namespace simd {
+
+  // --- Portable kernels.  These also handle leftovers for the vector kernels. --- //
+
+  template <class T>
+  static void split_scalar(T *even, T *odd, const T *src, size_t n) {
+    const size_t h = n >> 1;
+    for (size_t i=0; i < h; i++) {
+      even[i] = src[2*i];
+      odd[i]  = src[2*i+1];
+    }
+  }
+
+  template <class T>
+  static void merge_scalar(T *dest, const T *even, const T *odd, size_t n) {
+    const size_t h = n >> 1;
+    for (size_t i=0; i < h; i++) {
+      dest[2*i]   = even[i];
+      dest[2*i+1] = odd[i];
+    }
+  }
+
+  template <class T>
+  static void lift_scalar(T *dest, const T *x, const T *y, T a, size_t n) {
+    for (size_t i=0; i < n; i++) {
+      dest[i] += a * (x[i] + y[i]);
+    }
+  }
+
+  template <class T>
+  static void scale_scalar(T *dest, const T *src, T a, size_t n) {
+    for (size_t i=0; i < n; i++) {
+      dest[i] = a * src[i];
+    }
+  }
+
+  static const lift_kernels<double> scalar_kernels = {
+    SCALAR, split_scalar<double>, merge_scalar<double>, lift_scalar<double>, scale_scalar<double>
+  };
+
+  static const lift_kernels<float> scalar_kernels_f = {
+    SCALAR, split_scalar<float>, merge_scalar<float>, lift_scalar<float>, scale_scalar<float>
+  };
+
+
+#ifdef NAMI_SIMD_X86
+  // --- SSE2: 2 doubles per vector --- //
+
+  __attribute__((target("sse2")))
+  static void split_sse2(double *even, double *odd, const double *src, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+2 <= h; i += 2) {
+      __m128d a = _mm_loadu_pd(src + 2*i);
+      __m128d b = _mm_loadu_pd(src + 2*i + 2);
+      _mm_storeu_pd(even + i, _mm_unpacklo_pd(a, b));
+      _mm_storeu_pd(odd + i,  _mm_unpackhi_pd(a, b));
+    }
+    for (; i < h; i++) {
+      even[i] = src[2*i];
+      odd[i]  = src[2*i+1];
+    }
+  }
+
+  __attribute__((target("sse2")))
+  static void merge_sse2(double *dest, const double *even, const double *odd, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+2 <= h; i += 2) {
+      __m128d s = _mm_loadu_pd(even + i);
+      __m128d d = _mm_loadu_pd(odd + i);
+      _mm_storeu_pd(dest + 2*i,     _mm_unpacklo_pd(s, d));
+      _mm_storeu_pd(dest + 2*i + 2, _mm_unpackhi_pd(s, d));
+    }
+    for (; i < h; i++) {
+      dest[2*i]   = even[i];
+      dest[2*i+1] = odd[i];
+    }
+  }
+
+  __attribute__((target("sse2")))
+  static void lift_sse2(double *dest, const double *x, const double *y, double a, size_t n) {
+    const __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i+2 <= n; i += 2) {
+      __m128d sum = _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i));
+      _mm_storeu_pd(dest + i, _mm_add_pd(_mm_loadu_pd(dest + i), _mm_mul_pd(va, sum)));
+    }
+    lift_scalar(dest + i, x + i, y + i, a, n - i);
+  }
+
+  __attribute__((target("sse2")))
+  static void scale_sse2(double *dest, const double *src, double a, size_t n) {
+    const __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i+2 <= n; i += 2) {
+      _mm_storeu_pd(dest + i, _mm_mul_pd(va, _mm_loadu_pd(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<double> sse2_kernels = {
+    SSE2, split_sse2, merge_sse2, lift_sse2, scale_sse2
+  };
+
+
+  // --- SSE2: 4 floats per vector --- //
+
+  __attribute__((target("sse2")))
+  static void split_sse2(float *even, float *odd, const float *src, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+4 <= h; i += 4) {
+      __m128 a = _mm_loadu_ps(src + 2*i);
+      __m128 b = _mm_loadu_ps(src + 2*i + 4);
+      _mm_storeu_ps(even + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(odd + i,  _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    split_scalar(even + i, odd + i, src + 2*i, n - 2*i);
+  }
+
+  __attribute__((target("sse2")))
+  static void merge_sse2(float *dest, const float *even, const float *odd, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+4 <= h; i += 4) {
+      __m128 s = _mm_loadu_ps(even + i);
+      __m128 d = _mm_loadu_ps(odd + i);
+      _mm_storeu_ps(dest + 2*i,     _mm_unpacklo_ps(s, d));
+      _mm_storeu_ps(dest + 2*i + 4, _mm_unpackhi_ps(s, d));
+    }
+    merge_scalar(dest + 2*i, even + i, odd + i, n - 2*i);
+  }
+
+  __attribute__((target("sse2")))
+  static void lift_sse2(float *dest, const float *x, const float *y, float a, size_t n) {
+    const __m128 va = _mm_set1_ps(a);
+    size_t i = 0;
+    for (; i+4 <= n; i += 4) {
+      __m128 sum = _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i));
+      _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(va, sum)));
+    }
+    lift_scalar(dest + i, x + i, y + i, a, n - i);
+  }
+
+  __attribute__((target("sse2")))
+  static void scale_sse2(float *dest, const float *src, float a, size_t n) {
+    const __m128 va = _mm_set1_ps(a);
+    size_t i = 0;
+    for (; i+4 <= n; i += 4) {
+      _mm_storeu_ps(dest + i, _mm_mul_ps(va, _mm_loadu_ps(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<float> sse2_kernels_f = {
+    SSE2, split_sse2, merge_sse2, lift_sse2, scale_sse2
+  };
+
+
+  // --- AVX2 + FMA: 4 doubles per vector --- //
+
+  __attribute__((target("avx2")))
+  static void split_avx2(double *even, double *odd, const double *src, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+4 <= h; i += 4) {
+      __m256d a = _mm256_loadu_pd(src + 2*i);       // x0 x1 x2 x3
+      __m256d b = _mm256_loadu_pd(src + 2*i + 4);   // x4 x5 x6 x7
+      __m256d lo = _mm256_unpacklo_pd(a, b);        // x0 x4 x2 x6
+      __m256d hi = _mm256_unpackhi_pd(a, b);        // x1 x5 x3 x7
+      _mm256_storeu_pd(even + i, _mm256_permute4x64_pd(lo, 0xD8));
+      _mm256_storeu_pd(odd + i,  _mm256_permute4x64_pd(hi, 0xD8));
+    }
+    for (; i < h; i++) {
+      even[i] = src[2*i];
+      odd[i]  = src[2*i+1];
+    }
+  }
+
+  __attribute__((target("avx2")))
+  static void merge_avx2(double *dest, const double *even, const double *odd, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+4 <= h; i += 4) {
+      __m256d s = _mm256_permute4x64_pd(_mm256_loadu_pd(even + i), 0xD8);  // s0 s2 s1 s3
+      __m256d d = _mm256_permute4x64_pd(_mm256_loadu_pd(odd + i),  0xD8);  // d0 d2 d1 d3
+      _mm256_storeu_pd(dest + 2*i,     _mm256_unpacklo_pd(s, d));
+      _mm256_storeu_pd(dest + 2*i + 4, _mm256_unpackhi_pd(s, d));
+    }
+    for (; i < h; i++) {
+      dest[2*i]   = even[i];
+      dest[2*i+1] = odd[i];
+    }
+  }
+
+  __attribute__((target("avx2,fma")))
+  static void lift_avx2(double *dest, const double *x, const double *y, double a, size_t n) {
+    const __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i+4 <= n; i += 4) {
+      __m256d sum = _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i));
+      _mm256_storeu_pd(dest + i, _mm256_fmadd_pd(va, sum, _mm256_loadu_pd(dest + i)));
+    }
+    for (; i < n; i++) {     // fused here too, so results don't depend on position
+      __m128d sum = _mm_set_sd(x[i] + y[i]);
+      dest[i] = _mm_cvtsd_f64(_mm_fmadd_sd(_mm_set_sd(a), sum, _mm_set_sd(dest[i])));
+    }
+  }
+
+  __attribute__((target("avx2")))
+  static void scale_avx2(double *dest, const double *src, double a, size_t n) {
+    const __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i+4 <= n; i += 4) {
+      _mm256_storeu_pd(dest + i, _mm256_mul_pd(va, _mm256_loadu_pd(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<double> avx2_kernels = {
+    AVX2, split_avx2, merge_avx2, lift_avx2, scale_avx2
+  };
+
+
+  // --- AVX2 + FMA: 8 floats per vector --- //
+
+  __attribute__((target("avx2")))
+  static void split_avx2(float *even, float *odd, const float *src, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+8 <= h; i += 8) {
+      __m256 a = _mm256_loadu_ps(src + 2*i);
+      __m256 b = _mm256_loadu_ps(src + 2*i + 8);
+      // per 128-bit lane: a0 a2 b0 b2 | a4 a6 b4 b6, then put the a pairs first
+      __m256 lo = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m256 hi = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      _mm256_storeu_ps(even + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(lo), 0xD8)));
+      _mm256_storeu_ps(odd + i,  _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(hi), 0xD8)));
+    }
+    split_scalar(even + i, odd + i, src + 2*i, n - 2*i);
+  }
+
+  __attribute__((target("avx2")))
+  static void merge_avx2(float *dest, const float *even, const float *odd, size_t n) {
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+8 <= h; i += 8) {
+      __m256 s = _mm256_loadu_ps(even + i);
+      __m256 d = _mm256_loadu_ps(odd + i);
+      __m256 lo = _mm256_unpacklo_ps(s, d);   // s0 d0 s1 d1 | s4 d4 s5 d5
+      __m256 hi = _mm256_unpackhi_ps(s, d);   // s2 d2 s3 d3 | s6 d6 s7 d7
+      _mm256_storeu_ps(dest + 2*i,     _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(dest + 2*i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    merge_scalar(dest + 2*i, even + i, odd + i, n - 2*i);
+  }
+
+  __attribute__((target("avx2,fma")))
+  static void lift_avx2(float *dest, const float *x, const float *y, float a, size_t n) {
+    const __m256 va = _mm256_set1_ps(a);
+    size_t i = 0;
+    for (; i+8 <= n; i += 8) {
+      __m256 sum = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+      _mm256_storeu_ps(dest + i, _mm256_fmadd_ps(va, sum, _mm256_loadu_ps(dest + i)));
+    }
+    for (; i < n; i++) {
+      __m128 sum = _mm_set_ss(x[i] + y[i]);
+      dest[i] = _mm_cvtss_f32(_mm_fmadd_ss(_mm_set_ss(a), sum, _mm_set_ss(dest[i])));
+    }
+  }
+
+  __attribute__((target("avx2")))
+  static void scale_avx2(float *dest, const float *src, float a, size_t n) {
+    const __m256 va = _mm256_set1_ps(a);
+    size_t i = 0;
+    for (; i+8 <= n; i += 8) {
+      _mm256_storeu_ps(dest + i, _mm256_mul_ps(va, _mm256_loadu_ps(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<float> avx2_kernels_f = {
+    AVX2, split_avx2, merge_avx2, lift_avx2, scale_avx2
+  };
+
+
+  // --- AVX-512F: 8 doubles per vector --- //
+
+  __attribute__((target("avx512f")))
+  static void split_avx512(double *even, double *odd, const double *src, size_t n) {
+    const __m512i even_idx = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+    const __m512i odd_idx  = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+8 <= h; i += 8) {
+      __m512d a = _mm512_loadu_pd(src + 2*i);
+      __m512d b = _mm512_loadu_pd(src + 2*i + 8);
+      _mm512_storeu_pd(even + i, _mm512_permutex2var_pd(a, even_idx, b));
+      _mm512_storeu_pd(odd + i,  _mm512_permutex2var_pd(a, odd_idx,  b));
+    }
+    for (; i < h; i++) {
+      even[i] = src[2*i];
+      odd[i]  = src[2*i+1];
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  static void merge_avx512(double *dest, const double *even, const double *odd, size_t n) {
+    const __m512i lo_idx = _mm512_set_epi64(11, 3, 10, 2,  9, 1,  8, 0);
+    const __m512i hi_idx = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+8 <= h; i += 8) {
+      __m512d s = _mm512_loadu_pd(even + i);
+      __m512d d = _mm512_loadu_pd(odd + i);
+      _mm512_storeu_pd(dest + 2*i,     _mm512_permutex2var_pd(s, lo_idx, d));
+      _mm512_storeu_pd(dest + 2*i + 8, _mm512_permutex2var_pd(s, hi_idx, d));
+    }
+    for (; i < h; i++) {
+      dest[2*i]   = even[i];
+      dest[2*i+1] = odd[i];
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  static void lift_avx512(double *dest, const double *x, const double *y, double a, size_t n) {
+    const __m512d va = _mm512_set1_pd(a);
+    size_t i = 0;
+    for (; i+8 <= n; i += 8) {
+      __m512d sum = _mm512_add_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i));
+      _mm512_storeu_pd(dest + i, _mm512_fmadd_pd(va, sum, _mm512_loadu_pd(dest + i)));
+    }
+    if (i < n) {             // masked, so results don't depend on position
+      const __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+      __m512d sum = _mm512_add_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i));
+      _mm512_mask_storeu_pd(dest + i, m, _mm512_fmadd_pd(va, sum, _mm512_maskz_loadu_pd(m, dest + i)));
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  static void scale_avx512(double *dest, const double *src, double a, size_t n) {
+    const __m512d va = _mm512_set1_pd(a);
+    size_t i = 0;
+    for (; i+8 <= n; i += 8) {
+      _mm512_storeu_pd(dest + i, _mm512_mul_pd(va, _mm512_loadu_pd(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<double> avx512_kernels = {
+    AVX512, split_avx512, merge_avx512, lift_avx512, scale_avx512
+  };
+
+
+  // --- AVX-512F: 16 floats per vector --- //
+
+  __attribute__((target("avx512f")))
+  static void split_avx512(float *even, float *odd, const float *src, size_t n) {
+    const __m512i even_idx = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 
+                                              14, 12, 10,  8,  6,  4,  2,  0);
+    const __m512i odd_idx  = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 
+                                              15, 13, 11,  9,  7,  5,  3,  1);
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+16 <= h; i += 16) {
+      __m512 a = _mm512_loadu_ps(src + 2*i);
+      __m512 b = _mm512_loadu_ps(src + 2*i + 16);
+      _mm512_storeu_ps(even + i, _mm512_permutex2var_ps(a, even_idx, b));
+      _mm512_storeu_ps(odd + i,  _mm512_permutex2var_ps(a, odd_idx,  b));
+    }
+    split_scalar(even + i, odd + i, src + 2*i, n - 2*i);
+  }
+
+  __attribute__((target("avx512f")))
+  static void merge_avx512(float *dest, const float *even, const float *odd, size_t n) {
+    const __m512i lo_idx = _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 
+                                            19, 3, 18, 2, 17, 1, 16, 0);
+    const __m512i hi_idx = _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 
+                                            27, 11, 26, 10, 25,  9, 24,  8);
+    const size_t h = n >> 1;
+    size_t i = 0;
+    for (; i+16 <= h; i += 16) {
+      __m512 s = _mm512_loadu_ps(even + i);
+      __m512 d = _mm512_loadu_ps(odd + i);
+      _mm512_storeu_ps(dest + 2*i,      _mm512_permutex2var_ps(s, lo_idx, d));
+      _mm512_storeu_ps(dest + 2*i + 16, _mm512_permutex2var_ps(s, hi_idx, d));
+    }
+    merge_scalar(dest + 2*i, even + i, odd + i, n - 2*i);
+  }
+
+  __attribute__((target("avx512f")))
+  static void lift_avx512(float *dest, const float *x, const float *y, float a, size_t n) {
+    const __m512 va = _mm512_set1_ps(a);
+    size_t i = 0;
+    for (; i+16 <= n; i += 16) {
+      __m512 sum = _mm512_add_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+      _mm512_storeu_ps(dest + i, _mm512_fmadd_ps(va, sum, _mm512_loadu_ps(dest + i)));
+    }
+    if (i < n) {
+      const __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+      __m512 sum = _mm512_add_ps(_mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i));
+      _mm512_mask_storeu_ps(dest + i, m, _mm512_fmadd_ps(va, sum, _mm512_maskz_loadu_ps(m, dest + i)));
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  static void scale_avx512(float *dest, const float *src, float a, size_t n) {
+    const __m512 va = _mm512_set1_ps(a);
+    size_t i = 0;
+    for (; i+16 <= n; i += 16) {
+      _mm512_storeu_ps(dest + i, _mm512_mul_ps(va, _mm512_loadu_ps(src + i)));
+    }
+    scale_scalar(dest + i, src + i, a, n - i);
+  }
+
+  static const lift_kernels<float> avx512_kernels_f = {
+    AVX512, split_avx512, merge_avx512, lift_avx512, scale_avx512
+  };
+#endif // NAMI_SIMD_X86
+
+
+  const char *isa_to_str(isa_t isa) {
+    switch (isa) {
+    case SCALAR: return "scalar";
+    case SSE2:   return "sse2";
+    case AVX2:   return "avx2";
+    case AVX512: return "avx512";
+    default:     return "unknown";
+    }
+  }
+
+
+  isa_t detect_isa() {
+#ifdef NAMI_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return AVX2;
+    if (__builtin_cpu_supports("sse2")) return SSE2;
+#endif // NAMI_SIMD_X86
+    return SCALAR;
+  }
+
+
+  // never hand out kernels that this CPU can't run.
+  static isa_t supported(isa_t isa) {
+    isa_t best = detect_isa();
+    return (isa > best) ? best : isa;
+  }
+
+  template <>
+  const lift_kernels<double>& get_lift_kernels<double>(isa_t isa) {
+    switch (supported(isa)) {
+#ifdef NAMI_SIMD_X86
+    case AVX512: return avx512_kernels;
+    case AVX2:   return avx2_kernels;
+    case SSE2:   return sse2_kernels;
+#endif // NAMI_SIMD_X86
+    default:     return scalar_kernels;
+    }
+  }
+
+  template <>
+  const lift_kernels<float>& get_lift_kernels<float>(isa_t isa) {
+    switch (supported(isa)) {
+#ifdef NAMI_SIMD_X86
+    case AVX512: return avx512_kernels_f;
+    case AVX2:   return avx2_kernels_f;
+    case SSE2:   return sse2_kernels_f;
+#endif // NAMI_SIMD_X86
+    default:     return scalar_kernels_f;
+    }
+  }
+
+
+  // Picks the instruction set to use when the caller doesn't ask for one.
+  static isa_t choose_isa() {
+    isa_t isa = detect_isa();
+
+    const char *env = getenv("NAMI_SIMD");
+    if (env) {
+      for (int i = SCALAR; i <= AVX512; i++) {
+        if (strcasecmp(env, isa_to_str((isa_t)i)) == 0) {
+          isa = (isa_t)i;
+        }
+      }
+    }
+    return isa;
+  }
+
+
+  // static data is function-static here to avoid library initialization issues.
+  template <>
+  const lift_kernels<double>& get_lift_kernels<double>() {
+    static const lift_kernels<double>& kernels = get_lift_kernels<double>(choose_isa());
+    return kernels;
+  }
+
+  template <>
+  const lift_kernels<float>& get_lift_kernels<float>() {
+    static const lift_kernels<float>& kernels = get_lift_kernels<float>(choose_isa());
+    return kernels;
+  }
+
+}} // namespaces
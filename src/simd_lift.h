@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef NAMI_SIMD_LIFT_H
+#define NAMI_SIMD_LIFT_H
+
+#include <cstdlib>
+
+/// \file simd_lift.h
+/// This file provides vectorized kernels for the steps of the lifting wavelet
+/// transforms.  Kernels work on data that has already been split into its even
+/// and odd samples, so that every step of the lifting scheme is a unit-stride
+/// loop.  The best kernel set for the host CPU is chosen at runtime.
+namespace nami { namespace simd {
+
+  /// Instruction sets that kernels are available for.
+  typedef enum { SCALAR, SSE2, AVX2, AVX512 } isa_t;
+
+  /// Helpful for output and for the NAMI_SIMD environment variable.
+  const char *isa_to_str(isa_t isa);
+
+  /// Set of kernels for one instruction set, on values of type T (double or float).
+  template <class T>
+  struct lift_kernels {
+    isa_t isa;   ///< Instruction set these kernels were compiled for.
+
+    /// Splits n interleaved values in src into n/2 even values and n/2 odd values.
+    /// n must be even.
+    void (*split)(T *even, T *odd, const T *src, size_t n);
+
+    /// Inverse of split: interleaves n/2 even and n/2 odd values into dest.
+    void (*merge)(T *dest, const T *even, const T *odd, size_t n);
+
+    /// Lifting step:  dest[i] += a * (x[i] + y[i])  for i in [0, n).  Each value is 
+    /// computed the same way wherever it falls in [0, n), so splitting a call into 
+    /// pieces does not change results.
+    void (*lift)(T *dest, const T *x, const T *y, T a, size_t n);
+
+    /// Scaled copy:  dest[i] = a * src[i]  for i in [0, n).  dest may equal src.
+    void (*scale)(T *dest, const T *src, T a, size_t n);
+  };
+
+  /// Returns the most capable instruction set supported by this CPU.
+  isa_t detect_isa();
+
+  /// Returns kernels for the requested instruction set, or for the best 
+  /// supported one if the CPU cannot run the requested set.
+  template <class T> 
+  const lift_kernels<T>& get_lift_kernels(isa_t isa);
+
+  /// Returns kernels chosen for this CPU.  The choice is made once, on first call.
+  /// Set NAMI_SIMD to scalar, sse2, avx2, or avx512 in the environment to limit it.
+  template <class T> 
+  const lift_kernels<T>& get_lift_kernels();
+
+  // Kernels exist for these types; see simd_lift.cpp.
+  template <> const lift_kernels<double>& get_lift_kernels<double>(isa_t isa);
+  template <> const lift_kernels<float>&  get_lift_kernels<float>(isa_t isa);
+  template <> const lift_kernels<double>& get_lift_kernels<double>();
+  template <> const lift_kernels<float>&  get_lift_kernels<float>();
+
+}} // namespaces
+
+#endif // NAMI_SIMD_LIFT_H
@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "thread_utils.h"
+#include "nami-config.h"
+
+#ifdef NAMI_HAVE_OPENMP
+#include <omp.h>
+#endif // NAMI_HAVE_OPENMP
+
+namespace nami {
+
+  size_t default_threads() {
+#ifdef NAMI_HAVE_OPENMP
+    return omp_get_max_threads();
+#else 
+    return 1;
+#endif // NAMI_HAVE_OPENMP
+  }
+
+
+  size_t thread_num() {
+#ifdef NAMI_HAVE_OPENMP
+    return omp_get_thread_num();
+#else 
+    return 0;
+#endif // NAMI_HAVE_OPENMP
+  }
+
+
+  size_t thread_level() {
+#ifdef NAMI_HAVE_OPENMP
+    return omp_get_level();
+#else 
+    return 0;
+#endif // NAMI_HAVE_OPENMP
+  }
+
+
+  void parallel_for(size_t n, size_t threads, void (*body)(size_t i, void *arg), void *arg) {
+    const int nthreads = threads;
+    #pragma omp parallel for num_threads(nthreads) if (nthreads > 1 && n > 1)
+    for (long i=0; i < (long)n; i++) {
+      body(i, arg);
+    }
+  }
+
+} // namespace nami
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef NAMI_THREAD_UTILS_H
+#define NAMI_THREAD_UTILS_H
+
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+/// \file thread_utils.h
+/// Helpers for the threaded transforms.  Nami uses OpenMP for threading when it 
+/// is built with it (NAMI_HAVE_OPENMP); otherwise everything runs on one thread.
+/// These are compiled into the library, so code that includes nami headers does
+/// not itself need to be built with OpenMP.
+namespace nami {
+
+  /// Number of threads used when 0 threads are requested: OpenMP's default 
+  /// (e.g. from OMP_NUM_THREADS), or 1 without OpenMP.
+  size_t default_threads();
+
+  /// Index of the calling thread in the current parallel region.  0 outside 
+  /// of one, or without OpenMP.
+  size_t thread_num();
+
+  /// Number of parallel regions, active or not, enclosing the calling thread.  
+  /// 0 outside of any, or without OpenMP.
+  size_t thread_level();
+
+  /// Calls body(i, arg) for each i in [0, n), divided among up to <threads> 
+  /// threads.  Lets header code run loops on threads without using OpenMP itself.
+  void parallel_for(size_t n, size_t threads, void (*body)(size_t i, void *arg), void *arg);
+
+
+  /// Scratch buffers that belong to one transform object.  Calls on the object 
+  /// use one buffer, whatever thread they come from, so an object can be made and 
+  /// used by each thread of an application's own parallel region.  While the 
+  /// object runs a threaded pass (see begin_pass()), each thread of the pass's 
+  /// own parallel regions gets a buffer of its own.
+  template <class T>
+  class scratch_space {
+  public:
+    scratch_space() : buffers_(1), pass_level_(-1) { }
+
+    /// Index of the calling thread's buffer.  Threads of a pass's parallel 
+    /// regions are numbered within them; anything else uses buffer 0.
+    size_t index() const {
+      if (pass_level_ < 0 || thread_level() <= size_t(pass_level_)) return 0;
+      assert(thread_num() < buffers_.size());
+      return thread_num();
+    }
+
+    /// Buffer for the calling thread.
+    std::vector<T>& get() { return buffers_[index()]; }
+
+    /// Starts a threaded pass, whose parallel regions are opened from here with 
+    /// up to <threads> threads.
+    void begin_pass(size_t threads) {
+      if (buffers_.size() < threads) buffers_.resize(threads);
+      pass_level_ = thread_level();
+    }
+
+    /// Ends the pass started by begin_pass().
+    void end_pass() { pass_level_ = -1; }
+
+  private:
+    std::vector< std::vector<T> > buffers_;   ///< Buffer for each thread of a pass
+    long pass_level_;                         ///< thread_level() of the pass, or -1
+  };
+
+
+} // namespace nami
+
+#endif // NAMI_THREAD_UTILS_H
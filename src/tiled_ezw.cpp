@@ -0,0 +1,299 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "tiled_ezw.h"
+#include "wt_lift.h"
+#include "io_utils.h"
+#include "two_utils.h"
+#include "thread_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  void tile_grid::tile(size_t i, size_t& row, size_t& col, size_t& trows, size_t& tcols) const {
+    row = (i / tiles_across()) * tile_rows;
+    col = (i % tiles_across()) * tile_cols;
+    trows = min(tile_rows, rows - row);
+    tcols = min(tile_cols, cols - col);
+  }
+
+
+  size_t tile_directory::write_out(ostream& out) const {
+    size_t size = 0;
+    size += io_utils::vl_write(out, tile_rows);
+    size += io_utils::vl_write(out, tile_cols);
+    for (size_t i=0; i < sizes.size(); i++) {
+      size += io_utils::vl_write(out, sizes[i]);
+    }
+    return size;
+  }
+
+
+  void tile_directory::read_in(istream& in, const ezw_header& header, tile_directory& dir) {
+    dir.tile_rows = io_utils::vl_read(in);
+    dir.tile_cols = io_utils::vl_read(in);
+    if (!in || !dir.tile_rows || !dir.tile_cols) {
+      throw runtime_error("Error: malformed tile directory.");
+    }
+    tile_grid grid(header.rows, header.cols, dir.tile_rows, dir.tile_cols);
+    dir.sizes.resize(grid.size());
+    for (size_t i=0; i < dir.sizes.size(); i++) {
+      dir.sizes[i] = io_utils::vl_read(in);
+    }
+    if (!in) {
+      throw runtime_error("Error: malformed tile directory.");
+    }
+  }
+
+
+  tiled_ezw_encoder::tiled_ezw_encoder() 
+    : tile_rows_(256), tile_cols_(256), threads_(1), scheme_(lift_scheme::of<cdf97>()) { }
+
+
+  tiled_ezw_encoder::~tiled_ezw_encoder() { }
+
+
+  void tiled_ezw_encoder::set_tile_size(size_t rows, size_t cols) {
+    if (!rows || !cols) {
+      throw runtime_error("Error: tiles must have at least one row and column.");
+    }
+    tile_rows_ = rows;
+    tile_cols_ = cols;
+  }
+
+
+  size_t tiled_ezw_encoder::encode(const matrix_view& mat, ostream& out, int level) {
+    return encode_tiles(mat, out, level);
+  }
+
+
+  size_t tiled_ezw_encoder::encode(const matrix_view_f& mat, ostream& out, int level) {
+    return encode_tiles(mat, out, level);
+  }
+
+
+  template <class T>
+  size_t tiled_ezw_encoder::encode_tiles(const basic_matrix_view<T>& mat, ostream& out, 
+                                         int level) {
+    const tile_grid grid(mat.size1(), mat.size2(), tile_rows_, tile_cols_);
+    const long tiles = grid.size();
+    const size_t threads = max(min(threads_ ? threads_ : default_threads(), (size_t)tiles),
+                               size_t(1));
+    vector<string> codes(tiles);
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+      basic_wt_lift<T> wt;
+      wt.set_scheme(scheme_);
+      ezw_encoder coder(coder_);
+      boost::numeric::ublas::matrix<T> tile;
+
+      #pragma omp for schedule(dynamic)
+      for (long i=0; i < tiles; i++) {
+        size_t row, col, rows, cols;
+        grid.tile(i, row, col, rows, cols);
+        tile.resize(rows, cols, false);
+        for (size_t r=0; r < rows; r++) {
+          const T *src = mat.data() + (row + r) * mat.pitch() + col;
+          copy(src, src + cols, &tile(r, 0));
+        }
+
+        const int max_level = levels_to_one(max(rows, cols));
+        const int l = (level < 0) ? max_level : min(level, max_level);
+        wt.fwt_2d(tile, l);
+        ostringstream code;
+        coder.encode(basic_matrix_view<T>(tile), code, l);
+        codes[i] = code.str();
+      }
+    }
+
+    tile_directory dir;
+    dir.tile_rows = tile_rows_;
+    dir.tile_cols = tile_cols_;
+    dir.sizes.resize(tiles);
+    size_t total = 0;
+    for (long i=0; i < tiles; i++) {
+      dir.sizes[i] = codes[i].size();
+      total += codes[i].size();
+    }
+
+    // the header records the levels of a full tile, and the coder's settings.
+    const size_t full_rows = min(tile_rows_, grid.rows);
+    const size_t full_cols = min(tile_cols_, grid.cols);
+    const int max_level = levels_to_one(max(full_rows, full_cols));
+    ezw_header header(grid.rows, grid.cols, (level < 0) ? max_level : min(level, max_level),
+                      0, coder_.scale(), 0, coder_.encoding_type(), tiles);
+    header.tiled = true;
+    header.enc_size = total;
+
+    size_t bytes = header.write_out(out);
+    bytes += dir.write_out(out);
+    for (long i=0; i < tiles; i++) {
+      out.write(codes[i].data(), codes[i].size());
+    }
+    return bytes + total;
+  }
+
+
+  tiled_ezw_decoder::tiled_ezw_decoder() 
+    : threads_(1), scheme_(lift_scheme::of<cdf97>()) { }
+
+
+  tiled_ezw_decoder::~tiled_ezw_decoder() { }
+
+
+  void tiled_ezw_decoder::read_directory(istream& in, tile_directory& dir) {
+    ezw_header header;
+    ezw_header::read_in(in, header);
+    if (!in || !header.tiled) {
+      throw runtime_error("Error: data is not tiled; decode it with ezw_decoder.");
+    }
+    tile_directory::read_in(in, header, dir);
+    grid_ = tile_grid(header.rows, header.cols, dir.tile_rows, dir.tile_cols);
+  }
+
+
+  void tiled_ezw_decoder::decode(istream& in, nami_matrix& mat) {
+    decode_tiles(in, mat);
+  }
+
+
+  void tiled_ezw_decoder::decode(istream& in, nami_matrix_f& mat) {
+    decode_tiles(in, mat);
+  }
+
+
+  void tiled_ezw_decoder::decode_tile(istream& in, size_t i, nami_matrix& mat) {
+    decode_one(in, i, mat);
+  }
+
+
+  void tiled_ezw_decoder::decode_tile(istream& in, size_t i, nami_matrix_f& mat) {
+    decode_one(in, i, mat);
+  }
+
+
+  template <class T>
+  void tiled_ezw_decoder::decode_tiles(istream& in, boost::numeric::ublas::matrix<T>& mat) {
+    tile_directory dir;
+    read_directory(in, dir);
+    const long tiles = grid_.size();
+    vector<string> codes(tiles);
+    for (long i=0; i < tiles; i++) {
+      codes[i].resize(dir.sizes[i]);
+      in.read(&codes[i][0], dir.sizes[i]);
+    }
+    if (!in) {
+      throw runtime_error("Error: tiled data ended early.");
+    }
+
+    mat.resize(grid_.rows, grid_.cols, false);
+    const size_t threads = max(min(threads_ ? threads_ : default_threads(), (size_t)tiles),
+                               size_t(1));
+    bool failed = false;
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+      basic_wt_lift<T> wt;
+      wt.set_scheme(scheme_);
+      ezw_decoder coder(coder_);
+      boost::numeric::ublas::matrix<T> tile;
+
+      #pragma omp for schedule(dynamic)
+      for (long i=0; i < tiles; i++) {
+        size_t row, col, rows, cols;
+        grid_.tile(i, row, col, rows, cols);
+        try {
+          istringstream code(codes[i]);
+          const int level = coder.decode(code, tile);
+          if (tile.size1() != rows || tile.size2() != cols) {
+            throw runtime_error("Error: tile is not the size its directory says.");
+          }
+          wt.iwt_2d(tile, level);
+        } catch (const exception&) {
+          // exceptions can't leave a parallel region; rethrow once it ends.
+          #pragma omp critical
+          failed = true;
+          continue;
+        }
+        for (size_t r=0; r < rows; r++) {
+          copy(&tile(r, 0), &tile(r, 0) + cols, &mat(row + r, col));
+        }
+      }
+    }
+
+    if (failed) {
+      throw runtime_error("Error: malformed tile in tiled data.");
+    }
+  }
+
+
+  template <class T>
+  void tiled_ezw_decoder::decode_one(istream& in, size_t i, boost::numeric::ublas::matrix<T>& mat) {
+    tile_directory dir;
+    read_directory(in, dir);
+    if (i >= grid_.size()) {
+      throw runtime_error("Error: no such tile in tiled data.");
+    }
+
+    // skip the tiles before this one without decoding them.
+    size_t skip = 0;
+    for (size_t t=0; t < i; t++) {
+      skip += dir.sizes[t];
+    }
+    in.ignore(skip);
+    string code(dir.sizes[i], '\0');
+    in.read(&code[0], code.size());
+    if (!in) {
+      throw runtime_error("Error: tiled data ended early.");
+    }
+
+    size_t row, col, rows, cols;
+    grid_.tile(i, row, col, rows, cols);
+    istringstream tile_in(code);
+    const int level = coder_.decode(tile_in, mat);
+    if (mat.size1() != rows || mat.size2() != cols) {
+      throw runtime_error("Error: tile is not the size its directory says.");
+    }
+    basic_wt_lift<T> wt;
+    wt.set_scheme(scheme_);
+    wt.iwt_2d(mat, level);
+  }
+
+} // namespace nami
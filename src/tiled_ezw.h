@@ -0,0 +1,227 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TILED_EZW_H
+#define TILED_EZW_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+#include "lift_scheme.h"
+#include "nami_matrix.h"
+
+namespace nami {
+
+  /// Splits a rows x cols matrix into tiles of tile_rows x tile_cols, numbered row
+  /// by row.  Tiles on the bottom and right edges hold what is left over.
+  struct tile_grid {
+    size_t rows;         ///< Rows in the matrix
+    size_t cols;         ///< Columns in the matrix
+    size_t tile_rows;    ///< Rows in a full tile
+    size_t tile_cols;    ///< Columns in a full tile
+
+    tile_grid(size_t r = 0, size_t c = 0, size_t tr = 1, size_t tc = 1)
+      : rows(r), cols(c), tile_rows(tr), tile_cols(tc) { }
+
+    /// Tiles in each column of tiles.
+    size_t tiles_down() const { return (rows + tile_rows - 1) / tile_rows; }
+
+    /// Tiles in each row of tiles.
+    size_t tiles_across() const { return (cols + tile_cols - 1) / tile_cols; }
+
+    /// Total number of tiles.
+    size_t size() const { return tiles_down() * tiles_across(); }
+
+    /// Index of the tile holding value (row, col) of the matrix.
+    size_t tile_at(size_t row, size_t col) const {
+      return (row / tile_rows) * tiles_across() + col / tile_cols;
+    }
+
+    /// Gets the first row and column of tile i, and its size.
+    void tile(size_t i, size_t& row, size_t& col, size_t& trows, size_t& tcols) const;
+  };
+
+
+  /// Written after the ezw_header of tiled data: the tile size, then the length 
+  /// of each tile's code, so that any tile can be found without decoding others.
+  /// Each tile's code is a whole ezw_encoder stream of the transformed tile.
+  struct tile_directory {
+    size_t tile_rows;              ///< Rows in a full tile
+    size_t tile_cols;              ///< Columns in a full tile
+    std::vector<size_t> sizes;     ///< Bytes in each tile's code, in tile order
+
+    size_t write_out(std::ostream& out) const;
+
+    /// Reads the directory of a matrix whose header is <header>.
+    static void read_in(std::istream& in, const ezw_header& header, tile_directory& dir);
+  };
+
+
+  /// Tiled transform and coding, in the manner of JPEG 2000.  The matrix is split 
+  /// into tiles (see tile_grid), and each tile is transformed with wt_lift and 
+  /// EZW-coded on its own, so tiles are divided among threads, and
+  /// tiled_ezw_decoder can decode one tile without the rest:
+  ///
+  ///   tiled_ezw_encoder encoder;
+  ///   encoder.set_tile_size(256, 256);
+  ///   encoder.set_threads(0);
+  ///   encoder.coder().set_scale(1000);
+  ///   encoder.encode(mat, out);     // mat is not transformed first, or changed
+  ///
+  /// The output is an ezw_header marked as tiled, a tile_directory, and then the 
+  /// code of each tile.  Zerotrees stop at tile edges, so smaller tiles code a 
+  /// little larger than the whole matrix would.
+  ///
+  class tiled_ezw_encoder {
+  public:
+    tiled_ezw_encoder();
+    virtual ~tiled_ezw_encoder();
+
+    /// Transforms and codes mat tile by tile onto out.  Tiles get <level> levels 
+    /// of transform, or as many as they can take if level is negative or too big
+    /// for a small edge tile; the header records the levels of a full tile.  
+    /// Returns the number of bytes written.
+    size_t encode(const matrix_view& mat, std::ostream& out, int level = -1);
+
+    /// Transforms and codes a single-precision matrix.
+    /// @see encode(const matrix_view&, std::ostream&, int)
+    size_t encode(const matrix_view_f& mat, std::ostream& out, int level = -1);
+
+    /// Rows and columns in a full tile.  Default is 256 x 256.
+    size_t tile_rows() const { return tile_rows_; }
+    size_t tile_cols() const { return tile_cols_; }
+
+    /// Sets the size of full tiles.
+    void set_tile_size(size_t rows, size_t cols);
+
+    /// Threads that tiles are divided among.  Defaults to 1.
+    size_t threads() const { return threads_; }
+
+    /// Sets number of threads; 0 uses OpenMP's default thread count.
+    void set_threads(size_t threads) { threads_ = threads; }
+
+    /// Codes each tile.  Set its scale, pass limit, and encoding type here; each 
+    /// thread codes with a copy of it.
+    ezw_encoder& coder() { return coder_; }
+
+    /// Use lifting scheme S to transform tiles, e.g. set_scheme<cdf53>().  The 
+    /// decoder must use the same scheme.  Default is CDF 9/7.
+    template <class S>
+    void set_scheme() { scheme_ = lift_scheme::of<S>(); }
+
+    /// Use a lifting scheme built at runtime.
+    void set_scheme(const lift_scheme& scheme) { scheme_ = scheme; }
+
+    /// The lifting scheme tiles are transformed with.
+    const lift_scheme& scheme() const { return scheme_; }
+
+  protected:
+    size_t tile_rows_;       ///< Rows in a full tile
+    size_t tile_cols_;       ///< Columns in a full tile
+    size_t threads_;         ///< Threads; 0 for the default
+    ezw_encoder coder_;      ///< Coder copied by each thread
+    lift_scheme scheme_;     ///< Scheme tiles are transformed with
+
+    /// Does the work of both encode() calls.
+    template <class T>
+    size_t encode_tiles(const basic_matrix_view<T>& mat, std::ostream& out, int level);
+  };
+
+
+  /// Decodes the output of tiled_ezw_encoder, and inverts each tile's transform, 
+  /// so the output is the matrix itself.  Tiles are divided among threads.
+  class tiled_ezw_decoder {
+  public:
+    tiled_ezw_decoder();
+    virtual ~tiled_ezw_decoder();
+
+    /// Decodes the whole matrix from in into mat, which is resized to fit.  Throws
+    /// std::runtime_error if in does not hold tiled data.
+    void decode(std::istream& in, nami_matrix& mat);
+
+    /// Decodes into a single-precision matrix.
+    /// @see decode(std::istream&, nami_matrix&)
+    void decode(std::istream& in, nami_matrix_f& mat);
+
+    /// Decodes just tile i of the matrix into mat, resized to the size of the tile.
+    /// The other tiles' code is skipped, not decoded.  grid() tells where tile i is.
+    void decode_tile(std::istream& in, size_t i, nami_matrix& mat);
+
+    /// Decodes just tile i into a single-precision matrix.
+    /// @see decode_tile(std::istream&, size_t, nami_matrix&)
+    void decode_tile(std::istream& in, size_t i, nami_matrix_f& mat);
+
+    /// Tiles of the last matrix read.
+    const tile_grid& grid() const { return grid_; }
+
+    /// Threads that tiles are divided among.  Defaults to 1.
+    size_t threads() const { return threads_; }
+
+    /// Sets number of threads; 0 uses OpenMP's default thread count.
+    void set_threads(size_t threads) { threads_ = threads; }
+
+    /// Decodes each tile.  Set its pass limit or byte budget here; each thread 
+    /// decodes with a copy of it.
+    ezw_decoder& coder() { return coder_; }
+
+    /// Use lifting scheme S to invert tiles; it must be the encoder's scheme.
+    template <class S>
+    void set_scheme() { scheme_ = lift_scheme::of<S>(); }
+
+    /// Use a lifting scheme built at runtime.
+    void set_scheme(const lift_scheme& scheme) { scheme_ = scheme; }
+
+    /// The lifting scheme tiles are inverted with.
+    const lift_scheme& scheme() const { return scheme_; }
+
+  protected:
+    size_t threads_;         ///< Threads; 0 for the default
+    ezw_decoder coder_;      ///< Decoder copied by each thread
+    lift_scheme scheme_;     ///< Scheme tiles are inverted with
+    tile_grid grid_;         ///< Tiles of the last matrix read
+
+    /// Reads the header and tile directory from in, and sets up grid_.
+    void read_directory(std::istream& in, tile_directory& dir);
+
+    /// Does the work of both decode() calls.
+    template <class T>
+    void decode_tiles(std::istream& in, boost::numeric::ublas::matrix<T>& mat);
+
+    /// Does the work of both decode_tile() calls.
+    template <class T>
+    void decode_one(std::istream& in, size_t i, boost::numeric::ublas::matrix<T>& mat);
+  };
+
+} // namespace nami
+
+#endif // TILED_EZW_H
@@ -30,7 +30,7 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////////////////////////////
 #ifndef NAMI_TWO_UTILS_H_
-#define NAMI_TWO_UTILS_H
+#define NAMI_TWO_UTILS_H_
 
 #include <cassert>
 #include <stdint.h>
@@ -105,6 +105,27 @@ namespace nami {
     return count;
   }
 
+  /// Number of times n can be halved, rounding up, before it reaches 1.  This
+  /// is the number of levels a transform can apply to a dimension of length n
+  /// when odd lengths split into a low band one longer than the high band.
+  inline int levels_to_one(uint64_t n) {
+    int levels = 0;
+    while (n > 1) {
+      n = (n + 1) >> 1;
+      levels++;
+    }
+    return levels;
+  }
+
+  /// Length of the low-frequency band of a dimension of length n after the
+  /// given number of levels, i.e. n halved levels times, rounding up.
+  inline uint64_t low_band_size(uint64_t n, int levels) {
+    for (int i=0; i < levels && n > 1; i++) {
+      n = (n + 1) >> 1;
+    }
+    return n;
+  }
+
 } // namespace nami
 
 #endif // NAMI_TWO_UTILS_H
@@ -38,27 +38,29 @@ using namespace std;
 
 namespace nami {
 
-  int wt_1d::fwt_1d(double *data, size_t len, int level) {
+  template <class T>
+  int basic_wt_1d<T>::fwt_1d(T *data, size_t len, int level) {
     if (level < 0) {
-      level = times_divisible_by_2(len);
+      level = levels_to_one(len);
     }
-    assert(level <= times_divisible_by_2(len));
+    assert(level <= levels_to_one(len));
 
     size_t cur_len = len;
     for (int i=0; i < level; i++) {
       fwt_1d_single(data, cur_len);
-      cur_len >>= 1;
+      cur_len = low_band_size(cur_len, 1);
     }
 
     return level;
   }
 
 
-  int wt_1d::iwt_1d(double *data, size_t len, int fwt_level, int iwt_level) {
+  template <class T>
+  int basic_wt_1d<T>::iwt_1d(T *data, size_t len, int fwt_level, int iwt_level) {
     if (fwt_level < 0) {
-      fwt_level = times_divisible_by_2(len);
+      fwt_level = levels_to_one(len);
     }
-    assert(fwt_level <= times_divisible_by_2(len));
+    assert(fwt_level <= levels_to_one(len));
 
     if (iwt_level < 0) {
       iwt_level = INT_MAX;
@@ -66,7 +68,7 @@ namespace nami {
 
     int levels = 0;
     for (int i=fwt_level-1; i >= 0 && levels < iwt_level; i--) {
-      size_t cur_len = len >> i;
+      size_t cur_len = low_band_size(len, i);
       iwt_1d_single(data, cur_len);
       levels++;
     }
@@ -74,4 +76,8 @@ namespace nami {
     return levels;
   }
 
+
+  template class basic_wt_1d<double>;
+  template class basic_wt_1d<float>;
+
 } // namespace nami
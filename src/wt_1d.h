@@ -37,40 +37,46 @@
 
 namespace nami {
   
-  class wt_1d {
+  /// Abstract superclass for 1d transforms on values of type T (double or float).
+  template <class T>
+  class basic_wt_1d {
   public:
-    wt_1d() { }
-    virtual ~wt_1d() { }
+    basic_wt_1d() { }
+    virtual ~basic_wt_1d() { }
 
     /// Algorithm for forward transform in 1 dimension.  Applies wavelet transform on
     /// lower-frequency bands recursively up to level, or as far as possible if level is -1.
-    virtual int fwt_1d(double *data, size_t len, int level = -1);
+    /// The low band of a signal of length n is its first (n+1)/2 values.
+    virtual int fwt_1d(T *data, size_t len, int level = -1);
     
     /// Algorithm for inverse transform in 1 dimension.  Starts at fwt_level and applies 
     /// inverse transform recursively up to iwt_level times.
     /// 
     /// fwt_level:    level of the fwt applied to the matrix (default max possible)
     /// iwt_level:    level of iwt to perform on the matrix. (defaults to fwt_level)
-    virtual int iwt_1d(double *data, size_t len, int fwt_level = -1, int iwt_level = -1);
+    virtual int iwt_1d(T *data, size_t len, int fwt_level = -1, int iwt_level = -1);
 
     /// Convenience function for fwt on vectors
-    /// @see fwt_1d(double, size_t, int)
-    inline int fwt_1d(std::vector<double> data, int level = -1) {
+    /// @see fwt_1d(T*, size_t, int)
+    inline int fwt_1d(std::vector<T> data, int level = -1) {
       return fwt_1d(&data[0], data.size(), level);
     }
     
     /// Convenience function for iwt on vectors
-    /// @see iwt_1d(double, size_t, int, int)
-    inline int iwt_1d(std::vector<double> data, int fwt_level = -1, int iwt_level = -1) {
+    /// @see iwt_1d(T*, size_t, int, int)
+    inline int iwt_1d(std::vector<T> data, int fwt_level = -1, int iwt_level = -1) {
       return iwt_1d(&data[0], data.size(), fwt_level, iwt_level);
     }
 
   protected:
     // single-level implementations of the wavelet transform.
-    virtual void fwt_1d_single(double *data, size_t len) = 0;
-    virtual void iwt_1d_single(double *data, size_t len) = 0;
+    virtual void fwt_1d_single(T *data, size_t len) = 0;
+    virtual void iwt_1d_single(T *data, size_t len) = 0;
 
-  }; // wt_1d
+  }; // basic_wt_1d
+
+  typedef basic_wt_1d<double> wt_1d;
+  typedef basic_wt_1d<float>  wt_1d_f;
   
 } // namespace nami
 
@@ -33,34 +33,64 @@
 
 #include "wt_1d_direct.h"
 #include "two_utils.h"
+#include "thread_utils.h"
 
 using namespace std;
 
 namespace nami {
 
-  // just inits the filter.
-  wt_1d_direct::wt_1d_direct(filter_bank& f) : f_(f) { }
+  // inits the filter and splits the synthesis taps into their two phases.
+  template <class T>
+  basic_wt_1d_direct<T>::basic_wt_1d_direct(filter_bank& f) 
+    : f_(f), even_taps_(f.size), odd_taps_(f.size) 
+  {
+    for (size_t d=0; d < f_.size; d++) {
+      even_taps_[d] = (d & 1) ? f_.ihpf[d] : f_.ilpf[d];
+      odd_taps_[d]  = (d & 1) ? f_.ilpf[d] : f_.ihpf[d];
+    }
+
+    folded_ = (f_.size == folded_size
+               && is_symmetric(f_.lpf, f_.size)
+               && is_symmetric(f_.hpf, f_.size)
+               && is_symmetric(&even_taps_[0], f_.size)
+               && is_symmetric(&odd_taps_[0], f_.size));
+  }
   
   // currently does nothing.
-  wt_1d_direct::~wt_1d_direct() { }
+  template <class T>
+  basic_wt_1d_direct<T>::~basic_wt_1d_direct() { }
 
 
-  void wt_1d_direct::sym_extend(double *x, size_t n, size_t stride, bool interleave) {
-    size_t tsize = n + (2 * (f_.size/2) + 1);
-    if (tsize > temp_.size()) temp_.resize(tsize);
+  /// Copies one row of a panel of w values.
+  template <class T>
+  static inline void copy_row(T *dest, const T *src, size_t w) {
+    for (size_t j=0; j < w; j++) dest[j] = src[j];
+  }
+
+
+  template <class T>
+  const T *basic_wt_1d_direct<T>::sym_extend(T *x, size_t n, size_t stride, bool interleave, size_t w) {
+    size_t tsize = (n + (2 * (f_.size/2) + 1)) * w;
+    std::vector<T>& temp = temps_.get();
+    if (tsize > temp.size()) temp.resize(tsize);
+    T *t = &temp[0];
 
     // copy data from x into middle of temp
     if (interleave) {
-      // this interleaves first and second half of x in temp
+      // this interleaves the low band, the first (n+1)/2 values of x, with the 
+      // high band after it.
+      const size_t h = (n+1)/2;
+      for (size_t i=0; i < h; i++) {
+        copy_row(t + (f_.size/2+(2*i)) * w, x + i*stride, w);
+      }
       for (size_t i=0; i < n/2; i++) {
-        temp_[f_.size/2+(2*i)] = x[i*stride];
-        temp_[f_.size/2+(2*i+1)] = x[(n/2+i)*stride];
+        copy_row(t + (f_.size/2+(2*i+1)) * w, x + (h+i)*stride, w);
       }
 
     } else {
       // this just copies x straight into temp
       for (size_t i=0; i < n; i++) {
-        temp_[f_.size/2+i] = x[i*stride];
+        copy_row(t + (f_.size/2+i) * w, x + i*stride, w);
       }
     }
 
@@ -68,45 +98,66 @@ namespace nami {
     int l = f_.size/2-1;
     int r = n + f_.size/2;
     for (size_t i=1; i<=f_.size/2; i++) {
-      temp_[l] = temp_[l+2*i];
-      temp_[r] = temp_[l+n-1];
+      copy_row(t + l*w, t + (l+2*i)*w,  w);
+      copy_row(t + r*w, t + (l+n-1)*w, w);
       l--;
       r++;
     }
-    temp_[r] = temp_[l+n-1];   // last elt on right
+    copy_row(t + r*w, t + (l+n-1)*w, w);   // last elt on right
+    return t;
+  }
+
+
+  template <class T>
+  void basic_wt_1d_direct<T>::fwt_1d_single(T *data, size_t n) {
+    if (folded_) fwt_1d_line(sym_fir_kernel<folded_size>(), data, n);
+    else         fwt_1d_line(fir_kernel(f_.size), data, n);
   }
 
 
-  void wt_1d_direct::fwt_1d_single(double *data, size_t n) {
-    assert(even(n));
+  template <class T>
+  void basic_wt_1d_direct<T>::iwt_1d_single(T *data, size_t n) {
+    if (folded_) iwt_1d_line(sym_fir_kernel<folded_size>(), data, n);
+    else         iwt_1d_line(fir_kernel(f_.size), data, n);
+  }
+
 
-    sym_extend(data, n, 1);
+  template <class T> template <class K>
+  void basic_wt_1d_direct<T>::fwt_1d_line(const K& fir, T *data, size_t n) {
+    const T *temp = sym_extend(data, n, 1);
+    const double *lpf = f_.lpf;
+    const double *hpf = f_.hpf;
+
+    // odd lengths get one more low output than high.
     size_t len = n >> 1;
+    size_t low = (n + 1) >> 1;
     for (size_t i=0; i < len; i++) {
-      data[i] = data[len+i] = 0;
-
-      for (size_t d=0; d < f_.size; d++) {
-        data[i] += f_.lpf[d] * temp_[2*i+d];
-        data[len+i] += f_.hpf[d] * temp_[2*i+d+1];
-      }
+      const T *t = temp + 2*i;
+      data[i] = fir(lpf, t, 1);
+      data[low+i] = fir(hpf, t+1, 1);
     }
+    if (low > len) data[len] = fir(lpf, temp + 2*len, 1);
   }
 
   
-  void wt_1d_direct::iwt_1d_single(double *data, size_t n) {
-    assert(even(n));
-
-    sym_extend(data, n, 1, true);
-    for (size_t i=0; i < n; i++) {
-      data[i] = 0.0;
-      for (size_t d=0; d < f_.size; d++) {
-        // this check upsamples the two bands in the input data
-        // sym_extend packs the data interleaved; we just skip even/odd indices
-        // here instead of having 2 extra temp arrays for the upsampled data.
-        if ((i+d) & 1) data[i] += f_.ihpf[d] * temp_[i+d];
-        else           data[i] += f_.ilpf[d] * temp_[i+d];
-      }
+  template <class T> template <class K>
+  void basic_wt_1d_direct<T>::iwt_1d_line(const K& fir, T *data, size_t n) {
+    // sym_extend packs the two bands interleaved, which upsamples them; the
+    // polyphase taps then pick the right filter for each position.
+    const T *temp = sym_extend(data, n, 1, true);
+    const double *even = &even_taps_[0];
+    const double *odd = &odd_taps_[0];
+
+    for (size_t i=0; i+1 < n; i += 2) {
+      const T *t = temp + i;
+      data[i] = fir(even, t, 1);
+      data[i+1] = fir(odd, t+1, 1);
     }
+    if (n & 1) data[n-1] = fir(even, temp + n-1, 1);
   }
 
+
+  template class basic_wt_1d_direct<double>;
+  template class basic_wt_1d_direct<float>;
+
 } // wavelet
@@ -36,7 +36,9 @@
 
 #include "wt_1d.h"
 #include "filter_bank.h"
+#include "filter_kernels.h"
 #include "cdf97.h"
+#include "thread_utils.h"
 
 namespace nami {
   
@@ -47,26 +49,31 @@ namespace nami {
   /// This is designd to be inherited privately by something more sophisticated
   /// that can make use of its functions. e.g. wt_direct. which knows about 
   /// boost matrices.
-  class wt_1d_direct : public wt_1d {
+  ///
+  /// T is the type of the values transformed, double or float.  Filter taps are 
+  /// kept in double for both.
+  template <class T>
+  class basic_wt_1d_direct : public basic_wt_1d<T> {
   public:
     /// Constructs a new direct wavelet transform with the provided filter bank.
     /// Filter defaults to CDF 9/7 Wavelets.
-    wt_1d_direct(filter_bank& f = filter::getCDF97());
+    basic_wt_1d_direct(filter_bank& f = filter::getCDF97());
 
     /// Destructor
-    virtual ~wt_1d_direct();
+    virtual ~basic_wt_1d_direct();
 
   protected:
     /// Forward transform for raw contiguous data.
-    virtual void fwt_1d_single(double *data, size_t n);
+    virtual void fwt_1d_single(T *data, size_t n);
 
     /// Inverse transform for raw contiguous data.
-    virtual void iwt_1d_single(double *data, size_t n);
+    virtual void iwt_1d_single(T *data, size_t n);
 
     /// temporary storage for packing values
-    std::vector<double> temp_;
+    scratch_space<T> temps_;
 
-    /// Copies x into temp and symmetrically extends edges by filter size.
+    /// Copies x into the calling thread's scratch space (temp) and symmetrically 
+    /// extends edges by filter size.  Returns a pointer to temp.
     ///   e.g. if filter size is 3 and x is:
     ///            1 2 3 4 5 6 7
     ///   temp is filled with:
@@ -75,12 +82,36 @@ namespace nami {
     ///      x   input array data
     ///      n   elements to copy from input
     /// stride   stride of data in input
-    void sym_extend(double *x, size_t n, size_t stride = 1, bool interleave = false);
+    ///      w   number of adjacent signals to extend at once.  Element i of signal j
+    ///          is read from x[i*stride + j] and stored at temp[i*w + j].
+    const T *sym_extend(T *x, size_t n, size_t stride = 1, bool interleave = false, 
+                    size_t w = 1);
 
     /// Filter bank for this transform
     filter_bank& f_;
+
+    /// Polyphase synthesis filters.  Upsampling the two bands and interleaving
+    /// them means even outputs of the inverse see ilpf at even taps and ihpf at
+    /// odd taps, and odd outputs the reverse.  Splitting the taps by phase at
+    /// construction lets each output stream run one branch-free tap loop.
+    std::vector<double> even_taps_, odd_taps_;
+
+    /// Filter length with a compiled convolution kernel (CDF 9/7).  A bank of
+    /// this length whose filters are all symmetric runs through 
+    /// sym_fir_kernel<folded_size>; anything else uses fir_kernel.
+    static const size_t folded_size = 9;
+
+    /// True if f_ uses the folded kernel.
+    bool folded_;
+
+    /// Convolution loops for one contiguous signal, for a kernel type K.
+    template <class K> void fwt_1d_line(const K& fir, T *data, size_t n);
+    template <class K> void iwt_1d_line(const K& fir, T *data, size_t n);
   };
 
+  typedef basic_wt_1d_direct<double> wt_1d_direct;
+  typedef basic_wt_1d_direct<float>  wt_1d_direct_f;
+
 } // namespace
 
 #endif // WT_1D_DIRECT_H
@@ -32,34 +32,690 @@
 #ifndef WT_1D_LIFT_H
 #define WT_1D_LIFT_H
 
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
 #include "wt_1d.h"
+#include "simd_lift.h"
+#include "lift_scheme.h"
+#include "thread_utils.h"
 
 namespace nami {
 
-  /// 1d lifted wavelet transform.  Currently only supports CDF97 wavelets.
+  /// 1d lifted wavelet transform.  Uses CDF 9/7 wavelets by default; any scheme in
+  /// lift_scheme.h, one defined the same way, or a lift_scheme built at runtime can 
+  /// be chosen with set_scheme().
   ///
   /// Provides implementation of wt_1d_single routines for wt_1d interface.
+  /// Data is split into even and odd samples before lifting, so that the lifting
+  /// steps can use the vectorized kernels in simd_lift.h.  All lifting steps are
+  /// fused into one pipelined sweep over the data.
+  ///
+  /// The sweeps are not specialized per scheme.  Each step is one kernel call per
+  /// block of about a thousand values, so looping over the steps costs next to 
+  /// nothing, while inlining the kernels into per-scheme sweeps would mean giving 
+  /// up choosing them by instruction set at runtime.
+  /// 
+  /// T is the type of the values transformed, double or float.  Coefficients are
+  /// rounded to T, so the float transform lifts entirely in single precision.
   /// 
   /// Based on the 1d version by Gregoire Pau that is available here:
   ///   http://www.ebi.ac.uk/~gpau/misc/dwt97.c
-  class wt_1d_lift : public wt_1d {
+  template <class T>
+  class basic_wt_1d_lift : public basic_wt_1d<T> {
   public: 
-    /// Default Constructor
-    wt_1d_lift() { }
+    /// Default Constructor.  Uses the best lifting kernels for this CPU.
+    basic_wt_1d_lift() : kernels_(&simd::get_lift_kernels<T>()) { 
+      set_scheme<cdf97>();
+    }
     
     /// Destructor
-    virtual ~wt_1d_lift() { }
+    virtual ~basic_wt_1d_lift() { }
 
     /// Foward transform for raw contiguous data.
-    virtual void fwt_1d_single(double *data, size_t n);
+    virtual void fwt_1d_single(T *data, size_t n);
 
     /// Inverse transform for raw contiguous data.
-    virtual void iwt_1d_single(double *data, size_t n);
+    virtual void iwt_1d_single(T *data, size_t n);
+
+    /// Instruction set used by this transform's lifting kernels.
+    simd::isa_t isa() const { return kernels_->isa; }
+
+    /// Use kernels for a particular instruction set.  If the CPU does not support
+    /// it, the best supported set is used instead.
+    void set_isa(simd::isa_t isa) { kernels_ = &simd::get_lift_kernels<T>(isa); }
+
+    /// Use lifting scheme S for subsequent transforms, e.g. set_scheme<cdf53>().
+    /// Shorthand for set_scheme(lift_scheme::of<S>()); built-in and runtime schemes
+    /// run through the same sweeps.
+    template <class S>
+    void set_scheme() {
+      set_scheme(lift_scheme::of<S>());
+    }
+
+    /// Use a lifting scheme built at runtime, e.g. one from factor_lifting().
+    void set_scheme(const lift_scheme& scheme) {
+      scheme_ = scheme;
+      fwt_done_ = step_lags(scheme_, fwt_lag_, false);
+      iwt_done_ = step_lags(scheme_, iwt_lag_, true);
+    }
+
+    /// The lifting scheme in use.
+    const lift_scheme& scheme() const { return scheme_; }
+
+    /// Name of the lifting scheme in use.
+    const char *scheme_name() const { return scheme_.name(); }
 
   protected:
-    /// temporary storage for packing
-    std::vector<double> temp_;
-  }; // wt_1d_lift
+    /// Forward transform of w adjacent signals of length n in one fused sweep.
+    /// Sample i of signal j is at data[i*stride + j].  For odd n the low band gets
+    /// the extra value, and signals shorter than 2 are left as is.  All lifting steps are
+    /// applied block by block, so each block is read from memory once.  The low 
+    /// band is written straight back to data; the high band is lifted in the
+    /// calling thread's scratch space and copied back at the end.
+    void fwt_sweep(T *data, size_t n, size_t stride, size_t w);
+
+    /// Inverse of fwt_sweep().  The low band is unscaled into scratch space first;
+    /// the interleaved output is written straight back to data.
+    void iwt_sweep(T *data, size_t n, size_t stride, size_t w);
+
+    /// Receives blocks of line pairs from fwt_lines() and iwt_lines(), so that other
+    /// work can be done on lines while they are in cache.
+    struct line_hook {
+      virtual ~line_hook() { }
+
+      /// Called with pairs [lo, hi) just before fwt_lines() lifts them, or just 
+      /// after iwt_lines() finishes them.  Pair i is lines 2i and 2i+1; the last 
+      /// pair of an odd number of lines has only line 2i.
+      virtual void lines(size_t lo, size_t hi) = 0;
+    };
+
+    /// Forward transform of w adjacent signals in place, without splitting.  
+    /// Sample i of the signals is the line at data + i*stride, w values long, for
+    /// i in [0, n), and n is at least 2.  The low band is left in the even lines
+    /// and the high band in the odd lines.  Blocks of line pairs are lifted as 
+    /// they are handed to hook, and the columns of each block are divided among 
+    /// up to <threads> threads.
+    void fwt_lines(T *data, size_t n, size_t stride, size_t w, line_hook& hook, 
+                   size_t threads);
+
+    /// Inverse of fwt_lines().
+    void iwt_lines(T *data, size_t n, size_t stride, size_t w, line_hook& hook, 
+                   size_t threads);
+
+    /// Arguments for lifting one chunk of columns in fwt_lines() and iwt_lines().
+    struct lines_chunk;
+
+    /// Lifts chunk c of a block of lines; a parallel_for() body.
+    template <bool Inverse> 
+    static void lift_chunk(size_t c, void *chunk);
+
+    /// Values per band processed in each block of the sweeps.  A block is small 
+    /// enough that it stays in L1 cache while all lifting steps run on it.
+    static const size_t block_values = 1024;
+
+    /// Values in each block of lines processed by fwt_lines() and iwt_lines().  A
+    /// block is small enough to stay in L2 cache while it is row transformed and
+    /// lifted.
+    static const size_t line_block_values = 1 << 16;
+
+    /// Rows of one band, starting at pair index base.  Each row is w values wide,
+    /// and rows are <stride> values apart.
+    struct band {
+      T *data;
+      size_t base;
+      size_t w;
+      size_t stride;
+
+      band(T *d, size_t b, size_t width) 
+        : data(d), base(b), w(width), stride(width) { }
+      band(T *d, size_t b, size_t width, size_t row_stride) 
+        : data(d), base(b), w(width), stride(row_stride) { }
+      T *row(size_t i) const { return data + (i - base) * stride; }
+    };
+
+    /// Lifts <rows> rows of w values, <stride> values apart.  Contiguous rows are
+    /// lifted with one kernel call.
+    static void lift_rows(const simd::lift_kernels<T>& k, T *dest, const T *x, const T *y, 
+                          T a, size_t rows, size_t stride, size_t w) {
+      if (stride == w) {
+        k.lift(dest, x, y, a, rows * w);
+      } else {
+        for (size_t r=0; r < rows; r++) {
+          k.lift(dest + r*stride, x + r*stride, y + r*stride, a, w);
+        }
+      }
+    }
+
+    /// Applies lifting step <type> with coefficient a to pairs [lo, hi) of a 
+    /// signal with h low values and hd high values.  For odd lengths hd is h-1,
+    /// and the last pair is a lone low value.  When rows are contiguous, each step 
+    /// is one unit-stride kernel call for all rows and lanes.
+    static void lift_step(const simd::lift_kernels<T>& k, lift_step_t type, T a,
+                          const band& s, const band& d, size_t lo, size_t hi, 
+                          size_t h, size_t hd);
+
+    /// Fills lag[k] with the number of pairs that step k of a scheme trails the 
+    /// newest split pair by, when steps run in order (forward) or reverse order 
+    /// (inverse).  Returns the largest lag.
+    static size_t step_lags(const lift_scheme& scheme, std::vector<size_t>& lag, 
+                            bool inverse);
+
+    /// Index of the pair <lag> pairs before <i>, or 0.
+    static size_t behind(size_t i, size_t lag) { 
+      return (i > lag) ? i - lag : 0; 
+    }
+
+    /// Runs all steps of a scheme on one block of pairs, [start, end).  Each step 
+    /// runs as far as the steps before it allow; lag comes from step_lags().
+    static void lift_steps(const simd::lift_kernels<T>& k, const lift_scheme& scheme,
+                           const band& s, const band& d, const std::vector<size_t>& lag, 
+                           size_t start, size_t end, size_t h, size_t hd) {
+      for (int j=0; j < scheme.steps(); j++) {
+        lift_step(k, scheme.type(j), T(scheme.coeff(j)), s, d, 
+                  behind(start, lag[j]), (end == h) ? h : end - lag[j], h, hd);
+      }
+    }
+
+    /// Undoes all steps of a scheme, last step first, on one block of pairs.
+    static void unlift_steps(const simd::lift_kernels<T>& k, const lift_scheme& scheme,
+                             const band& s, const band& d, const std::vector<size_t>& lag, 
+                             size_t start, size_t end, size_t h, size_t hd) {
+      for (int j=scheme.steps()-1; j >= 0; j--) {
+        lift_step(k, scheme.type(j), T(-scheme.coeff(j)), s, d, 
+                  behind(start, lag[j]), (end == h) ? h : end - lag[j], h, hd);
+      }
+    }
+
+    /// Receives finished pairs from a line_stream.
+    struct stream_hook {
+      virtual ~stream_hook() { }
+
+      /// Called with pair i of a stream once no lifting step will read it again.
+      /// low and high are its lines, scaled, and may be modified.  high is null 
+      /// for the lone low line at the end of an odd-length signal.
+      virtual void pair(size_t i, T *low, T *high) = 0;
+    };
+
+    /// State of a forward transform of n lines of w values that arrive one at a 
+    /// time, e.g. rows of a matrix read from a file.  Only a window of a few pairs
+    /// per band is kept: enough for the lifting steps to reach back to.  Results
+    /// are the same as fwt_lines() on all n lines at once.
+    ///
+    /// If the length isn't known yet, n is unbounded_stream.  Pairs finished so 
+    /// far are then the same for any length, and finish_stream() ends the signal
+    /// at the lines received.  Copies of a stream are independent, so a copy can 
+    /// be finished while the original goes on.
+    struct line_stream {
+      size_t n;                ///< lines in the signal
+      size_t w;                ///< values per line
+      size_t h, hd;            ///< low and high lines
+      size_t count;            ///< lines received so far
+      size_t start;            ///< first pair not yet lifted
+      size_t block;            ///< pairs lifted together
+      std::vector<T> temp;     ///< windows of the two bands
+      band s, d;               ///< windows of the low and high bands
+
+      line_stream() : n(0), w(0), h(0), hd(0), count(0), start(0), block(0), 
+                      s(0, 0, 0), d(0, 0, 0) { }
+
+      line_stream(const line_stream& other) : s(0, 0, 0), d(0, 0, 0) { *this = other; }
+
+      /// Copies other, with windows pointing into this stream's copy of temp.
+      line_stream& operator=(const line_stream& other) {
+        n = other.n;  w = other.w;  h = other.h;  hd = other.hd;
+        count = other.count;  start = other.start;  block = other.block;
+        temp = other.temp;
+        s = other.s;
+        d = other.d;
+        if (!temp.empty()) {
+          s.data = &temp[0] + (other.s.data - &other.temp[0]);
+          d.data = &temp[0] + (other.d.data - &other.temp[0]);
+        }
+        return *this;
+      }
+    };
+
+    /// Length of a line_stream whose end isn't known yet.
+    static const size_t unbounded_stream = size_t(-1) >> 2;
+
+    /// Starts a stream of n lines of w values with the current scheme.
+    void start_stream(line_stream& ls, size_t n, size_t w) const;
+
+    /// Where the caller writes the next line of a stream, before push_line().
+    static T *next_line(line_stream& ls) {
+      return ((ls.count & 1) ? ls.d : ls.s).row(ls.count >> 1);
+    }
+
+    /// Adds the line written at next_line() to a stream, lifts whatever pairs that
+    /// completes, and hands the pairs that are finished to hook, in order.  A 
+    /// stream of one line passes it to hook as is.
+    void push_line(line_stream& ls, stream_hook& hook) const;
+
+    /// Ends a stream at the lines received so far, lifts the rest of it with the 
+    /// boundary at its end, and hands the remaining pairs to hook.
+    void finish_stream(line_stream& ls, stream_hook& hook) const;
+
+    /// Lifts pairs of a stream up to end, and hands off those that are finished.
+    void lift_stream(line_stream& ls, size_t end, stream_hook& hook) const;
+
+    /// Lifting scheme in use
+    lift_scheme scheme_;
+
+    /// Step lags of scheme_ for the forward and inverse transforms; see step_lags().
+    std::vector<size_t> fwt_lag_, iwt_lag_;
+
+    /// Largest forward and inverse lags, i.e. pairs behind that are finished.
+    size_t fwt_done_, iwt_done_;
+
+    /// kernels for the lifting steps
+    const simd::lift_kernels<T> *kernels_;
+
+    /// temporary storage for one band and a window of the other
+    scratch_space<T> temps_;
+
+    /// Scratch space for the calling thread.
+    std::vector<T>& scratch() { return temps_.get(); }
+  }; // basic_wt_1d_lift
+
+  typedef basic_wt_1d_lift<double> wt_1d_lift;
+  typedef basic_wt_1d_lift<float>  wt_1d_lift_f;
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::lift_step(const simd::lift_kernels<T>& k, lift_step_t type, T a,
+                                     const band& s, const band& d, size_t lo, size_t hi, 
+                                     size_t h, size_t hd) {
+    if (lo >= hi) return;
+    const size_t w = s.w;
+    const size_t st = s.stride;
+    T *sp = s.row(lo);
+    T *dp = d.row(lo);
+
+    // Pairs before hd have both values.  A lone low value at the end of an odd 
+    // signal reads the high value before it in place of the missing one after it.
+    const bool lone = (hi == h && hd < h);
+    size_t count = std::min(hi, hd) - lo;
+
+    switch (type) {
+    case PREDICT_1:
+      // a * x == (a/2) * (x + x) exactly, so one-tap steps use the same kernel.
+      lift_rows(k, dp, sp, sp, a/2, count, st, w);
+      break;
+    case UPDATE_1:
+      if (lone) k.lift(s.row(hd), d.row(hd-1), d.row(hd-1), a/2, w);
+      lift_rows(k, sp, dp, dp, a/2, count, st, w);
+      break;
+    case PREDICT_2:
+      if (hi == h && hd == h) {  // last pair is mirrored
+        count--;
+        k.lift(dp + count*st, sp + count*st, sp + count*st, a, w);
+      }
+      lift_rows(k, dp, sp, sp + st, a, count, st, w);
+      break;
+    case UPDATE_2:
+      if (lone) k.lift(s.row(hd), d.row(hd-1), d.row(hd-1), a, w);
+      if (lo == 0) {           // first pair is mirrored
+        k.lift(sp, dp, dp, a, w);
+        sp += st;
+        dp += st;
+        count--;
+      }
+      lift_rows(k, sp, dp - st, dp, a, count, st, w);
+      break;
+    }
+  }
+
+
+  template <class T>
+  size_t basic_wt_1d_lift<T>::step_lags(const lift_scheme& scheme, std::vector<size_t>& lag, 
+                                        bool inverse) {
+    // A step trails the one before it by a pair if it reads a pair ahead, or if
+    // the one before it read a pair behind.  Then no step overwrites a value that
+    // a trailing step has yet to read.  Updates read a pair behind at the lone 
+    // end of an odd-length signal, even with one tap.
+    lag.resize(scheme.steps());
+    size_t l = 0;
+    for (int j=0; j < scheme.steps(); j++) {
+      const int k    = inverse ? scheme.steps() - 1 - j : j;
+      const int prev = inverse ? k + 1 : k - 1;
+      if (scheme.type(k) == PREDICT_2 || (j > 0 && (scheme.type(prev) == UPDATE_2 ||
+                                                    scheme.type(prev) == UPDATE_1))) l++;
+      lag[k] = l;
+    }
+    return l;
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::fwt_sweep(T *data, size_t n, size_t stride, size_t w) {
+    if (n < 2) return;
+    const simd::lift_kernels<T>& k = *kernels_;
+    const size_t h  = (n + 1) >> 1;                  // low values, and pairs
+    const size_t hd = n >> 1;                        // high values
+
+    const std::vector<size_t>& lag = fwt_lag_;
+    const size_t done  = fwt_done_;                  // pairs behind that are finished
+    const size_t carry = done + 1;                   // pairs kept for the next block
+    const T low_scale  = T(scheme_.low_scale());
+    const T high_scale = T(1/scheme_.high_scale());
+    const size_t block = std::max(block_values / w, 16 * carry);
+
+    // The high band can't be written straight to its place in data, because that
+    // part of data hasn't been read yet.  It is lifted in temp and copied out at the 
+    // end.  The low band is lifted in a small window and written straight to data.
+    const size_t window = std::min(block + carry, h);
+    std::vector<T>& temp = scratch();
+    if (temp.size() < (h + window) * w) temp.resize((h + window) * w);
+    band d(&temp[0], 0, w);
+    band s(&temp[h * w], 0, w);
+
+    for (size_t start=0; start < h; start += block) {
+      const size_t end = std::min(start + block, h);
+      const bool last = (end == h);
+
+      // Split the next block of pairs.
+      if (w == 1 && stride == 1) {
+        const size_t dend = std::min(end, hd);
+        k.split(s.row(start), d.row(start), data + 2*start, 2*(dend - start));
+        if (dend < end) *s.row(dend) = data[2*dend];
+      } else {
+        for (size_t i=start; i < end; i++) {
+          std::copy(data + (2*i) * stride, data + (2*i) * stride + w, s.row(i));
+          if (i < hd) {
+            std::copy(data + (2*i+1) * stride, data + (2*i+1) * stride + w, d.row(i));
+          }
+        }
+      }
+
+      // Each step runs as far as the steps before it allow.
+      lift_steps(k, scheme_, s, d, lag, start, end, h, hd);
+
+      // Scale finished low band values straight into data.
+      const size_t lo = behind(start, done);
+      const size_t hi = last ? h : end - done;
+      if (w == 1 && stride == 1) {
+        k.scale(data + lo, s.row(lo), low_scale, hi - lo);
+      } else {
+        for (size_t i=lo; i < hi; i++) {
+          k.scale(data + i * stride, s.row(i), low_scale, w);
+        }
+      }
+
+      // Slide the window so that unfinished values are at its start.
+      if (!last) {
+        const size_t next = end - carry;
+        std::copy(s.row(next), s.row(end), s.data);
+        s.base = next;
+      }
+    }
+
+    // Scale and pack the high band.
+    if (w == 1 && stride == 1) {
+      k.scale(data + h, d.data, high_scale, hd);
+    } else {
+      for (size_t i=0; i < hd; i++) {
+        k.scale(data + (h+i) * stride, d.row(i), high_scale, w);
+      }
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::iwt_sweep(T *data, size_t n, size_t stride, size_t w) {
+    if (n < 2) return;
+    const simd::lift_kernels<T>& k = *kernels_;
+    const size_t h  = (n + 1) >> 1;                  // low values, and pairs
+    const size_t hd = n >> 1;                        // high values
+
+    const std::vector<size_t>& lag = iwt_lag_;
+    const size_t done  = iwt_done_;                  // pairs behind that are finished
+    const size_t carry = done + 1;                   // pairs kept for the next block
+    const T low_scale  = T(1/scheme_.low_scale());
+    const T high_scale = T(scheme_.high_scale());
+    const size_t block = std::max(block_values / w, 16 * carry);
+
+    // The interleaved output overwrites the low band before it has all been read,
+    // so the low band is unscaled into temp first.  The high band is unscaled into
+    // a small window block by block.
+    const size_t window = std::min(block + carry, h);
+    std::vector<T>& temp = scratch();
+    if (temp.size() < (h + window) * w) temp.resize((h + window) * w);
+    band s(&temp[0], 0, w);
+    band d(&temp[h * w], 0, w);
+
+    if (w == 1 && stride == 1) {
+      k.scale(s.data, data, low_scale, h);
+    } else {
+      for (size_t i=0; i < h; i++) {
+        k.scale(s.row(i), data + i * stride, low_scale, w);
+      }
+    }
+
+    for (size_t start=0; start < h; start += block) {
+      const size_t end = std::min(start + block, h);
+      const bool last = (end == h);
+
+      // Unscale the next block of the high band.
+      if (w == 1 && stride == 1) {
+        k.scale(d.row(start), data + h + start, high_scale, std::min(end, hd) - start);
+      } else {
+        for (size_t i=start; i < std::min(end, hd); i++) {
+          k.scale(d.row(i), data + (h+i) * stride, high_scale, w);
+        }
+      }
+
+      // Undo steps in reverse order, each as far as the steps before it allow.
+      unlift_steps(k, scheme_, s, d, lag, start, end, h, hd);
+
+      // Interleave finished values straight into data.
+      const size_t lo = behind(start, done);
+      const size_t hi = last ? h : end - done;
+      if (w == 1 && stride == 1) {
+        const size_t dhi = std::min(hi, hd);
+        k.merge(data + 2*lo, s.row(lo), d.row(lo), 2*(dhi - lo));
+        if (dhi < hi) data[2*dhi] = *s.row(dhi);
+      } else {
+        for (size_t i=lo; i < hi; i++) {
+          std::copy(s.row(i), s.row(i) + w, data + (2*i) * stride);
+          if (i < hd) {
+            std::copy(d.row(i), d.row(i) + w, data + (2*i+1) * stride);
+          }
+        }
+      }
+
+      // Slide the window so that unfinished values are at its start.
+      if (!last) {
+        const size_t next = end - carry;
+        std::copy(d.row(next), d.row(end), d.data);
+        d.base = next;
+      }
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::start_stream(line_stream& ls, size_t n, size_t w) const {
+    ls.n = n;
+    ls.w = w;
+    ls.h  = (n + 1) >> 1;
+    ls.hd = n >> 1;
+    ls.count = 0;
+    ls.start = 0;
+
+    // the window holds a block of pairs and the pairs before it that steps read.
+    const size_t carry = fwt_done_ + 1;
+    ls.block = 4 * carry;
+    const size_t window = std::max(std::min(ls.block + carry, ls.h), size_t(1));
+    ls.temp.assign(2 * window * w, T());
+    ls.s = band(&ls.temp[0], 0, w);
+    ls.d = band(&ls.temp[window * w], 0, w);
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::push_line(line_stream& ls, stream_hook& hook) const {
+    const size_t i = ls.count++;
+    if (ls.n < 2) {
+      hook.pair(0, ls.s.row(0), 0);
+      return;
+    }
+
+    // lift once a block of pairs is complete, or the signal is.
+    const size_t end = (i >> 1) + 1;
+    const bool last = (ls.count == ls.n);
+    if (!last && (!(i & 1) || end - ls.start < ls.block)) return;
+    lift_stream(ls, end, hook);
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::finish_stream(line_stream& ls, stream_hook& hook) const {
+    if (ls.n == ls.count) return;    // already finished
+    ls.n  = ls.count;
+    ls.h  = (ls.n + 1) >> 1;
+    ls.hd = ls.n >> 1;
+
+    if (ls.n == 1) {
+      hook.pair(0, ls.s.row(0), 0);
+    } else if (ls.n > 1) {
+      lift_stream(ls, ls.h, hook);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::lift_stream(line_stream& ls, size_t end, stream_hook& hook) const {
+    const bool last = (end == ls.h);
+    const simd::lift_kernels<T>& k = *kernels_;
+    lift_steps(k, scheme_, ls.s, ls.d, fwt_lag_, ls.start, end, ls.h, ls.hd);
+
+    // scale and hand off the pairs that no step will read again.
+    const size_t carry = fwt_done_ + 1;
+    const size_t lo = behind(ls.start, carry);
+    const size_t hi = last ? ls.h : end - carry;
+    for (size_t p=lo; p < hi; p++) {
+      T *low  = ls.s.row(p);
+      T *high = (p < ls.hd) ? ls.d.row(p) : 0;
+      k.scale(low, low, T(scheme_.low_scale()), ls.w);
+      if (high) k.scale(high, high, T(1/scheme_.high_scale()), ls.w);
+      hook.pair(p, low, high);
+    }
+    ls.start = end;
+
+    // Slide the windows so that unfinished pairs are at their start.
+    if (!last) {
+      std::copy(ls.s.row(hi), ls.s.row(end), ls.s.data);
+      std::copy(ls.d.row(hi), ls.d.row(end), ls.d.data);
+      ls.s.base = ls.d.base = hi;
+    }
+  }
+
+
+  template <class T>
+  struct basic_wt_1d_lift<T>::lines_chunk {
+    const simd::lift_kernels<T> *k;
+    const lift_scheme *scheme;        ///< scheme to lift with
+    T *data;                          ///< first line
+    size_t stride;                    ///< values between lines
+    size_t w;                         ///< values per line
+    size_t chunk;                     ///< columns per chunk
+    const std::vector<size_t> *lag;   ///< lags of the scheme's steps
+    size_t carry;                     ///< pairs behind the newest that later steps may read
+    size_t start, end, h;             ///< block being lifted, and total pairs
+    size_t hd;                        ///< pairs with a high line
+  };
+
+
+  template <class T>
+  template <bool Inverse>
+  void basic_wt_1d_lift<T>::lift_chunk(size_t c, void *arg) {
+    const lines_chunk& b = *static_cast<lines_chunk*>(arg);
+    const simd::lift_kernels<T>& k = *b.k;
+    const lift_scheme& scheme = *b.scheme;
+    const size_t c0 = c * b.chunk;
+    const size_t w  = std::min(b.chunk, b.w - c0);
+    band s(b.data + c0,            0, w, 2 * b.stride);
+    band d(b.data + c0 + b.stride, 0, w, 2 * b.stride);
+
+    if (Inverse) {
+      // Unscale the block, then undo steps in reverse order.
+      for (size_t i=b.start; i < b.end; i++) {
+        k.scale(s.row(i), s.row(i), T(1/scheme.low_scale()), w);
+        if (i < b.hd) k.scale(d.row(i), d.row(i), T(scheme.high_scale()), w);
+      }
+      unlift_steps(k, scheme, s, d, *b.lag, b.start, b.end, b.h, b.hd);
+
+    } else {
+      // Lift the block, then scale the pairs that no step will read again.
+      lift_steps(k, scheme, s, d, *b.lag, b.start, b.end, b.h, b.hd);
+      const size_t hi = (b.end == b.h) ? b.h : b.end - b.carry;
+      for (size_t i=behind(b.start, b.carry); i < hi; i++) {
+        k.scale(s.row(i), s.row(i), T(scheme.low_scale()), w);
+        if (i < b.hd) k.scale(d.row(i), d.row(i), T(1/scheme.high_scale()), w);
+      }
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::fwt_lines(T *data, size_t n, size_t stride, size_t w,
+                                       line_hook& hook, size_t threads) {
+    lines_chunk b;
+    b.k = kernels_;
+    b.scheme = &scheme_;
+    b.data = data;
+    b.stride = stride;
+    b.w = w;
+    b.lag = &fwt_lag_;
+    b.carry = fwt_done_ + 1;
+    b.h  = (n + 1) >> 1;
+    b.hd = n >> 1;
+    const size_t h = b.h;
+
+    // Split columns among threads in whole cache lines.
+    const size_t line = 64 / sizeof(T);
+    b.chunk = ((w + threads - 1) / threads + line - 1) / line * line;
+    const size_t chunks = (w + b.chunk - 1) / b.chunk;
+    const size_t block = std::max(line_block_values / (2 * w), 4 * b.carry);
+
+    for (b.start=0; b.start < h; b.start += block) {
+      b.end = std::min(b.start + block, h);
+      hook.lines(b.start, b.end);
+      parallel_for(chunks, threads, &lift_chunk<false>, &b);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_lift<T>::iwt_lines(T *data, size_t n, size_t stride, size_t w,
+                                       line_hook& hook, size_t threads) {
+    lines_chunk b;
+    b.k = kernels_;
+    b.scheme = &scheme_;
+    b.data = data;
+    b.stride = stride;
+    b.w = w;
+    b.lag = &iwt_lag_;
+    b.carry = iwt_done_ + 1;
+    b.h  = (n + 1) >> 1;
+    b.hd = n >> 1;
+    const size_t h = b.h;
+
+    const size_t line = 64 / sizeof(T);
+    b.chunk = ((w + threads - 1) / threads + line - 1) / line * line;
+    const size_t chunks = (w + b.chunk - 1) / b.chunk;
+    const size_t block = std::max(line_block_values / (2 * w), 4 * b.carry);
+
+    for (b.start=0; b.start < h; b.start += block) {
+      b.end = std::min(b.start + block, h);
+      parallel_for(chunks, threads, &lift_chunk<true>, &b);
+
+      // Pairs that no step will read again are finished.
+      hook.lines(behind(b.start, b.carry), (b.end == h) ? h : b.end - b.carry);
+    }
+  }
 
 } // namespace nami
 
@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cassert>
+
+#include "wt_1d_stream.h"
+#include "two_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  template <class T>
+  void basic_coeff_vector<T>::begin(int levels) {
+    levels_ = levels;
+    bands_.assign(levels + 1, vector<T>());
+    data_.clear();
+  }
+
+
+  template <class T>
+  void basic_coeff_vector<T>::put(int band, size_t i, T value) {
+    assert(i == bands_[band].size());
+    (void)i;   // coefficients arrive in order; i is only checked
+    bands_[band].push_back(value);
+  }
+
+
+  template <class T>
+  void basic_coeff_vector<T>::end(size_t n) {
+    // the low band comes first, then the high bands from coarsest to finest.
+    data_.clear();
+    data_.reserve(n);
+    for (int b=levels_; b >= 0; b--) {
+      data_.insert(data_.end(), bands_[b].begin(), bands_[b].end());
+      vector<T>().swap(bands_[b]);
+    }
+    assert(data_.size() == n);
+  }
+
+
+  template <class T>
+  basic_wt_1d_stream<T>::basic_wt_1d_stream() : size_(0), sink_(0) { }
+
+
+  template <class T>
+  basic_wt_1d_stream<T>::~basic_wt_1d_stream() { }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::start(basic_coeff_sink<T>& sink, int levels) {
+    assert(levels >= 0);
+    size_ = 0;
+    sink_ = &sink;
+
+    streams_.resize(levels);
+    hooks_.clear();
+    for (int i=0; i < levels; i++) {
+      this->start_stream(streams_[i], this->unbounded_stream, 1);
+      hooks_.push_back(level_hook(this, i));
+    }
+    sink_->begin(levels);
+  }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::push(T value) {
+    if (streams_.empty()) {
+      sink_->put(0, size_, value);
+    } else {
+      push(0, value);
+    }
+    size_++;
+  }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::push(const T *values, size_t n) {
+    for (size_t i=0; i < n; i++) {
+      push(values[i]);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::push(int level, T value) {
+    line_stream& ls = streams_[level];
+    *this->next_line(ls) = value;
+    this->push_line(ls, hooks_[level]);
+  }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::pair_done(int level, size_t i, T *low, T *high) {
+    if (high) {
+      sink_->put(level, i, *high);
+    }
+    if (level + 1 < (int)streams_.size()) {
+      push(level + 1, *low);
+    } else {
+      sink_->put(level + 1, i, *low);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_1d_stream<T>::finish() {
+    // each level's last pairs feed the next level, so finish them in order.
+    for (size_t i=0; i < streams_.size(); i++) {
+      this->finish_stream(streams_[i], hooks_[i]);
+    }
+    sink_->end(size_);
+  }
+
+
+  template class basic_coeff_vector<double>;
+  template class basic_coeff_vector<float>;
+  template class basic_wt_1d_stream<double>;
+  template class basic_wt_1d_stream<float>;
+
+} // namespace nami
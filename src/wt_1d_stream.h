@@ -0,0 +1,163 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_1D_STREAM_H
+#define WT_1D_STREAM_H
+
+#include <vector>
+
+#include "wt_1d_lift.h"
+
+namespace nami {
+
+  /// Receives the coefficients of a 1d transform one at a time, e.g. from 
+  /// basic_wt_1d_stream.  Band b < levels holds the high coefficients of level b,
+  /// finest first, and band <levels> the low coefficients left after the last 
+  /// level.  Each band's coefficients arrive in order, but bands interleave.
+  template <class T>
+  struct basic_coeff_sink {
+    virtual ~basic_coeff_sink() { }
+
+    /// Called before any coefficients, with the levels of the transform.
+    virtual void begin(int) { }
+
+    /// Called with coefficient i of band.
+    virtual void put(int band, size_t i, T value) = 0;
+
+    /// Called after all coefficients of a signal of length n.
+    virtual void end(size_t) { }
+  };
+
+
+  /// Collects the coefficients of a whole signal, and lays them out as 
+  /// wt_1d::fwt_1d() does once the signal ends, e.g. for wt_1d::iwt_1d().
+  template <class T>
+  class basic_coeff_vector : public basic_coeff_sink<T> {
+  public:
+    basic_coeff_vector() : levels_(0) { }
+
+    virtual void begin(int levels);
+    virtual void put(int band, size_t i, T value);
+    virtual void end(size_t n);
+
+    /// Levels of the transform received.
+    int levels() const { return levels_; }
+
+    /// Coefficients of the signal, valid after end().
+    std::vector<T>& data() { return data_; }
+
+  private:
+    int levels_;
+    std::vector<std::vector<T> > bands_;
+    std::vector<T> data_;
+  };
+
+
+  /// Forward 1d transform of a signal that arrives a sample at a time, and whose
+  /// length isn't known until it ends, e.g. a timeline recorded by each rank:
+  ///
+  ///   wt_1d_stream wt;
+  ///   ezw_stream_encoder encoder(out);
+  ///   wt.start(encoder, 6);
+  ///   for (each sample) wt.push(sample);
+  ///   wt.finish();
+  ///
+  /// Each level lifts an unbounded line_stream of single values, so a coefficient
+  /// goes to the sink as soon as every sample its lifting steps reach has come in,
+  /// and only a short window per level is kept.  Memory is O(filter length x 
+  /// levels), however long the signal runs.  finish() ends each level with the 
+  /// symmetric boundary at the signal's end.  If the signal has at least 2^levels
+  /// samples, the coefficients are those of wt_lift::fwt_1d() on the whole signal.
+  ///
+  template <class T>
+  class basic_wt_1d_stream : public basic_wt_1d_lift<T> {
+  public:
+    /// Constructor.  Uses CDF 9/7 unless another scheme is chosen with set_scheme().
+    basic_wt_1d_stream();
+
+    /// Destructor
+    virtual ~basic_wt_1d_stream();
+
+    /// Starts transforming a new signal with <levels> levels, into sink, which
+    /// must outlive the transform.
+    void start(basic_coeff_sink<T>& sink, int levels);
+
+    /// Transforms the next sample of the signal.
+    void push(T value);
+
+    /// Transforms the next n samples of the signal.
+    void push(const T *values, size_t n);
+
+    /// Ends the signal, and sends the rest of its coefficients to the sink.
+    void finish();
+
+    /// Samples pushed so far.
+    size_t size() const { return size_; }
+
+    /// Levels of transform being done.
+    int levels() const { return streams_.size(); }
+
+  protected:
+    typedef typename basic_wt_1d_lift<T>::line_stream line_stream;
+    typedef typename basic_wt_1d_lift<T>::stream_hook stream_hook;
+
+    /// Passes finished pairs of one level to pair_done().
+    struct level_hook : public stream_hook {
+      basic_wt_1d_stream *wt;
+      int level;
+      level_hook(basic_wt_1d_stream *w, int l) : wt(w), level(l) { }
+      void pair(size_t i, T *low, T *high) { wt->pair_done(level, i, low, high); }
+    };
+
+    /// Adds value to the signal of <level>.
+    void push(int level, T value);
+
+    /// Sends the high value of finished pair i of <level> to the sink, and its low
+    /// value on to the next level.
+    void pair_done(int level, size_t i, T *low, T *high);
+
+    size_t size_;                        ///< Samples pushed
+    basic_coeff_sink<T> *sink_;          ///< Destination of coefficients
+    std::vector<line_stream> streams_;   ///< Transform of each level
+    std::vector<level_hook> hooks_;      ///< Hook for each level
+  };
+
+  typedef basic_coeff_sink<double>      coeff_sink;
+  typedef basic_coeff_vector<double>    coeff_vector;
+  typedef basic_wt_1d_stream<double>    wt_1d_stream;
+
+  typedef basic_coeff_sink<float>       coeff_sink_f;
+  typedef basic_coeff_vector<float>     coeff_vector_f;
+  typedef basic_wt_1d_stream<float>     wt_1d_stream_f;
+
+} // namespace nami
+
+#endif // WT_1D_STREAM_H
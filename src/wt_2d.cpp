@@ -32,55 +32,91 @@
 #include <stdint.h>
 #include <climits>
 #include <iostream>
+#include <algorithm>
 
 #include "wt_2d.h"
 #include "two_utils.h"
+#include "thread_utils.h"
 
 using namespace std;
 
 namespace nami {
 
-  int wt_2d::fwt_2d(nami_matrix& mat, int level) {
+  template <class T>
+  int basic_wt_2d<T>::do_fwt_2d(const view_type& mat, int level) {
+    T *data = mat.data();
+    const size_t pitch = mat.pitch();
+    size_t rows = mat.size1();
+    size_t cols = mat.size2();
     if (level < 0) {
-      level = times_divisible_by_2(std::max(mat.size1(), mat.size2()));
+      level = levels_to_one(std::max(rows, cols));
     }
-    assert(level <= times_divisible_by_2(std::max(mat.size1(), mat.size2())));
+    assert(level <= levels_to_one(std::max(rows, cols)));
 
-    size_t rows = mat.size1();
-    size_t cols = mat.size2();
-    for (int i=0; i < level; i++) {
-      if (even(cols)) for (size_t r=0; r < rows; r++) fwt_row(mat, r, cols);
-      if (even(rows)) for (size_t c=0; c < cols; c++) fwt_col(mat, c, rows);
+    const size_t threads = threads_ ? threads_ : default_threads();
+    threaded_pass pass(*this, threads);
 
-      if (even(rows)) rows >>= 1;
-      if (even(cols)) cols >>= 1;
+    for (int i=0; i < level; i++) {
+      const int nthreads = pass_threads(threads, rows, cols);
+      const long panels = (cols + panel_width_ - 1) / panel_width_;
+
+      if (cols > 1) {
+        #pragma omp parallel for num_threads(nthreads) if (nthreads > 1)
+        for (long r=0; r < (long)rows; r++) fwt_row(data + r * pitch, cols);
+      }
+      if (rows > 1) {
+        #pragma omp parallel for num_threads(nthreads) if (nthreads > 1)
+        for (long p=0; p < panels; p++) {
+          const size_t c = p * panel_width_;
+          fwt_cols(data + c, pitch, std::min(panel_width_, cols - c), rows);
+        }
+      }
+
+      rows = low_band_size(rows, 1);
+      cols = low_band_size(cols, 1);
     }
 
     return level;
   }
 
 
-  int wt_2d::iwt_2d(nami_matrix& mat, int fwt_level, int iwt_level) {
+  template <class T>
+  int basic_wt_2d<T>::do_iwt_2d(const view_type& mat, int fwt_level, int iwt_level) {
+    T *data = mat.data();
+    const size_t pitch = mat.pitch();
+    const size_t size1 = mat.size1();
+    const size_t size2 = mat.size2();
     if (fwt_level < 0) {
-      fwt_level = times_divisible_by_2(std::max(mat.size1(), mat.size2()));
+      fwt_level = levels_to_one(std::max(size1, size2));
     }
-    assert(fwt_level <= times_divisible_by_2(std::max(mat.size1(), mat.size2())));
+    assert(fwt_level <= levels_to_one(std::max(size1, size2)));
 
     if (iwt_level < 0) {
       iwt_level = INT_MAX;
     }
 
-    int max_row_shift = times_divisible_by_2(mat.size1());
-    int max_col_shift = times_divisible_by_2(mat.size2());
+    const size_t threads = threads_ ? threads_ : default_threads();
+    threaded_pass pass(*this, threads);
 
     size_t rows, cols;
     int levels = 0;
     for (int i=fwt_level-1; i >= 0 && levels < iwt_level; i--) {
-      rows = mat.size1() >> std::min(i, max_row_shift);
-      cols = mat.size2() >> std::min(i, max_col_shift);
+      rows = low_band_size(size1, i);
+      cols = low_band_size(size2, i);
+      const int nthreads = pass_threads(threads, rows, cols);
+      const long panels = (cols + panel_width_ - 1) / panel_width_;
       
-      if (even(rows)) for (size_t c=0; c < cols; c++) iwt_col(mat, c, rows);
-      if (even(cols)) for (size_t r=0; r < rows; r++) iwt_row(mat, r, cols);
+      if (rows > 1) {
+        #pragma omp parallel for num_threads(nthreads) if (nthreads > 1)
+        for (long p=0; p < panels; p++) {
+          const size_t c = p * panel_width_;
+          iwt_cols(data + c, pitch, std::min(panel_width_, cols - c), rows);
+        }
+      }
+      if (cols > 1) {
+        #pragma omp parallel for num_threads(nthreads) if (nthreads > 1)
+        for (long r=0; r < (long)rows; r++) iwt_row(data + r * pitch, cols);
+      }
 
       levels++;
     }
@@ -89,5 +125,24 @@ namespace nami {
   }
 
 
+  template <class T>
+  void basic_wt_2d<T>::fwt_cols(T *col, size_t pitch, size_t width, size_t n) {
+    for (size_t c=0; c < width; c++) {
+      fwt_col(col + c, pitch, n);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_2d<T>::iwt_cols(T *col, size_t pitch, size_t width, size_t n) {
+    for (size_t c=0; c < width; c++) {
+      iwt_col(col + c, pitch, n);
+    }
+  }
+
+
+  template class basic_wt_2d<double>;
+  template class basic_wt_2d<float>;
+
 } // namespace nami
 	
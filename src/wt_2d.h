@@ -38,25 +38,40 @@ namespace nami {
 
   /// Abstract superclass for transform classes.  Provides methods for 2d transforms.
   /// This allows classes that provide 1d transform implementations to easily export
-  /// a 2d API as well.
-  class wt_2d {
+  /// a 2d API as well.  T is the element type of the matrices transformed (double
+  /// or float); wt_2d and wt_2d_f name the two instantiations.
+  template <class T>
+  class basic_wt_2d {
   public:
+    /// Type of matrix this class transforms.
+    typedef boost::numeric::ublas::matrix<T> matrix_type;
+
+    /// Padded matrix type this class also transforms.
+    typedef basic_padded_matrix<T> padded_type;
+
+    /// View type the transforms take.  matrix_type and padded_type convert to it.
+    typedef basic_matrix_view<T> view_type;
+
     /// Constructor
-    wt_2d() { }
+    basic_wt_2d() : panel_width_(16), threads_(1) { }
 
     /// Destructor
-    virtual ~wt_2d() { }
+    virtual ~basic_wt_2d() { }
 
     ///
     /// Algorithm for forward transform in 2 dimensions.  Applies alternating 1d
     /// transforms for rows and columns.  Returns the number of foward transforms
     /// (levels) that were applied.
-    /// completed.
+    /// completed.  A dimension of length n is transformed at a level as long as n 
+    /// is at least 2; its low band is the first (n+1)/2 values, so any size can be 
+    /// transformed until both dimensions reach 1.
     ///
     /// @param mat          matrix to perform the forward transform on
     /// @param level        level of fwt to apply to them matrix.
     ///
-    virtual int fwt_2d(nami_matrix& mat, int level = -1);
+    int fwt_2d(view_type mat, int level = -1) {
+      return do_fwt_2d(mat, level);
+    }
     
     ///
     /// Algorithm for inverse transform in 2 dimensions.  Applies alternating 1d
@@ -67,45 +82,123 @@ namespace nami {
     /// @param fwt_level    level of the fwt applied to the matrix (default max possible)
     /// @param iwt_level    level of iwt to perform on the matrix. (defaults to fwt_level)
     ///
-    virtual int iwt_2d(nami_matrix& mat, int fwt_level = -1, int iwt_level = -1);
+    int iwt_2d(view_type mat, int fwt_level = -1, int iwt_level = -1) {
+      return do_iwt_2d(mat, fwt_level, iwt_level);
+    }
 
     /// 
     /// Forward wavelet transform for matrix rows.
     /// 
-    /// @param mat  a boost matrix containing the data to be transformed
-    /// @param row  the row to transform
+    /// @param row  first value of the row to transform
     /// @param n    length of the row, starting at 0, to transform
-    ///
-    virtual void fwt_row(nami_matrix& mat, size_t row, size_t n) = 0;
+    /// 
+    virtual void fwt_row(T *row, size_t n) = 0;
 
     ///
     /// Forward wavelet transform for matrix columns.
     /// 
-    /// @param mat  a boost matrix containing the data to be transformed
-    /// @param col  the column to transform
-    /// @param n    length of the column, starting at 0, to transform
+    /// @param col    first value of the column to transform
+    /// @param pitch  values between successive rows of the matrix
+    /// @param n      length of the column, starting at 0, to transform
     /// 
-    virtual void fwt_col(nami_matrix& mat, size_t col, size_t n) = 0;
+    virtual void fwt_col(T *col, size_t pitch, size_t n) = 0;
 
     ///
     /// Inverse transform for matrix rows.
     /// 
-    /// @param mat  a boost matrix containing the data to be transformed
-    /// @param row  the row to transform
+    /// @param row  first value of the row to transform
     /// @param n    length of the row, starting at 0, to transform
     /// 
-    virtual void iwt_row(nami_matrix& mat, size_t row, size_t n) = 0;
+    virtual void iwt_row(T *row, size_t n) = 0;
 
     ///
     /// Inverse transform for matrix columns
     /// 
-    /// @param mat  a boost matrix containing the data to be transformed
-    /// @param col  the column to transform
-    /// @param n    length of the column, starting at 0, to transform
+    /// @param col    first value of the column to transform
+    /// @param pitch  values between successive rows of the matrix
+    /// @param n      length of the column, starting at 0, to transform
+    ///
+    virtual void iwt_col(T *col, size_t pitch, size_t n) = 0;
+
     ///
-    virtual void iwt_col(nami_matrix& mat, size_t col, size_t n) = 0;
+    /// Forward transform for a panel of adjacent matrix columns.  The default 
+    /// implementation calls fwt_col() for each column in the panel.  Subclasses can 
+    /// override this to transform all the panel's columns together, so that each 
+    /// row of the panel is read as one contiguous chunk.
+    /// 
+    /// @param col    first value of the first column of the panel
+    /// @param pitch  values between successive rows of the matrix
+    /// @param width  number of columns in the panel
+    /// @param n      length of the columns, starting at 0, to transform
+    ///
+    virtual void fwt_cols(T *col, size_t pitch, size_t width, size_t n);
+
+    ///
+    /// Inverse transform for a panel of adjacent matrix columns.
+    /// @see fwt_cols()
+    ///
+    virtual void iwt_cols(T *col, size_t pitch, size_t width, size_t n);
+
+    /// Number of adjacent columns transformed together by fwt_2d() and iwt_2d().
+    size_t panel_width() const { return panel_width_; }
+
+    /// Sets number of adjacent columns transformed together.  Must be at least 1.
+    void set_panel_width(size_t width) { panel_width_ = width; }
+
+    /// Number of threads fwt_2d() and iwt_2d() use.  Defaults to 1.
+    size_t threads() const { return threads_; }
+
+    /// Sets number of threads used by fwt_2d() and iwt_2d().  Rows, and panels of 
+    /// columns, are independent within a level, so each level's row and column 
+    /// transforms are divided among threads.  0 uses OpenMP's default thread count.
+    /// Has no effect unless nami was built with OpenMP.
+    void set_threads(size_t threads) { threads_ = threads; }
+
+  protected:
+    size_t panel_width_;   ///< Columns per panel in column transforms.
+    size_t threads_;       ///< Threads for 2d transforms; 0 for the default.
+
+    /// Does the work of fwt_2d().  Subclasses can override this to transform 
+    /// levels differently.
+    virtual int do_fwt_2d(const view_type& mat, int level);
+
+    /// Does the work of iwt_2d().  @see do_fwt_2d()
+    virtual int do_iwt_2d(const view_type& mat, int fwt_level, int iwt_level);
+
+    /// Called by fwt_2d() and iwt_2d() before transforming rows and columns on up
+    /// to <threads> threads at once.  Subclasses that keep scratch space for each 
+    /// thread allocate it here.
+    virtual void prepare_threads(size_t) { }
+
+    /// Called once the threaded transform that prepare_threads() was called for 
+    /// is done.
+    virtual void finish_threads() { }
+
+    /// Calls prepare_threads() when made and finish_threads() when destroyed, 
+    /// around a threaded transform.
+    class threaded_pass {
+    public:
+      threaded_pass(basic_wt_2d& wt, size_t threads) : wt_(wt) { 
+        wt_.prepare_threads(threads); 
+      }
+      ~threaded_pass() { wt_.finish_threads(); }
+    private:
+      basic_wt_2d& wt_;
+    };
+
+    /// Threads to use for a pass over a rows x cols part of the matrix.  Small
+    /// passes (e.g. at high levels) are not worth starting threads for.
+    size_t pass_threads(size_t threads, size_t rows, size_t cols) const {
+      return (rows * cols < min_parallel_values) ? 1 : threads;
+    }
+
+    /// Fewest values in a pass that fwt_2d() and iwt_2d() divide among threads.
+    static const size_t min_parallel_values = 16384;
   };
 
+  typedef basic_wt_2d<double> wt_2d;
+  typedef basic_wt_2d<float>  wt_2d_f;
+
 
 } // namespace
 
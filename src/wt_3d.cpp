@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <climits>
+#include <cassert>
+#include <algorithm>
+
+#include "wt_3d.h"
+#include "two_utils.h"
+
+namespace nami {
+
+  template <class T>
+  int basic_wt_3d<T>::fwt_3d(volume_type vol, int level) {
+    size_t rows   = vol.size1();
+    size_t cols   = vol.size2();
+    size_t frames = vol.size3();
+    const size_t longest = std::max(std::max(rows, cols), frames);
+    if (level < 0) {
+      level = levels_to_one(longest);
+    }
+    assert(level <= levels_to_one(longest));
+
+    for (int i=0; i < level; i++) {
+      if (rows > 1 || cols > 1) {
+        for (size_t f=0; f < frames; f++) {
+          wt_->fwt_2d(basic_matrix_view<T>(vol.data() + f * vol.frame_pitch(), 
+                                           rows, cols, vol.pitch()), 1);
+        }
+      }
+      if (frames > 1) fwt_frames(vol, rows, cols, frames);
+
+      rows   = low_band_size(rows, 1);
+      cols   = low_band_size(cols, 1);
+      frames = low_band_size(frames, 1);
+    }
+
+    return level;
+  }
+
+
+  template <class T>
+  int basic_wt_3d<T>::iwt_3d(volume_type vol, int fwt_level, int iwt_level) {
+    const size_t longest = std::max(std::max(vol.size1(), vol.size2()), vol.size3());
+    if (fwt_level < 0) {
+      fwt_level = levels_to_one(longest);
+    }
+    assert(fwt_level <= levels_to_one(longest));
+
+    if (iwt_level < 0) {
+      iwt_level = INT_MAX;
+    }
+
+    int levels = 0;
+    for (int i=fwt_level-1; i >= 0 && levels < iwt_level; i--) {
+      const size_t rows   = low_band_size(vol.size1(), i);
+      const size_t cols   = low_band_size(vol.size2(), i);
+      const size_t frames = low_band_size(vol.size3(), i);
+
+      if (frames > 1) iwt_frames(vol, rows, cols, frames);
+      if (rows > 1 || cols > 1) {
+        for (size_t f=0; f < frames; f++) {
+          wt_->iwt_2d(basic_matrix_view<T>(vol.data() + f * vol.frame_pitch(), 
+                                           rows, cols, vol.pitch()), 1);
+        }
+      }
+
+      levels++;
+    }
+
+    return levels;
+  }
+
+
+  template <class T>
+  void basic_wt_3d<T>::fwt_frames(const volume_type& vol, size_t rows, size_t cols, size_t n) {
+    // Value (r, c) of successive frames is frame_pitch apart, so a panel of a row
+    // is a panel of columns to the 2d transform's column kernels.
+    const size_t panel = wt_->panel_width();
+    for (size_t r=0; r < rows; r++) {
+      T *row = vol.data() + r * vol.pitch();
+      for (size_t c=0; c < cols; c += panel) {
+        wt_->fwt_cols(row + c, vol.frame_pitch(), std::min(panel, cols - c), n);
+      }
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_3d<T>::iwt_frames(const volume_type& vol, size_t rows, size_t cols, size_t n) {
+    const size_t panel = wt_->panel_width();
+    for (size_t r=0; r < rows; r++) {
+      T *row = vol.data() + r * vol.pitch();
+      for (size_t c=0; c < cols; c += panel) {
+        wt_->iwt_cols(row + c, vol.frame_pitch(), std::min(panel, cols - c), n);
+      }
+    }
+  }
+
+
+  template class basic_wt_3d<double>;
+  template class basic_wt_3d<float>;
+
+} // namespace nami
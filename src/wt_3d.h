@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_3D_H
+#define WT_3D_H
+
+#include "nami_matrix.h"
+#include "wt_2d.h"
+
+namespace nami {
+
+  /// 3d wavelet transform of a volume, e.g. the same matrix at successive timesteps.
+  /// Built on the row and column transforms of a 2d transform, so any of them can 
+  /// be used:
+  ///
+  ///   wt_lift lift;
+  ///   wt_3d wt(lift);
+  ///   int level = wt.fwt_3d(volume_view(mat, frames));
+  ///
+  /// Each level transforms the lowest-frequency cube of the level before it: every
+  /// frame of the cube in 2d with the 2d transform (using its threads), then every
+  /// value of the cube over time.  The result is in the usual order, with the low
+  /// band of each dimension first, so the coarsest subbands form a small cube at
+  /// the origin.  Sizes and levels are handled as in wt_2d, with frames as a third 
+  /// dimension.  The EZW coder codes these volumes with 3d zerotrees.
+  ///
+  template <class T>
+  class basic_wt_3d {
+  public:
+    /// Type of volume this class transforms.
+    typedef basic_volume_view<T> volume_type;
+
+    /// Transforms volumes with the row and column transforms of wt, which must 
+    /// outlive this object.
+    explicit basic_wt_3d(basic_wt_2d<T>& wt) : wt_(&wt) { }
+
+    /// Destructor
+    virtual ~basic_wt_3d() { }
+
+    /// Forward transform in 3 dimensions.  Returns the number of levels applied.
+    /// 
+    /// @param vol     volume to perform the forward transform on
+    /// @param level   level of fwt to apply to the volume (default max possible)
+    /// 
+    int fwt_3d(volume_type vol, int level = -1);
+
+    /// Inverse transform in 3 dimensions.  Returns the number of levels undone.
+    /// 
+    /// @param vol         volume to perform the inverse transform on
+    /// @param fwt_level   level of the fwt applied to the volume (default max possible)
+    /// @param iwt_level   level of iwt to perform on the volume (defaults to fwt_level)
+    /// 
+    int iwt_3d(volume_type vol, int fwt_level = -1, int iwt_level = -1);
+
+    /// The 2d transform whose row and column transforms this uses.
+    basic_wt_2d<T>& transform_2d() const { return *wt_; }
+
+  protected:
+    /// Transforms the first n frames of the rows x cols corner of vol over time.
+    void fwt_frames(const volume_type& vol, size_t rows, size_t cols, size_t n);
+
+    /// Inverse of fwt_frames().
+    void iwt_frames(const volume_type& vol, size_t rows, size_t cols, size_t n);
+
+    basic_wt_2d<T> *wt_;   ///< Transform for rows, columns and frames.
+  };
+
+  typedef basic_wt_3d<double> wt_3d;
+  typedef basic_wt_3d<float>  wt_3d_f;
+
+} // namespace nami
+
+#endif // WT_3D_H
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cassert>
+
+#include "wt_append.h"
+
+using namespace std;
+
+namespace nami {
+
+  template <class T>
+  basic_wt_append<T>::basic_wt_append(size_t cols, int level) 
+    : cols_(cols), rows_(0), level_(level < 0 ? levels_to_one(cols) : level), snap_(0) { }
+
+
+  template <class T>
+  basic_wt_append<T>::~basic_wt_append() { }
+
+
+  template <class T>
+  void basic_wt_append<T>::append_row(const T *row) {
+    if (level_ == 0) {
+      kept_.resize(1);
+      kept_[0].low.insert(kept_[0].low.end(), row, row + cols_);
+      rows_++;
+      return;
+    }
+
+    // start the levels' column transforms with the scheme in use for the first row.
+    if (rows_ == 0) {
+      streams_.resize(level_);
+      kept_.assign(level_, level_rows());
+      keep_.clear();
+      snap_hooks_.clear();
+      for (int i=0; i < level_; i++) {
+        this->start_stream(streams_[i], this->unbounded_stream, low_band_size(cols_, i));
+        keep_.push_back(keep_hook(this, i));
+        snap_hooks_.push_back(snapshot_hook(this, i));
+      }
+    }
+
+    rows_++;
+    push(row, streams_[0], keep_[0]);
+  }
+
+
+  template <class T>
+  void basic_wt_append<T>::push(const T *row, line_stream& ls, stream_hook& hook) {
+    T *line = this->next_line(ls);
+    copy(row, row + ls.w, line);
+    if (ls.w > 1) {
+      this->fwt_1d_single(line, ls.w);
+    }
+    this->push_line(ls, hook);
+  }
+
+
+  template <class T>
+  void basic_wt_append<T>::keep_pair(int level, T *low, T *high) {
+    const size_t cols = streams_[level].w;
+    level_rows& kept = kept_[level];
+
+    if (level + 1 < level_) {
+      const size_t low_cols = low_band_size(cols, 1);
+      kept.detail.insert(kept.detail.end(), low + low_cols, low + cols);
+      push(low, streams_[level + 1], keep_[level + 1]);
+    } else {
+      kept.low.insert(kept.low.end(), low, low + cols);
+    }
+    if (high) {
+      kept.high.insert(kept.high.end(), high, high + cols);
+    }
+  }
+
+
+  template <class T>
+  int basic_wt_append<T>::snapshot(basic_matrix_view<T> mat) {
+    assert(mat.size1() == rows_ && mat.size2() == cols_);
+    assert(level_ <= levels_to_one(max(rows_, cols_)));
+    if (rows_ == 0) return level_;
+
+    if (level_ == 0) {
+      for (size_t r=0; r < rows_; r++) {
+        copy(&kept_[0].low[r * cols_], &kept_[0].low[(r+1) * cols_], mat.data() + r * mat.pitch());
+      }
+      return level_;
+    }
+
+    // put the finished coefficients in place.
+    for (int i=0; i < level_; i++) {
+      const size_t cols = low_band_size(cols_, i);
+      const size_t low_cols = low_band_size(cols_, i+1);
+      const level_rows& kept = kept_[i];
+
+      for (size_t k=0; k < kept.high.size() / cols; k++) {
+        copy(&kept.high[k * cols], &kept.high[(k+1) * cols], 
+             mat.data() + high_row(i, k) * mat.pitch());
+      }
+      const size_t detail_cols = cols - low_cols;
+      for (size_t k=0; detail_cols && k < kept.detail.size() / detail_cols; k++) {
+        copy(&kept.detail[k * detail_cols], &kept.detail[(k+1) * detail_cols], 
+             mat.data() + k * mat.pitch() + low_cols);
+      }
+      for (size_t k=0; k < kept.low.size() / cols; k++) {
+        copy(&kept.low[k * cols], &kept.low[(k+1) * cols], mat.data() + k * mat.pitch());
+      }
+    }
+
+    // finish copies of the column transforms at the current length; each level's 
+    // last low rows go on to the next level's copy before it is finished.
+    copies_ = streams_;
+    snap_ = &mat;
+    for (int i=0; i < level_; i++) {
+      this->finish_stream(copies_[i], snap_hooks_[i]);
+    }
+    snap_ = 0;
+    return level_;
+  }
+
+
+  template <class T>
+  int basic_wt_append<T>::snapshot(boost::numeric::ublas::matrix<T>& mat) {
+    mat.resize(rows_, cols_, false);
+    return snapshot(basic_matrix_view<T>(mat));
+  }
+
+
+  template <class T>
+  void basic_wt_append<T>::snapshot_pair(int level, size_t i, T *low, T *high) {
+    const size_t cols = copies_[level].w;
+    basic_matrix_view<T>& mat = *snap_;
+
+    if (level + 1 < level_) {
+      const size_t low_cols = low_band_size(cols, 1);
+      copy(low + low_cols, low + cols, mat.data() + i * mat.pitch() + low_cols);
+      push(low, copies_[level + 1], snap_hooks_[level + 1]);
+    } else {
+      copy(low, low + cols, mat.data() + i * mat.pitch());
+    }
+    if (high) {
+      copy(high, high + cols, mat.data() + high_row(level, i) * mat.pitch());
+    }
+  }
+
+
+  template class basic_wt_append<double>;
+  template class basic_wt_append<float>;
+
+} // namespace nami
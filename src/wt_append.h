@@ -0,0 +1,156 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_APPEND_H
+#define WT_APPEND_H
+
+#include <vector>
+
+#include "nami_matrix.h"
+#include "wt_1d_lift.h"
+#include "two_utils.h"
+
+namespace nami {
+
+  /// Incremental 2d forward transform of a matrix that grows by a row at a time,
+  /// e.g. a metric per rank recorded at each timestep:
+  ///
+  ///   wt_append wt(ranks);
+  ///   for (each timestep) {
+  ///     wt.append_row(values);
+  ///     int level = wt.snapshot(mat);      // same as wt_lift::fwt_2d() on the history
+  ///     encoder.encode(mat, out, level);
+  ///   }
+  ///
+  /// Each level lifts its columns as a line_stream of unknown length, so 
+  /// coefficients that no longer depend on where the matrix ends are computed 
+  /// once, as their rows arrive, and kept.  A snapshot copies the few rows per 
+  /// level still in the lifting windows, finishes the copies at the current 
+  /// length, and puts the kept coefficients around them in the usual order.  The
+  /// transform work per row is the same as for a whole matrix; a snapshot adds 
+  /// about the filter length in rows per level, plus copying out the kept ones.
+  ///
+  template <class T>
+  class basic_wt_append : public basic_wt_1d_lift<T> {
+  public:
+    /// Constructs a transform for rows of <cols> values, with <level> levels (by
+    /// default the most possible for the row length).  Deeper levels need enough
+    /// rows for wt_2d::fwt_2d() to allow them before a snapshot can be taken.
+    /// Uses CDF 9/7 unless another scheme is chosen with set_scheme() before the
+    /// first row is appended.
+    explicit basic_wt_append(size_t cols, int level = -1);
+
+    /// Destructor
+    virtual ~basic_wt_append();
+
+    /// Adds a row of cols() values at the bottom of the matrix.
+    void append_row(const T *row);
+
+    /// Rows appended so far.
+    size_t rows() const { return rows_; }
+
+    /// Length of the rows.
+    size_t cols() const { return cols_; }
+
+    /// Levels of transform done.
+    int level() const { return level_; }
+
+    /// Writes the transform of the rows so far to mat, which must be rows() x 
+    /// cols().  The coefficients are those of wt_lift::fwt_2d() on the matrix of
+    /// appended rows, with level() levels.  Returns level().
+    int snapshot(basic_matrix_view<T> mat);
+
+    /// Resizes mat to rows() x cols() and writes the transform of the rows so far.
+    int snapshot(boost::numeric::ublas::matrix<T>& mat);
+
+  protected:
+    typedef typename basic_wt_1d_lift<T>::line_stream line_stream;
+    typedef typename basic_wt_1d_lift<T>::stream_hook stream_hook;
+
+    /// Coefficients of one level that are finished for good.
+    struct level_rows {
+      std::vector<T> high;     ///< finished high rows
+      std::vector<T> detail;   ///< high-column parts of finished low rows
+      std::vector<T> low;      ///< finished low rows, for the last level only
+    };
+
+    /// Keeps finished pairs of a level's unbounded column transform.
+    struct keep_hook : public stream_hook {
+      basic_wt_append *wt;
+      int level;
+      keep_hook(basic_wt_append *w, int l) : wt(w), level(l) { }
+      void pair(size_t, T *low, T *high) { wt->keep_pair(level, low, high); }
+    };
+
+    /// Writes pairs of finished copies of the levels' column transforms to the 
+    /// snapshot being taken.
+    struct snapshot_hook : public stream_hook {
+      basic_wt_append *wt;
+      int level;
+      snapshot_hook(basic_wt_append *w, int l) : wt(w), level(l) { }
+      void pair(size_t i, T *low, T *high) { wt->snapshot_pair(level, i, low, high); }
+    };
+
+    /// Row transforms row, the next row of a level, and adds it to ls, that 
+    /// level's column transform.
+    void push(const T *row, line_stream& ls, stream_hook& hook);
+
+    /// Keeps the next finished pair of <level>, and passes the low part of its low
+    /// row on.
+    void keep_pair(int level, T *low, T *high);
+
+    /// Writes pair i of <level> to its place in the snapshot, and passes the low 
+    /// part of its low row on to the next level's copy.
+    void snapshot_pair(int level, size_t i, T *low, T *high);
+
+    /// Row of the snapshot that holds high row i of <level>.
+    size_t high_row(int level, size_t i) const {
+      return low_band_size(rows_, level + 1) + i;
+    }
+
+    size_t cols_;                            ///< Length of rows
+    size_t rows_;                            ///< Rows appended
+    int level_;                              ///< Levels of transform
+    std::vector<line_stream> streams_;       ///< Unbounded column transform of each level
+    std::vector<keep_hook> keep_;            ///< Hooks that keep finished pairs
+    std::vector<level_rows> kept_;           ///< Finished coefficients of each level
+
+    std::vector<line_stream> copies_;        ///< Copies of streams_ finished by snapshot()
+    std::vector<snapshot_hook> snap_hooks_;  ///< Hooks for copies_
+    basic_matrix_view<T> *snap_;             ///< Snapshot being taken
+  };
+
+  typedef basic_wt_append<double> wt_append;
+  typedef basic_wt_append<float>  wt_append_f;
+
+} // namespace nami
+
+#endif // WT_APPEND_H
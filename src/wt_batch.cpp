@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <climits>
+#include <cassert>
+
+#include "wt_batch.h"
+#include "two_utils.h"
+#include "thread_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  template <class T>
+  basic_wt_batch<T>::basic_wt_batch() : threads_(1), group_size_(0) { }
+
+
+  template <class T>
+  basic_wt_batch<T>::~basic_wt_batch() { }
+
+
+  template <class T>
+  int basic_wt_batch<T>::fwt_2d(T *data, size_t count, size_t rows, size_t cols, int level) {
+    if (level < 0) {
+      level = levels_to_one(max(rows, cols));
+    }
+    assert(level <= levels_to_one(max(rows, cols)));
+    if (!count || !rows || !cols) return level;
+
+    const size_t size = rows * cols;
+    const size_t group = group_for(size);
+    const long groups = (count + group - 1) / group;
+    const size_t threads = min(threads_ ? threads_ : default_threads(), (size_t)groups);
+    this->temps_.begin_pass(threads);
+    buffers_.begin_pass(threads);
+
+    #pragma omp parallel for num_threads(threads) if (threads > 1)
+    for (long g=0; g < groups; g++) {
+      const size_t n = min(group, count - g * group);
+      transform_group(data + g * group * size, n, rows, cols, level, 0, false);
+    }
+
+    buffers_.end_pass();
+    this->temps_.end_pass();
+    return level;
+  }
+
+
+  template <class T>
+  int basic_wt_batch<T>::iwt_2d(T *data, size_t count, size_t rows, size_t cols, 
+                                int fwt_level, int iwt_level) {
+    if (fwt_level < 0) {
+      fwt_level = levels_to_one(max(rows, cols));
+    }
+    assert(fwt_level <= levels_to_one(max(rows, cols)));
+    if (iwt_level < 0) {
+      iwt_level = INT_MAX;
+    }
+    const int levels = min(fwt_level, iwt_level);
+    if (!count || !rows || !cols || !levels) return levels;
+
+    const size_t size = rows * cols;
+    const size_t group = group_for(size);
+    const long groups = (count + group - 1) / group;
+    const size_t threads = min(threads_ ? threads_ : default_threads(), (size_t)groups);
+    this->temps_.begin_pass(threads);
+    buffers_.begin_pass(threads);
+
+    #pragma omp parallel for num_threads(threads) if (threads > 1)
+    for (long g=0; g < groups; g++) {
+      const size_t n = min(group, count - g * group);
+      transform_group(data + g * group * size, n, rows, cols, levels, fwt_level - levels, true);
+    }
+
+    buffers_.end_pass();
+    this->temps_.end_pass();
+    return levels;
+  }
+
+
+  template <class T>
+  void basic_wt_batch<T>::transform_group(T *data, size_t count, size_t rows, size_t cols, 
+                                          int levels, int first, bool inverse) {
+    const size_t size = rows * cols;
+    vector<T>& buf = buffers_.get();
+    if (buf.size() < size * count) buf.resize(size * count);
+
+    // value (r, c) of matrix m goes to buf[(r * cols + c) * count + m].
+    for (size_t m=0; m < count; m++) {
+      const T *src = data + m * size;
+      for (size_t i=0; i < size; i++) {
+        buf[i * count + m] = src[i];
+      }
+    }
+
+    // A row is a sweep of its values, each <count> wide; the matrix's columns are
+    // one sweep of rows, each cols * count wide.  Levels go as in wt_2d.
+    T *const base = &buf[0];
+    const size_t pitch = cols * count;
+    for (int l=0; l < levels; l++) {
+      const int i = inverse ? first + levels - 1 - l : first + l;
+      const size_t r = low_band_size(rows, i);
+      const size_t c = low_band_size(cols, i);
+
+      if (!inverse) {
+        if (c > 1) {
+          for (size_t row=0; row < r; row++) {
+            this->fwt_sweep(base + row * pitch, c, count, count);
+          }
+        }
+        this->fwt_sweep(base, r, pitch, c * count);
+
+      } else {
+        this->iwt_sweep(base, r, pitch, c * count);
+        if (c > 1) {
+          for (size_t row=0; row < r; row++) {
+            this->iwt_sweep(base + row * pitch, c, count, count);
+          }
+        }
+      }
+    }
+
+    for (size_t m=0; m < count; m++) {
+      T *dest = data + m * size;
+      for (size_t i=0; i < size; i++) {
+        dest[i] = buf[i * count + m];
+      }
+    }
+  }
+
+
+  template class basic_wt_batch<double>;
+  template class basic_wt_batch<float>;
+
+} // namespace nami
@@ -0,0 +1,114 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_BATCH_H
+#define WT_BATCH_H
+
+#include <vector>
+
+#include "wt_1d_lift.h"
+
+namespace nami {
+
+  /// Lifting transforms of many small matrices of the same shape at once, e.g. a 
+  /// 64x64 matrix per metric and region.  The matrices are stored one after 
+  /// another in one buffer, each row by row, and each is transformed in place
+  /// exactly as wt_lift::fwt_2d() would transform it alone:
+  ///
+  ///   wt_batch wt;
+  ///   wt.fwt_2d(data, count, 64, 64);
+  ///
+  /// Matrices are transformed in groups.  Each group is interleaved so that value 
+  /// (r, c) of every matrix in it is adjacent, and every lifting sweep runs across
+  /// the matrices as the SIMD lanes.  Even along rows, whose sweeps are short, 
+  /// each step then works on a whole group's values at a time, with one call per 
+  /// row instead of one per row per matrix.  Groups are divided among threads.
+  ///
+  template <class T>
+  class basic_wt_batch : public basic_wt_1d_lift<T> {
+  public:
+    /// Constructor.  Uses CDF 9/7 unless another scheme is chosen with set_scheme().
+    basic_wt_batch();
+
+    /// Destructor
+    virtual ~basic_wt_batch();
+
+    /// Forward transform of <count> rows x cols matrices stored one after another
+    /// at data.  Applies <level> levels, or the most possible if negative, as
+    /// wt_2d::fwt_2d() does.  Returns the number of levels applied.
+    int fwt_2d(T *data, size_t count, size_t rows, size_t cols, int level = -1);
+
+    /// Inverse of fwt_2d(); arguments are as for wt_2d::iwt_2d().  Returns the 
+    /// number of levels inverted.
+    int iwt_2d(T *data, size_t count, size_t rows, size_t cols, 
+               int fwt_level = -1, int iwt_level = -1);
+
+    /// Number of threads fwt_2d() and iwt_2d() use.  Defaults to 1.
+    size_t threads() const { return threads_; }
+
+    /// Sets number of threads; 0 uses OpenMP's default thread count.
+    void set_threads(size_t threads) { threads_ = threads; }
+
+    /// Matrices transformed together; 0, the default, fits about group_values 
+    /// values in each group, but at least min_group matrices.
+    size_t group_size() const { return group_size_; }
+
+    /// Sets number of matrices transformed together.
+    void set_group_size(size_t size) { group_size_ = size; }
+
+  protected:
+    /// Values per group if no group size is set.  Sweeps across fewer than about
+    /// 16 matrices are too narrow to pay for interleaving them, so groups have at
+    /// least min_group; 32x32 matrices go 128 to a group.
+    static const size_t group_values = 1 << 17;
+    static const size_t min_group = 16;
+
+    /// Matrices in each group for matrices of <size> values.
+    size_t group_for(size_t size) const {
+      return group_size_ ? group_size_ : std::max(group_values / size, size_t(min_group));
+    }
+
+    /// Transforms the <count> matrices of one group at data, in the calling 
+    /// thread's buffer.
+    void transform_group(T *data, size_t count, size_t rows, size_t cols, 
+                         int levels, int first, bool inverse);
+
+    size_t threads_;                          ///< Threads; 0 for the default
+    size_t group_size_;                       ///< Matrices per group; 0 for automatic
+    scratch_space<T> buffers_;                ///< Interleaved group, for each thread
+  };
+
+  typedef basic_wt_batch<double> wt_batch;
+  typedef basic_wt_batch<float>  wt_batch_f;
+
+} // namespace nami
+
+#endif // WT_BATCH_H
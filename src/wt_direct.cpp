@@ -42,41 +42,82 @@ using namespace std;
 namespace nami { 
 
   // just inits the filter.
-  wt_direct::wt_direct(filter_bank& filter) : wt_2d(), wt_1d_direct(filter) { }
+  template <class T>
+  basic_wt_direct<T>::basic_wt_direct(filter_bank& filter) 
+    : basic_wt_2d<T>(), basic_wt_1d_direct<T>(filter) { }
 
-  wt_direct::~wt_direct() { } 
+  template <class T>
+  basic_wt_direct<T>::~basic_wt_direct() { } 
 
-  void wt_direct::fwt_col(nami_matrix& mat, size_t col, size_t n) {
-    assert(even(n));
-    sym_extend(&mat(0, col), n, mat.size2());
+  template <class T>
+  void basic_wt_direct<T>::fwt_cols(T *col, size_t pitch, size_t w, size_t n) {
+    if (this->folded_) fwt_panel(sym_fir_kernel<basic_wt_1d_direct<T>::folded_size>(), col, pitch, w, n);
+    else               fwt_panel(fir_kernel(f_.size), col, pitch, w, n);
+  }
+
+
+  template <class T>
+  void basic_wt_direct<T>::iwt_cols(T *col, size_t pitch, size_t w, size_t n) {
+    if (this->folded_) iwt_panel(sym_fir_kernel<basic_wt_1d_direct<T>::folded_size>(), col, pitch, w, n);
+    else               iwt_panel(fir_kernel(f_.size), col, pitch, w, n);
+  }
+
+
+  template <class T> template <class K>
+  void basic_wt_direct<T>::fwt_panel(const K& fir, T *col, size_t pitch, size_t w, size_t n) {
+    const T *temp = sym_extend(col, n, pitch, false, w);
+    const double *lpf = f_.lpf;
+    const double *hpf = f_.hpf;
 
+    // rows of the panel are w apart in temp, so each column is a signal with 
+    // stride w.  Odd lengths get one more low row than high.
     size_t len = n >> 1;
+    size_t low = (n + 1) >> 1;
     for (size_t i=0; i < len; i++) {
-      mat(i, col) = mat(len+i, col) = 0;
-
-      for (size_t d=0; d < f_.size; d++) {
-        mat(i, col) += f_.lpf[d] * temp_[2*i+d];
-        mat(len+i, col) += f_.hpf[d] * temp_[2*i+d+1];
+      T *lo = col + i * pitch;
+      T *hi = col + (low+i) * pitch;
+      const T *t = &temp[2*i * w];
+      for (size_t j=0; j < w; j++) {
+        lo[j] = fir(lpf, t + j, w);
+        hi[j] = fir(hpf, t + w + j, w);
       }
     }
+    if (low > len) {
+      T *lo = col + len * pitch;
+      const T *t = &temp[2*len * w];
+      for (size_t j=0; j < w; j++) lo[j] = fir(lpf, t + j, w);
+    }
   }
   
 
-  void wt_direct::iwt_col(nami_matrix& mat, size_t col, size_t n) {
-    assert(even(n));
-
-    sym_extend(&mat(0, col), n, mat.size2(), true);
-    for (size_t i=0; i < n; i++) {
-      mat(i,col) = 0.0;
-      for (size_t d=0; d < f_.size; d++) {
-        // this check upsamples the two bands in the input data
-        if ((i+d) & 1) mat(i,col) += f_.ihpf[d] * temp_[i+d];
-        else           mat(i,col) += f_.ilpf[d] * temp_[i+d];
+  template <class T> template <class K>
+  void basic_wt_direct<T>::iwt_panel(const K& fir, T *col, size_t pitch, size_t w, size_t n) {
+    // bands are interleaved in temp; even and odd output rows each apply
+    // their own phase of the synthesis taps.
+    const T *temp = sym_extend(col, n, pitch, true, w);
+    const double *even_taps = &even_taps_[0];
+    const double *odd_taps = &odd_taps_[0];
+
+    for (size_t i=0; i+1 < n; i += 2) {
+      T *even = col + i * pitch;
+      T *odd = even + pitch;
+      const T *t = &temp[i * w];
+      for (size_t j=0; j < w; j++) {
+        even[j] = fir(even_taps, t + j, w);
+        odd[j] = fir(odd_taps, t + w + j, w);
       }
     }
+    if (n & 1) {
+      T *last = col + (n-1) * pitch;
+      const T *t = &temp[(n-1) * w];
+      for (size_t j=0; j < w; j++) last[j] = fir(even_taps, t + j, w);
+    }
   }
 
 
+  template class basic_wt_direct<double>;
+  template class basic_wt_direct<float>;
+
 } // namespaces
 
 
@@ -43,28 +43,62 @@ namespace nami {
   /// This is a non-lifting, symmetrically extended convolution implementation
   /// of the cdf wavelet transform.  This is not as fast as the lifting 
   /// implementation, but the algorithm used is closer to a parallel implementation.
-  /// TODO: arbitrarily-sized matrices.
-  class wt_direct : public wt_2d, public wt_1d_direct {
+  template <class T>
+  class basic_wt_direct : public basic_wt_2d<T>, public basic_wt_1d_direct<T> {
   public:
+    typedef typename basic_wt_2d<T>::matrix_type matrix_type;
+
     /// Constructs a new direct wavelet transform with the provided filter bank.
     /// Filter defaults to CDF 9/7 Wavelets.
-    wt_direct(filter_bank& f = filter::getCDF97());
+    basic_wt_direct(filter_bank& f = filter::getCDF97());
 
     /// Destructor
-    virtual ~wt_direct();
+    virtual ~basic_wt_direct();
 
-    virtual void fwt_row(nami_matrix& mat, size_t row, size_t n) {
-      fwt_1d_single(&mat(row, 0), n);
+    virtual void fwt_row(T *row, size_t n) {
+      this->fwt_1d_single(row, n);
     }
     
-    virtual void iwt_row(nami_matrix& mat, size_t row, size_t n) {
-      iwt_1d_single(&mat(row, 0), n);
+    virtual void iwt_row(T *row, size_t n) {
+      this->iwt_1d_single(row, n);
     }
     
-    virtual void fwt_col(nami_matrix& mat, size_t col, size_t n);
-    virtual void iwt_col(nami_matrix& mat, size_t col, size_t n);
+    virtual void fwt_col(T *col, size_t pitch, size_t n) {
+      fwt_cols(col, pitch, 1, n);
+    }
+
+    virtual void iwt_col(T *col, size_t pitch, size_t n) {
+      iwt_cols(col, pitch, 1, n);
+    }
+
+    /// Convolves a panel of adjacent columns at once.  Filter taps are applied 
+    /// to whole rows of the panel.
+    virtual void fwt_cols(T *col, size_t pitch, size_t width, size_t n);
+    virtual void iwt_cols(T *col, size_t pitch, size_t width, size_t n);
+
+  protected:
+    using basic_wt_1d_direct<T>::f_;
+    using basic_wt_1d_direct<T>::even_taps_;
+    using basic_wt_1d_direct<T>::odd_taps_;
+    using basic_wt_1d_direct<T>::sym_extend;
+
+    /// Panel convolutions for a kernel type K.
+    template <class K> void fwt_panel(const K& fir, T *col, size_t pitch, size_t w, size_t n);
+    template <class K> void iwt_panel(const K& fir, T *col, size_t pitch, size_t w, size_t n);
+
+    /// Gives each thread its own scratch space for convolution.
+    virtual void prepare_threads(size_t threads) {
+      this->temps_.begin_pass(threads);
+    }
+
+    virtual void finish_threads() {
+      this->temps_.end_pass();
+    }
   };
 
+  typedef basic_wt_direct<double> wt_direct;
+  typedef basic_wt_direct<float>  wt_direct_f;
+
 
 } // namespace 
 
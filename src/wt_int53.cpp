@@ -0,0 +1,186 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <climits>
+#include <algorithm>
+
+#include "wt_int53.h"
+#include "two_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  // Lifting steps on split data, as in JPEG 2000:
+  //   d[i] -= floor((s[i] + s[i+1]) / 2)
+  //   s[i] += floor((d[i-1] + d[i] + 2) / 4)
+  // s holds h rows of w values and d holds hd rows; hd is h-1 for odd lengths, and
+  // the lone last s row mirrors the d row before it.  Floors are arithmetic right shifts, 
+  // which round toward negative infinity for signed values on the compilers we use.
+  // The same rounded terms are added back by the inverse, so it is exact.
+
+  /// Predict step.  Last row is mirrored.  Sign is -1 to apply, 1 to undo.
+  static inline void predict(const quantized_t *s, quantized_t *d, size_t h, size_t hd, 
+                             size_t w, int sign) {
+    for (size_t i=0; i < hd; i++) {
+      const quantized_t *s0 = s + i*w;
+      const quantized_t *s1 = (i+1 < h) ? s0 + w : s0;
+      quantized_t *di = d + i*w;
+      for (size_t j=0; j < w; j++) {
+        di[j] += sign * ((s0[j] + s1[j]) >> 1);
+      }
+    }
+  }
+
+  /// Update step.  First row, and last row of odd lengths, are mirrored.  Sign is 1
+  /// to apply, -1 to undo.
+  static inline void update(quantized_t *s, const quantized_t *d, size_t h, size_t hd, 
+                            size_t w, int sign) {
+    for (size_t i=0; i < h; i++) {
+      const quantized_t *d1 = d + std::min(i, hd-1)*w;
+      const quantized_t *d0 = i ? d + (i-1)*w : d1;
+      quantized_t *si = s + i*w;
+      for (size_t j=0; j < w; j++) {
+        si[j] += sign * ((d0[j] + d1[j] + 2) >> 2);
+      }
+    }
+  }
+
+
+  void wt_int53::fwt_lines(quantized_t *data, size_t n, size_t stride, size_t w) {
+    if (n < 2) return;
+    const size_t h  = (n + 1) >> 1;
+    const size_t hd = n >> 1;
+    if (temp_.size() < n * w) temp_.resize(n * w);
+    quantized_t *s = &temp_[0];
+    quantized_t *d = &temp_[h * w];
+
+    for (size_t i=0; i < h; i++) {
+      copy(data + (2*i) * stride, data + (2*i) * stride + w, s + i*w);
+    }
+    for (size_t i=0; i < hd; i++) {
+      copy(data + (2*i+1) * stride, data + (2*i+1) * stride + w, d + i*w);
+    }
+
+    predict(s, d, h, hd, w, -1);
+    update(s, d, h, hd, w, 1);
+
+    for (size_t i=0; i < h; i++) {
+      copy(s + i*w, s + (i+1)*w, data + i * stride);
+    }
+    for (size_t i=0; i < hd; i++) {
+      copy(d + i*w, d + (i+1)*w, data + (h+i) * stride);
+    }
+  }
+
+
+  void wt_int53::iwt_lines(quantized_t *data, size_t n, size_t stride, size_t w) {
+    if (n < 2) return;
+    const size_t h  = (n + 1) >> 1;
+    const size_t hd = n >> 1;
+    if (temp_.size() < n * w) temp_.resize(n * w);
+    quantized_t *s = &temp_[0];
+    quantized_t *d = &temp_[h * w];
+
+    for (size_t i=0; i < h; i++) {
+      copy(data + i * stride, data + i * stride + w, s + i*w);
+    }
+    for (size_t i=0; i < hd; i++) {
+      copy(data + (h+i) * stride, data + (h+i) * stride + w, d + i*w);
+    }
+
+    update(s, d, h, hd, w, -1);
+    predict(s, d, h, hd, w, 1);
+
+    for (size_t i=0; i < h; i++) {
+      copy(s + i*w, s + (i+1)*w, data + (2*i) * stride);
+    }
+    for (size_t i=0; i < hd; i++) {
+      copy(d + i*w, d + (i+1)*w, data + (2*i+1) * stride);
+    }
+  }
+
+
+  int wt_int53::fwt_2d(quantized_matrix& mat, int level) {
+    if (level < 0) {
+      level = levels_to_one(std::max(mat.size1(), mat.size2()));
+    }
+    assert(level <= levels_to_one(std::max(mat.size1(), mat.size2())));
+
+    const size_t stride = mat.size2();
+    size_t rows = mat.size1();
+    size_t cols = mat.size2();
+    for (int i=0; i < level; i++) {
+      for (size_t r=0; r < rows; r++) fwt_lines(&mat(r, 0), cols, 1, 1);
+      if (rows > 1) {
+        for (size_t c=0; c < cols; c += panel_width_) {
+          fwt_lines(&mat(0, c), rows, stride, std::min(panel_width_, cols - c));
+        }
+      }
+
+      rows = low_band_size(rows, 1);
+      cols = low_band_size(cols, 1);
+    }
+
+    return level;
+  }
+
+
+  int wt_int53::iwt_2d(quantized_matrix& mat, int fwt_level, int iwt_level) {
+    if (fwt_level < 0) {
+      fwt_level = levels_to_one(std::max(mat.size1(), mat.size2()));
+    }
+    assert(fwt_level <= levels_to_one(std::max(mat.size1(), mat.size2())));
+
+    if (iwt_level < 0) {
+      iwt_level = INT_MAX;
+    }
+
+    const size_t stride = mat.size2();
+    size_t rows, cols;
+    int levels = 0;
+    for (int i=fwt_level-1; i >= 0 && levels < iwt_level; i--) {
+      rows = low_band_size(mat.size1(), i);
+      cols = low_band_size(mat.size2(), i);
+      
+      if (rows > 1) {
+        for (size_t c=0; c < cols; c += panel_width_) {
+          iwt_lines(&mat(0, c), rows, stride, std::min(panel_width_, cols - c));
+        }
+      }
+      for (size_t r=0; r < rows; r++) iwt_lines(&mat(r, 0), cols, 1, 1);
+
+      levels++;
+    }
+
+    return levels;
+  }
+
+} // namespace nami
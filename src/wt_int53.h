@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef WT_INT53_H
+#define WT_INT53_H
+
+#include <vector>
+
+#include "ezw.h"
+
+namespace nami {
+
+  /// Reversible integer-to-integer 5/3 lifting transform, as in JPEG 2000.
+  /// 
+  /// Works directly on quantized_matrix, and iwt_2d() undoes fwt_2d() exactly, so
+  /// together with the integer calls in ezw_encoder and ezw_decoder this gives
+  /// lossless compression:
+  /// 
+  ///   wt_int53 wt;
+  ///   int level = wt.fwt_2d(mat);
+  ///   encoder.encode(mat, out, level);
+  ///   ...
+  ///   decoder.decode(in, mat);
+  ///   wt.iwt_2d(mat, level);
+  ///
+  /// Levels and sizes are handled the same way as in wt_2d.  Boundaries are 
+  /// extended symmetrically.
+  class wt_int53 {
+  public:
+    /// Constructor
+    wt_int53() : panel_width_(16) { }
+
+    /// Destructor
+    virtual ~wt_int53() { }
+
+    /// Forward transform in 2 dimensions.  Returns the number of levels applied.
+    /// @see wt_2d::fwt_2d()
+    int fwt_2d(quantized_matrix& mat, int level = -1);
+
+    /// Inverse transform in 2 dimensions.  Returns the number of levels undone.
+    /// @see wt_2d::iwt_2d()
+    int iwt_2d(quantized_matrix& mat, int fwt_level = -1, int iwt_level = -1);
+
+    /// Forward transform of n contiguous values.
+    void fwt_1d_single(quantized_t *data, size_t n) { fwt_lines(data, n, 1, 1); }
+
+    /// Inverse transform of n contiguous values.
+    void iwt_1d_single(quantized_t *data, size_t n) { iwt_lines(data, n, 1, 1); }
+
+    /// Number of adjacent columns transformed together.
+    size_t panel_width() const { return panel_width_; }
+
+    /// Sets number of adjacent columns transformed together.  Must be at least 1.
+    void set_panel_width(size_t width) { panel_width_ = width; }
+
+  protected:
+    /// Forward transform of w adjacent signals of length n.  Sample i of signal j
+    /// is at data[i*stride + j].
+    void fwt_lines(quantized_t *data, size_t n, size_t stride, size_t w);
+
+    /// Inverse of fwt_lines().
+    void iwt_lines(quantized_t *data, size_t n, size_t stride, size_t w);
+
+    size_t panel_width_;                ///< Columns per panel in column transforms.
+    std::vector<quantized_t> temp_;     ///< Split even and odd samples.
+  };
+
+} // namespace nami
+
+#endif // WT_INT53_H
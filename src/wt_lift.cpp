@@ -31,126 +31,263 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 #include <vector>
 #include <algorithm>
+#include <climits>
+#include <cassert>
 
 #include "wt_lift.h"
+#include "wt_stream.h"
+#include "two_utils.h"
+#include "thread_utils.h"
 
 using namespace std;
 
 namespace nami { 
 
-  wt_lift::wt_lift() : wt_2d(), wt_1d_lift() { }
+  template <class T>
+  basic_wt_lift<T>::basic_wt_lift() : basic_wt_2d<T>(), basic_wt_1d_lift<T>() { }
 
-  wt_lift::~wt_lift() { }
+  template <class T>
+  basic_wt_lift<T>::~basic_wt_lift() { }
 
-  // TODO: make lifting filters pluggable.  Export this filter.
-  
-  /// Lifting filter for Cohen-Daubechies-Feauveau 9/7 wavelet
-  static const double lift_filter[] = {
-    -1.5861343420693648,
-    -0.0529801185718856,
-    0.8829110755411875,
-    0.4435068520511142
+
+  template <class T>
+  struct basic_wt_lift<T>::row_hook : public basic_wt_1d_lift<T>::line_hook {
+    basic_wt_lift *wt;
+    T *data;            ///< first row
+    size_t stride;      ///< values between rows
+    size_t n;           ///< number of rows
+    size_t cols;        ///< length of rows
+    bool active;        ///< false if rows aren't transformed at this level
+    bool inverse;
+    int threads;
+
+    row_hook(basic_wt_lift *w, T *d, size_t s, size_t r, size_t c, bool inv, int t)
+      : wt(w), data(d), stride(s), n(r), cols(c), active(c > 1), inverse(inv), threads(t) { }
+
+    /// Transforms rows [lo, hi).
+    void rows(size_t lo, size_t hi) {
+      if (!active) return;
+      #pragma omp parallel for num_threads(threads) if (threads > 1)
+      for (long r=lo; r < (long)hi; r++) {
+        if (inverse) {
+          wt->iwt_1d_single(data + r * stride, cols);
+        } else {
+          wt->fwt_1d_single(data + r * stride, cols);
+        }
+      }
+    }
+
+    /// Rows of line pairs [lo, hi).
+    void lines(size_t lo, size_t hi) {
+      rows(2*lo, std::min(2*hi, n));
+    }
   };
-  
-  /// Scaling factor used in transforms below.
-  static const double scale_factor = 1.1496043988602418;
-
-
-  void wt_lift::fwt_col(nami_matrix& mat, size_t col, size_t n) {
-    double a;
-    size_t i;
-
-    // Predict 1
-    a=lift_filter[0];
-    for (i=1;i<n-2;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
-    } 
-    mat(n-1, col)+=2*a*mat(n-2, col);
-
-    // Update 1
-    a=lift_filter[1];
-    for (i=2;i<n;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+
+
+  template <class T>
+  int basic_wt_lift<T>::do_fwt_2d(const view_type& mat, int level) {
+    T *data = mat.data();
+    const size_t rows = mat.size1();
+    const size_t cols = mat.size2();
+    const size_t pitch = mat.pitch();
+    if (level < 0) {
+      level = levels_to_one(std::max(rows, cols));
     }
-    mat(0, col)+=2*a*mat(1, col);
+    assert(level <= levels_to_one(std::max(rows, cols)));
+    if (rows == 0 || cols == 0) return level;
+
+    const size_t threads = this->threads_ ? this->threads_ : default_threads();
+    typename basic_wt_2d<T>::threaded_pass pass(*this, threads);
 
-    // Predict 2
-    a=lift_filter[2];
-    for (i=1;i<n-2;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+    fwt_levels(data, rows, cols, pitch, level, threads);
+    permute_rows(data, rows, cols, pitch, level, true, threads);
+    return level;
+  }
+
+
+  template <class T>
+  int basic_wt_lift<T>::fwt_2d(view_type mat, basic_row_sink<T>& sink, int level) {
+    T *data = mat.data();
+    const size_t rows = mat.size1();
+    const size_t cols = mat.size2();
+    const size_t pitch = mat.pitch();
+    if (level < 0) {
+      level = levels_to_one(std::max(rows, cols));
     }
-    mat(n-1, col)+=2*a*mat(n-2, col);
+    assert(level <= levels_to_one(std::max(rows, cols)));
 
-    // Update 2
-    a=lift_filter[3];
-    for (i=2;i<n;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+    const size_t threads = this->threads_ ? this->threads_ : default_threads();
+    typename basic_wt_2d<T>::threaded_pass pass(*this, threads);
+
+    if (rows && cols) {
+      fwt_levels(data, rows, cols, pitch, level, threads);
     }
-    mat(0, col)+=2*a*mat(1, col);
+    write_rows(data, rows, cols, pitch, level, sink);
+    return level;
+  }
 
-    // Scale
-    a=1/scale_factor;
-    for (i=0;i<n;i++) {
-      if (i%2) mat(i, col)*=a;
-      else mat(i, col)/=a;
+
+  template <class T>
+  int basic_wt_lift<T>::do_iwt_2d(const view_type& mat, int fwt_level, int iwt_level) {
+    T *data = mat.data();
+    const size_t size1 = mat.size1();
+    const size_t size2 = mat.size2();
+    const size_t pitch = mat.pitch();
+    if (fwt_level < 0) {
+      fwt_level = levels_to_one(std::max(size1, size2));
     }
+    assert(fwt_level <= levels_to_one(std::max(size1, size2)));
 
-    // Pack
-    if (temp_.size() < n) temp_.resize(n);
-    for (i=0;i<n;i++) {
-      if (i%2==0) temp_[i/2] = mat(i, col);
-      else temp_[n/2+i/2] = mat(i, col);
+    if (iwt_level < 0) {
+      iwt_level = INT_MAX;
     }
-    for (i=0;i<n;i++) mat(i, col) = temp_[i];
+    const int levels = std::min(fwt_level, iwt_level);
+    if (size1 == 0 || size2 == 0 || levels == 0) return levels;
+
+    // Only the part of the matrix holding the last <levels> levels is inverted.
+    const int first = fwt_level - levels;
+    const size_t rows = low_band_size(size1, first);
+    const size_t cols = low_band_size(size2, first);
+
+    const size_t threads = this->threads_ ? this->threads_ : default_threads();
+    typename basic_wt_2d<T>::threaded_pass pass(*this, threads);
+
+    permute_rows(data, rows, cols, pitch, levels, false, threads);
+    iwt_levels(data, rows, cols, pitch, levels, threads);
+    return levels;
   }
 
 
-  void wt_lift::iwt_col(nami_matrix& mat, size_t col, size_t n) {
-    double a;
-    size_t i;
+  template <class T>
+  void basic_wt_lift<T>::fwt_levels(T *data, size_t rows, size_t cols, size_t pitch, 
+                                    int levels, size_t threads) {
+    size_t step = 1;     // active rows are <step> rows apart
+    for (int i=0; i < levels; i++) {
+      const int nthreads = this->pass_threads(threads, rows, cols);
+      row_hook hook(this, data, step * pitch, rows, cols, false, nthreads);
 
-    // Unpack
-    if (temp_.size() < n) temp_.resize(n);
-    for (i=0;i<n/2;i++) {
-      temp_[i*2]=mat(i, col);
-      temp_[i*2+1]=mat(i+n/2, col);
+      if (rows > 1) {
+        this->fwt_lines(data, rows, step * pitch, cols, hook, nthreads);
+        rows = low_band_size(rows, 1);
+        step <<= 1;
+      } else {
+        hook.rows(0, rows);
+      }
+      cols = low_band_size(cols, 1);
     }
-    for (i=0;i<n;i++) mat(i, col) = temp_[i];
+  }
+
+
+  template <class T>
+  void basic_wt_lift<T>::iwt_levels(T *data, size_t rows, size_t cols, size_t pitch, 
+                                    int levels, size_t threads) {
+    const int row_levels = levels_to_one(rows);
 
-    // Undo scale
-    a=scale_factor;
-    for (i=0;i<n;i++) {
-      if (i%2) mat(i, col)*=a;
-      else mat(i, col)/=a;
+    for (int i=levels-1; i >= 0; i--) {
+      const size_t r = low_band_size(rows, i);
+      const size_t c = low_band_size(cols, i);
+      const size_t step = size_t(1) << std::min(i, row_levels);
+      const int nthreads = this->pass_threads(threads, r, c);
+      row_hook hook(this, data, step * pitch, r, c, true, nthreads);
+
+      if (r > 1) {
+        this->iwt_lines(data, r, step * pitch, c, hook, nthreads);
+      } else {
+        hook.rows(0, r);
+      }
     }
+  }
+
+
+  template <class T>
+  void basic_wt_lift<T>::permute_rows(T *data, size_t rows, size_t cols, size_t pitch, 
+                                      int levels, bool mallat, size_t threads) {
+    const int vlevels = std::min(levels, levels_to_one(rows));
+    vector<size_t> src(rows), order(rows);
+
+    // Columns in [low_band_size(cols, v), low_band_size(cols, v-1)) took part in v
+    // column transforms; columns left of those took part in all of them.
+    for (int v=1; v <= vlevels; v++) {
+      const size_t lo = (v < vlevels) ? low_band_size(cols, v) : 0;
+      const size_t hi = low_band_size(cols, v-1);
+      if (lo >= hi) continue;
+
+      for (size_t m=0; m < rows; m++) {
+        order[m] = interleaved_row(m, rows, v);
+      }
+      if (mallat) {
+        src = order;
+      } else {
+        for (size_t m=0; m < rows; m++) src[order[m]] = m;
+      }
 
-    // Undo update 2
-    a=-lift_filter[3];
-    for (i=2;i<n;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+      // Gather row src[m] into row m, following each cycle of the permutation.
+      const long chunk = (hi - lo + threads - 1) / threads;
+      #pragma omp parallel for num_threads(threads) if (threads > 1 && rows * (hi - lo) > 16384)
+      for (long c0=lo; c0 < (long)hi; c0 += chunk) {
+        const size_t w = std::min((size_t)chunk, hi - c0);
+        vector<T> buf(w);
+        vector<char> moved(rows, 0);
+        for (size_t m=0; m < rows; m++) {
+          if (moved[m] || src[m] == m) continue;
+          T *first = data + m * pitch + c0;
+          std::copy(first, first + w, buf.begin());
+          size_t j = m;
+          while (src[j] != m) {
+            T *from = data + src[j] * pitch + c0;
+            std::copy(from, from + w, data + j * pitch + c0);
+            moved[j] = 1;
+            j = src[j];
+          }
+          std::copy(buf.begin(), buf.end(), data + j * pitch + c0);
+          moved[j] = 1;
+        }
+      }
     }
-    mat(0, col)+=2*a*mat(1, col);
+  }
+
+
+  template <class T>
+  size_t basic_wt_lift<T>::interleaved_row(size_t m, size_t rows, int v) {
+    // The low band of n rows is the first (n+1)/2 of them.
+    size_t n = rows;
+    int k = 0;
+    while (k < v && m < (n+1)/2) {
+      n = (n+1)/2;
+      k++;
+    }
+    return (k < v) ? (2*(m - (n+1)/2) + 1) << k : m << k;
+  }
+
 
-    // Undo predict 2
-    a=-lift_filter[2];
-    for (i=1;i<n-2;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+  template <class T>
+  void basic_wt_lift<T>::write_rows(const T *data, size_t rows, size_t cols, size_t pitch,
+                                    int levels, basic_row_sink<T>& sink) {
+    // Columns in [bounds[b], bounds[b+1]) took part in vlevels - b column transforms,
+    // and row m of them is row order[b][m] of the matrix.
+    const int vlevels = std::min(levels, levels_to_one(rows));
+    vector<size_t> bounds(vlevels + 2, cols);
+    vector< vector<size_t> > order(vlevels + 1, vector<size_t>(rows));
+    bounds[0] = 0;
+    for (int b=0; b <= vlevels; b++) {
+      if (b > 0) bounds[b] = low_band_size(cols, vlevels - b);
+      for (size_t m=0; m < rows; m++) {
+        order[b][m] = interleaved_row(m, rows, vlevels - b);
+      }
     }
-    mat(n-1, col)+=2*a*mat(n-2, col);
 
-    // Undo update 1
-    a=-lift_filter[1];
-    for (i=2;i<n;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
+    for (size_t m=0; m < rows; m++) {
+      for (int b=0; b <= vlevels; b++) {
+        const size_t c = bounds[b];
+        if (c < bounds[b+1]) {
+          sink.write_row(m, c, data + order[b][m] * pitch + c, bounds[b+1] - c);
+        }
+      }
     }
-    mat(0, col)+=2*a*mat(1, col);
-
-    // Undo predict 1
-    a=-lift_filter[0];
-    for (i=1;i<n-2;i+=2) {
-      mat(i, col)+=a*(mat(i-1, col)+mat(i+1, col));
-    } 
-    mat(n-1, col)+=2*a*mat(n-2, col);
   }
 
+
+  template class basic_wt_lift<double>;
+  template class basic_wt_lift<float>;
+
 } // namespaces  
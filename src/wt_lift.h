@@ -40,39 +40,126 @@
 
 namespace nami { 
 
-  /// This is a lifting implementation of the CDF 9/7 wavelet transform.
-  /// Matrices passed in must be 
-  /// TODO: modify column routines to use groups for speed.
-  /// TODO: arbitrarily-sized matrices.
+  template <class T> struct basic_row_sink;    // see wt_stream.h
+
+
+  /// This is a lifting implementation of the wavelet transform.  It uses CDF 9/7 
+  /// wavelets unless another scheme is chosen with set_scheme().  wt_lift transforms
+  /// nami_matrix; wt_lift_f transforms single-precision nami_matrix_f.
+  /// Matrices may be any size.  Odd-length rows and columns are lifted with
+  /// symmetric extension, and their low band gets the extra value.
+  /// Columns are transformed in panels of adjacent columns (see wt_2d::panel_width()),
+  /// so that each row of the panel is read from the matrix as one contiguous chunk.
+  /// fwt_2d() and iwt_2d() instead lift whole rows in place, block by block, and 
+  /// give the same coefficients as the level-by-level loop in wt_2d.
   ///
   /// by Todd Gamblin October 25, 2007.
   ///
-  class wt_lift : public wt_2d, public wt_1d_lift {
+  template <class T>
+  class basic_wt_lift : public basic_wt_2d<T>, public basic_wt_1d_lift<T> {
   public:
+    typedef typename basic_wt_2d<T>::matrix_type matrix_type;
+    typedef typename basic_wt_2d<T>::view_type view_type;
+
     /// Default Constructor
-    wt_lift();
+    basic_wt_lift();
     
     /// Destructor
-    virtual ~wt_lift();
+    virtual ~basic_wt_lift();
+
+    using basic_wt_2d<T>::fwt_2d;
+
+    ///
+    /// Forward transform in 2 dimensions that writes the coefficients to sink in 
+    /// place of the final pass that puts rows in the usual order, e.g. so that they
+    /// can be quantized in that same pass.  Each coefficient goes to the row and 
+    /// column where wt_2d::fwt_2d() would put it.  mat is left holding the 
+    /// coefficients in the transform's own order.  Returns the number of levels applied.
+    ///
+    int fwt_2d(view_type mat, basic_row_sink<T>& sink, int level = -1);
 
     /// Forward wavelet transform for matrix rows.
-    virtual void fwt_row(nami_matrix& mat, size_t row, size_t n) {
-      fwt_1d_single(&mat(row, 0), n);
+    virtual void fwt_row(T *row, size_t n) {
+      this->fwt_1d_single(row, n);
     }
 
     /// Forward wavelet transform for matrix cols
-    virtual void fwt_col(nami_matrix& mat, size_t col, size_t n);
+    virtual void fwt_col(T *col, size_t pitch, size_t n) {
+      fwt_cols(col, pitch, 1, n);
+    }
+
+    /// Forward wavelet transform for a panel of adjacent matrix cols.
+    virtual void fwt_cols(T *col, size_t pitch, size_t width, size_t n) {
+      this->fwt_sweep(col, n, pitch, width);
+    }
 
 
     /// Inverse wavelet transform for matrix rows.
-    virtual void iwt_row(nami_matrix& mat, size_t row, size_t n) {
-      iwt_1d_single(&mat(row, 0), n);
+    virtual void iwt_row(T *row, size_t n) {
+      this->iwt_1d_single(row, n);
     }
 
     /// Inverse wavelet transform for matrix cols
-    virtual void iwt_col(nami_matrix& mat, size_t col, size_t n);
+    virtual void iwt_col(T *col, size_t pitch, size_t n) {
+      iwt_cols(col, pitch, 1, n);
+    }
+
+    /// Inverse wavelet transform for a panel of adjacent matrix cols.
+    virtual void iwt_cols(T *col, size_t pitch, size_t width, size_t n) {
+      this->iwt_sweep(col, n, pitch, width);
+    }
+
+  protected:
+    /// Forward transform in 2 dimensions.  Each level is one pass over the matrix:
+    /// a block of rows is transformed and its columns are lifted while it is still 
+    /// in cache.  Columns are lifted in place, so the low and high rows of each 
+    /// level stay interleaved until one final pass puts them in the usual order.
+    /// @see wt_2d::fwt_2d()
+    virtual int do_fwt_2d(const view_type& mat, int level);
+
+    /// Inverse of do_fwt_2d(), done the same way.
+    /// @see wt_2d::iwt_2d()
+    virtual int do_iwt_2d(const view_type& mat, int fwt_level, int iwt_level);
+
+    /// Transforms rows of a block of lines as fwt_lines() reaches them.
+    struct row_hook;
+
+    /// Forward transform of <levels> levels of the rows x cols matrix at data,
+    /// whose rows are <pitch> values apart.  Leaves rows in interleaved order.
+    void fwt_levels(T *data, size_t rows, size_t cols, size_t pitch, int levels, 
+                    size_t threads);
+
+    /// Inverse of fwt_levels().
+    void iwt_levels(T *data, size_t rows, size_t cols, size_t pitch, int levels,
+                    size_t threads);
+
+    /// Moves rows of a matrix transformed by fwt_levels() from interleaved order
+    /// to the usual order with the low band first, or back if <mallat> is false.
+    /// Each column is permuted according to how many levels its column took part in.
+    static void permute_rows(T *data, size_t rows, size_t cols, size_t pitch, int levels, 
+                             bool mallat, size_t threads);
+
+    /// Row of a matrix transformed by fwt_levels() that holds row m of the usual 
+    /// order, in columns that took part in v column transforms.
+    static size_t interleaved_row(size_t m, size_t rows, int v);
+
+    /// Writes rows of a matrix transformed by fwt_levels() to sink in the usual order.
+    static void write_rows(const T *data, size_t rows, size_t cols, size_t pitch, 
+                           int levels, basic_row_sink<T>& sink);
+
+    /// Gives each thread its own scratch space for the lifting sweeps.
+    virtual void prepare_threads(size_t threads) {
+      this->temps_.begin_pass(threads);
+    }
+
+    virtual void finish_threads() {
+      this->temps_.end_pass();
+    }
   };
 
+  typedef basic_wt_lift<double> wt_lift;
+  typedef basic_wt_lift<float>  wt_lift_f;
+
 } // namespace 
 
 #endif //LIFT_WT_2D_H
@@ -0,0 +1,170 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include <algorithm>
+
+#include "wt_packet.h"
+#include "two_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  template <class T>
+  static basic_matrix_view<T> band_view(const basic_matrix_view<T>& mat, const subband& band) {
+    return basic_matrix_view<T>(mat.data() + band.row * mat.pitch() + band.col,
+                                band.rows, band.cols, mat.pitch());
+  }
+
+
+  template <class T>
+  void basic_wt_packet<T>::fwt_packet(matrix_type mat, const packet_tree& tree) {
+    if (tree.empty()) return;
+    fwt_band(mat, subband(0, 0, mat.size1(), mat.size2()), tree, 0);
+  }
+
+
+  template <class T>
+  void basic_wt_packet<T>::fwt_band(const matrix_type& mat, const subband& band, 
+                                    const packet_tree& tree, size_t node) {
+    if (!tree.split(node)) return;
+    wt_->fwt_2d(band_view(mat, band), 1);
+    for (int q=0; q < 4; q++) {
+      fwt_band(mat, band.quadrant(q), tree, tree.child(node, q));
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_packet<T>::iwt_packet(matrix_type mat, const packet_tree& tree) {
+    if (tree.empty()) return;
+    iwt_band(mat, subband(0, 0, mat.size1(), mat.size2()), tree, 0);
+  }
+
+
+  template <class T>
+  void basic_wt_packet<T>::iwt_band(const matrix_type& mat, const subband& band, 
+                                    const packet_tree& tree, size_t node) {
+    if (!tree.split(node)) return;
+    for (int q=0; q < 4; q++) {
+      iwt_band(mat, band.quadrant(q), tree, tree.child(node, q));
+    }
+    wt_->iwt_2d(band_view(mat, band), 1);
+  }
+
+
+  template <class T>
+  packet_tree basic_wt_packet<T>::best_basis(matrix_type mat, int level, basis_cost_t cost) {
+    if (level < 0) {
+      level = levels_to_one(min(mat.size1(), mat.size2()));
+    }
+
+    // entropy is of each value's share of the total energy, which every basis
+    // shares closely enough for the costs to be compared.
+    double norm = 0;
+    if (cost == ENTROPY) {
+      for (size_t i=0; i < mat.size1(); i++) {
+        const T *row = mat.data() + i * mat.pitch();
+        for (size_t j=0; j < mat.size2(); j++) {
+          norm += (double)row[j] * row[j];
+        }
+      }
+    }
+
+    vector<bool> flags;
+    best_band(mat, subband(0, 0, mat.size1(), mat.size2()), level, cost, norm, flags);
+    return packet_tree(flags);
+  }
+
+
+  template <class T>
+  double basic_wt_packet<T>::best_band(const matrix_type& mat, const subband& band, 
+                                       int levels, basis_cost_t cost, double norm, 
+                                       vector<bool>& flags) {
+    const double leaf_cost = band_cost(mat, band, cost, norm);
+    flags.push_back(false);
+    if (levels == 0 || band.rows < 2 || band.cols < 2) {
+      return leaf_cost;
+    }
+
+    // keep the band so it can be put back if splitting doesn't pay.
+    const matrix_type view = band_view(mat, band);
+    vector<T> saved(band.rows * band.cols);
+    for (size_t i=0; i < band.rows; i++) {
+      const T *row = view.data() + i * view.pitch();
+      copy(row, row + band.cols, &saved[i * band.cols]);
+    }
+
+    const size_t pos = flags.size() - 1;
+    flags[pos] = true;
+    wt_->fwt_2d(view, 1);
+
+    double split_cost = 0;
+    for (int q=0; q < 4; q++) {
+      split_cost += best_band(mat, band.quadrant(q), levels - 1, cost, norm, flags);
+    }
+    if (split_cost < leaf_cost) {
+      return split_cost;
+    }
+
+    flags.resize(pos + 1);
+    flags[pos] = false;
+    for (size_t i=0; i < band.rows; i++) {
+      copy(&saved[i * band.cols], &saved[(i+1) * band.cols], view.data() + i * view.pitch());
+    }
+    return leaf_cost;
+  }
+
+
+  template <class T>
+  double basic_wt_packet<T>::band_cost(const matrix_type& mat, const subband& band, 
+                                       basis_cost_t cost, double norm) {
+    double sum = 0;
+    for (size_t i=0; i < band.rows; i++) {
+      const T *row = mat.data() + (band.row + i) * mat.pitch() + band.col;
+      for (size_t j=0; j < band.cols; j++) {
+        if (cost == L1_NORM) {
+          sum += fabs((double)row[j]);
+        } else if (row[j] != 0 && norm > 0) {
+          const double p = (double)row[j] * row[j] / norm;
+          sum -= p * log(p);
+        }
+      }
+    }
+    return sum;
+  }
+
+
+  template class basic_wt_packet<double>;
+  template class basic_wt_packet<float>;
+
+} // namespace nami
@@ -0,0 +1,125 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_PACKET_H
+#define WT_PACKET_H
+
+#include <vector>
+
+#include "nami_matrix.h"
+#include "packet_tree.h"
+#include "wt_2d.h"
+
+namespace nami {
+
+  /// Additive costs for choosing a best basis; lower is better.
+  typedef enum { 
+    ENTROPY,   ///< Shannon entropy of the coefficients' share of the total energy
+    L1_NORM    ///< Sum of the coefficients' magnitudes
+  } basis_cost_t;
+
+
+  /// Wavelet packet transforms, built on the one-level 2d transform of any 
+  /// basic_wt_2d:
+  ///
+  ///   wt_lift lift;
+  ///   wt_packet wp(lift);
+  ///   packet_tree basis = wp.best_basis(mat);      // mat is now in that basis
+  ///   encoder.encode(mat, basis, out);
+  ///   ...
+  ///   wp.iwt_packet(mat, basis);
+  ///
+  /// Splitting a subband is one level of fwt_2d() on its rectangle, so a pyramid 
+  /// basis (packet_tree(level)) gives the same coefficients as fwt_2d(mat, level).
+  ///
+  template <class T>
+  class basic_wt_packet {
+  public:
+    /// Type of matrix this class transforms.
+    typedef basic_matrix_view<T> matrix_type;
+
+    /// Transforms subbands with wt, which must outlive this object.
+    explicit basic_wt_packet(basic_wt_2d<T>& wt) : wt_(&wt) { }
+
+    /// Destructor
+    virtual ~basic_wt_packet() { }
+
+    /// Transforms mat into the packet basis described by tree.
+    void fwt_packet(matrix_type mat, const packet_tree& tree);
+
+    /// Inverse of fwt_packet() with the same tree.
+    void iwt_packet(matrix_type mat, const packet_tree& tree);
+
+    /// Transforms mat into the basis with the lowest cost, and returns that basis.
+    /// This is the search of Coifman and Wickerhauser: each subband is split, its 
+    /// quadrants' best bases are found, and the split is kept only if they cost 
+    /// less than the subband does unsplit.  Every subband is transformed once per 
+    /// level, as in a full packet decomposition.
+    ///
+    /// @param mat     matrix to transform
+    /// @param level   most splits from the whole matrix to any subband (default max
+    ///                possible).  Subbands are split while both sides are at least 
+    ///                2 long.  To code the result with zerotrees, level must be no
+    ///                more than the times both sides divide by 2.
+    /// @param cost    cost function to minimize
+    ///
+    packet_tree best_basis(matrix_type mat, int level = -1, basis_cost_t cost = ENTROPY);
+
+    /// The 2d transform this uses to split subbands.
+    basic_wt_2d<T>& transform_2d() const { return *wt_; }
+
+  protected:
+    /// Does fwt_packet() for the subtree at node, over band of mat.
+    void fwt_band(const matrix_type& mat, const subband& band, 
+                  const packet_tree& tree, size_t node);
+
+    /// Does iwt_packet() for the subtree at node, over band of mat.
+    void iwt_band(const matrix_type& mat, const subband& band, 
+                  const packet_tree& tree, size_t node);
+
+    /// Does best_basis() for band of mat, appending its split flags in preorder.
+    /// Returns the cost of the band's best basis.
+    double best_band(const matrix_type& mat, const subband& band, int levels,
+                     basis_cost_t cost, double norm, std::vector<bool>& flags);
+
+    /// Cost of the values in band; norm is the total energy for ENTROPY.
+    double band_cost(const matrix_type& mat, const subband& band, 
+                     basis_cost_t cost, double norm);
+
+    basic_wt_2d<T> *wt_;   ///< Transform for splitting subbands.
+  };
+
+  typedef basic_wt_packet<double> wt_packet;
+  typedef basic_wt_packet<float>  wt_packet_f;
+
+} // namespace nami
+
+#endif // WT_PACKET_H
@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+
+#include "wt_stream.h"
+#include "two_utils.h"
+
+using namespace std;
+
+namespace nami {
+
+  template <class T>
+  void basic_istream_row_source<T>::read_row(T *row, size_t cols) {
+    in_.read((char*)row, cols * sizeof(T));
+    if (!in_) {
+      throw runtime_error("Error: row source ended early.");
+    }
+  }
+
+
+  template <class T>
+  void basic_ostream_row_sink<T>::write_row(size_t row, size_t col, const T *values, size_t n) {
+    out_.seekp((row * cols_ + col) * sizeof(T));
+    out_.write((const char*)values, n * sizeof(T));
+  }
+
+
+  template <class T>
+  void basic_matrix_row_sink<T>::write_row(size_t row, size_t col, const T *values, size_t n) {
+    assert(row < mat_.size1() && col + n <= mat_.size2());
+    copy(values, values + n, mat_.data() + row * mat_.pitch() + col);
+  }
+
+
+  template <class T>
+  basic_wt_stream<T>::basic_wt_stream() 
+    : rows_(0), cols_(0), rows_pushed_(0), sink_(0) { }
+
+
+  template <class T>
+  basic_wt_stream<T>::~basic_wt_stream() { }
+
+
+  template <class T>
+  int basic_wt_stream<T>::start(size_t rows, size_t cols, basic_row_sink<T>& sink, int level) {
+    if (level < 0) {
+      level = levels_to_one(max(rows, cols));
+    }
+    assert(level <= levels_to_one(max(rows, cols)));
+
+    rows_ = rows;
+    cols_ = cols;
+    rows_pushed_ = 0;
+    sink_ = &sink;
+
+    // level i transforms the rows x cols low corner left by the levels before it.
+    streams_.resize(level);
+    hooks_.clear();
+    for (int i=0; i < level; i++) {
+      this->start_stream(streams_[i], low_band_size(rows, i), low_band_size(cols, i));
+      hooks_.push_back(level_hook(this, i));
+    }
+    return level;
+  }
+
+
+  template <class T>
+  void basic_wt_stream<T>::push_row(const T *row) {
+    assert(rows_pushed_ < rows_);
+    rows_pushed_++;
+    if (streams_.empty()) {
+      sink_->write_row(rows_pushed_ - 1, 0, row, cols_);
+    } else {
+      push(0, row);
+    }
+  }
+
+
+  template <class T>
+  void basic_wt_stream<T>::push(int level, const T *row) {
+    line_stream& ls = streams_[level];
+    T *line = this->next_line(ls);
+    copy(row, row + ls.w, line);
+    if (ls.w > 1) {
+      this->fwt_1d_single(line, ls.w);
+    }
+    this->push_line(ls, hooks_[level]);
+  }
+
+
+  template <class T>
+  void basic_wt_stream<T>::pair_done(int level, size_t i, T *low, T *high) {
+    const line_stream& ls = streams_[level];
+    const size_t cols = ls.w;
+
+    // the low part of a low row is the next level's; the rest is finished here.
+    if (level + 1 < (int)streams_.size()) {
+      const size_t low_cols = low_band_size(cols, 1);
+      if (low_cols < cols) {
+        sink_->write_row(i, low_cols, low + low_cols, cols - low_cols);
+      }
+      push(level + 1, low);
+    } else {
+      sink_->write_row(i, 0, low, cols);
+    }
+
+    // high rows follow the low band, whose size is the next level's row count.
+    if (high) {
+      sink_->write_row(ls.h + i, 0, high, cols);
+    }
+  }
+
+
+  template <class T>
+  int basic_wt_stream<T>::fwt_2d(basic_row_source<T>& source, basic_row_sink<T>& sink, 
+                                 size_t rows, size_t cols, int level) {
+    level = start(rows, cols, sink, level);
+    row_.resize(cols);
+    for (size_t r=0; r < rows; r++) {
+      source.read_row(&row_[0], cols);
+      push_row(&row_[0]);
+    }
+    return level;
+  }
+
+
+  template class basic_istream_row_source<double>;
+  template class basic_istream_row_source<float>;
+  template class basic_ostream_row_sink<double>;
+  template class basic_ostream_row_sink<float>;
+  template class basic_matrix_row_sink<double>;
+  template class basic_matrix_row_sink<float>;
+  template class basic_wt_stream<double>;
+  template class basic_wt_stream<float>;
+
+} // namespace nami
@@ -0,0 +1,189 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef WT_STREAM_H
+#define WT_STREAM_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "nami_matrix.h"
+#include "wt_1d_lift.h"
+
+namespace nami {
+
+  /// Supplies the rows of a matrix to basic_wt_stream, in order.
+  template <class T>
+  struct basic_row_source {
+    virtual ~basic_row_source() { }
+
+    /// Reads the next row of the matrix, cols values, into row.
+    virtual void read_row(T *row, size_t cols) = 0;
+  };
+
+
+  /// Receives coefficients from basic_wt_stream, as pieces of rows.
+  template <class T>
+  struct basic_row_sink {
+    virtual ~basic_row_sink() { }
+
+    /// Called with the n coefficients at (row, col) through (row, col + n - 1) of 
+    /// the transformed matrix.  Each coefficient is written once.
+    virtual void write_row(size_t row, size_t col, const T *values, size_t n) = 0;
+  };
+
+
+  /// Reads rows stored as raw values of type T, one row after another, e.g. in a 
+  /// file.  Throws std::runtime_error if the stream ends early.
+  template <class T>
+  class basic_istream_row_source : public basic_row_source<T> {
+  public:
+    explicit basic_istream_row_source(std::istream& in) : in_(in) { }
+    virtual void read_row(T *row, size_t cols);
+  private:
+    std::istream& in_;
+  };
+
+
+  /// Writes coefficients as raw values of type T to their places in a matrix of 
+  /// <cols> columns stored row after row, e.g. in a file.  out must be seekable to
+  /// any place in the matrix, as files are; coefficients arrive out of order.
+  template <class T>
+  class basic_ostream_row_sink : public basic_row_sink<T> {
+  public:
+    basic_ostream_row_sink(std::ostream& out, size_t cols) : out_(out), cols_(cols) { }
+    virtual void write_row(size_t row, size_t col, const T *values, size_t n);
+  private:
+    std::ostream& out_;
+    size_t cols_;
+  };
+
+
+  /// Writes coefficients into a matrix, e.g. to hand them to ezw_encoder.
+  template <class T>
+  class basic_matrix_row_sink : public basic_row_sink<T> {
+  public:
+    explicit basic_matrix_row_sink(basic_matrix_view<T> mat) : mat_(mat) { }
+    virtual void write_row(size_t row, size_t col, const T *values, size_t n);
+  private:
+    basic_matrix_view<T> mat_;
+  };
+
+
+  /// Line-based 2d forward transform, for matrices too large to hold in memory.
+  /// Rows go in one at a time, from a basic_row_source or push_row(), and 
+  /// coefficients come out to a basic_row_sink as soon as they are finished:
+  ///
+  ///   wt_stream wt;
+  ///   std::ifstream in("big.dat", std::ios::binary);
+  ///   std::fstream out("big.wt", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  ///   istream_row_source source(in);
+  ///   ostream_row_sink sink(out, cols);
+  ///   wt.fwt_2d(source, sink, rows, cols);
+  ///
+  /// Each level keeps only a window of rows for its column lifting steps, and 
+  /// passes its low rows on to the next level as they are finished, so memory is 
+  /// a few dozen rows per level: O(cols x filter length x levels).  Coefficients 
+  /// are the same as those of wt_lift with the same lifting scheme, in the same 
+  /// places, so the output can be decoded with wt_lift::iwt_2d() or handed to 
+  /// ezw_encoder once it fits.
+  ///
+  template <class T>
+  class basic_wt_stream : public basic_wt_1d_lift<T> {
+  public:
+    /// Constructor.  Uses CDF 9/7 unless another scheme is chosen with set_scheme().
+    basic_wt_stream();
+
+    /// Destructor
+    virtual ~basic_wt_stream();
+
+    /// Starts a forward transform of a rows x cols matrix.  Returns the number of 
+    /// levels that will be applied: <level>, or the most possible if negative, as
+    /// for wt_2d::fwt_2d().  sink must outlive the transform.
+    int start(size_t rows, size_t cols, basic_row_sink<T>& sink, int level = -1);
+
+    /// Transforms the next row of the matrix.  Rows must be pushed in order.
+    void push_row(const T *row);
+
+    /// True once every row has been pushed, and all coefficients written.
+    bool done() const { return rows_pushed_ == rows_; }
+
+    /// Transforms a whole rows x cols matrix from source into sink.  Returns the 
+    /// number of levels applied.
+    int fwt_2d(basic_row_source<T>& source, basic_row_sink<T>& sink, 
+               size_t rows, size_t cols, int level = -1);
+
+  protected:
+    typedef typename basic_wt_1d_lift<T>::line_stream line_stream;
+    typedef typename basic_wt_1d_lift<T>::stream_hook stream_hook;
+
+    /// Passes finished pairs of one level's column transform to level_done().
+    struct level_hook : public stream_hook {
+      basic_wt_stream *wt;
+      int level;
+      level_hook(basic_wt_stream *w, int l) : wt(w), level(l) { }
+      void pair(size_t i, T *low, T *high) { wt->pair_done(level, i, low, high); }
+    };
+
+    /// Row transforms row, the next row of <level>, and adds it to that level's 
+    /// column transform.
+    void push(int level, const T *row);
+
+    /// Writes out the finished pair i of <level>, and passes the low part of its
+    /// low row on to the next level.
+    void pair_done(int level, size_t i, T *low, T *high);
+
+    size_t rows_;                        ///< Rows in the matrix
+    size_t cols_;                        ///< Columns in the matrix
+    size_t rows_pushed_;                 ///< Rows pushed so far
+    basic_row_sink<T> *sink_;            ///< Destination of coefficients
+    std::vector<line_stream> streams_;   ///< Column transform of each level
+    std::vector<level_hook> hooks_;      ///< Hook for each level's column transform
+    std::vector<T> row_;                 ///< Row read from a source
+  };
+
+  typedef basic_row_source<double>         row_source;
+  typedef basic_row_sink<double>           row_sink;
+  typedef basic_istream_row_source<double> istream_row_source;
+  typedef basic_ostream_row_sink<double>   ostream_row_sink;
+  typedef basic_matrix_row_sink<double>    matrix_row_sink;
+  typedef basic_wt_stream<double>          wt_stream;
+
+  typedef basic_row_source<float>          row_source_f;
+  typedef basic_row_sink<float>            row_sink_f;
+  typedef basic_istream_row_source<float>  istream_row_source_f;
+  typedef basic_ostream_row_sink<float>    ostream_row_sink_f;
+  typedef basic_matrix_row_sink<float>     matrix_row_sink_f;
+  typedef basic_wt_stream<float>           wt_stream_f;
+
+} // namespace nami
+
+#endif // WT_STREAM_H
@@ -0,0 +1,182 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_append.h"
+#include "ezw_encoder.h"
+#include "matrix_utils.h"
+#include "two_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-12;
+
+bool verbose = false;
+
+
+void fill_matrix(nami_matrix& mat, size_t rows, size_t cols) {
+  mat.resize(rows, cols);
+  srand(400);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX) * 0.1 + 0.01*i*i - 0.02*i*j + sin(j * 0.3));
+    }
+  }
+}
+
+
+/// Appends rows one at a time, taking a snapshot after each, and checks every 
+/// snapshot against wt_lift on the rows so far.
+template <class S>
+bool test_append(size_t rows, size_t cols, int level) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  wt_lift lift;
+  lift.set_scheme<S>();
+  wt_append wt(cols, level);
+  wt.set_scheme<S>();
+
+  double max_err = 0;
+  size_t snapshots = 0;
+  nami_matrix snap, expected;
+  for (size_t r=0; r < rows; r++) {
+    wt.append_row(&mat(r, 0));
+    if (wt.level() > levels_to_one(max(r+1, cols))) continue;
+
+    wt.snapshot(snap);
+    expected.resize(r+1, cols);
+    for (size_t i=0; i <= r; i++) {
+      for (size_t j=0; j < cols; j++) expected(i,j) = mat(i,j);
+    }
+    lift.fwt_2d(expected, wt.level());
+    max_err = max(max_err, matrix_utils::nrmse(expected, snap));
+    snapshots++;
+  }
+
+  bool pass = (max_err <= TOLERANCE && snapshots > 0 && wt.rows() == rows);
+  if (verbose) cout << setw(6) << S::name() << " " << rows << " x " << cols << ", " 
+                    << wt.level() << " levels, " << snapshots << " snapshots:  \t" 
+                    << setw(16) << max_err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// A snapshot codes to the same bytes as the whole matrix transformed at once.
+bool test_encode(size_t rows, size_t cols) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  wt_append wt(cols);
+  for (size_t r=0; r < rows; r++) {
+    wt.append_row(&mat(r, 0));
+  }
+  nami_matrix snap;
+  int level = wt.snapshot(snap);
+
+  wt_lift lift;
+  lift.fwt_2d(mat, level);
+
+  ezw_encoder encoder;
+  ostringstream snap_out, mat_out;
+  encoder.encode(snap, snap_out, level);
+  encoder.encode(mat, mat_out, level);
+
+  bool pass = (snap_out.str() == mat_out.str());
+  if (verbose) cout << "encode " << rows << " x " << cols << ":  \t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Single-precision rows.
+bool test_float(size_t rows, size_t cols) {
+  nami_matrix_f mat(rows, cols);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = (float)(i * 0.5 + cos(j * 0.2));
+    }
+  }
+
+  wt_append_f wt(cols, 3);
+  for (size_t r=0; r < rows; r++) {
+    wt.append_row(&mat(r, 0));
+  }
+  nami_matrix_f snap;
+  wt.snapshot(snap);
+
+  wt_lift_f lift;
+  lift.fwt_2d(mat, 3);
+
+  double err = 0;
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      err = max(err, (double)fabs(mat(i,j) - snap(i,j)));
+    }
+  }
+  bool pass = (err <= 1e-3);
+  if (verbose) cout << "float " << rows << " x " << cols << ":  \t" << setw(16) << err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks that wt_append's snapshots of a growing matrix match wt_lift.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_append<cdf97>(100, 64, -1)) pass = false;
+  if (!test_append<cdf97>(90, 37, 3))   pass = false;
+  if (!test_append<cdf53>(70, 32, -1))  pass = false;
+  if (!test_append<haar>(70, 20, -1))   pass = false;
+  if (!test_append<cdf97>(40, 16, 1))   pass = false;
+  if (!test_append<cdf97>(20, 1, -1))   pass = false;
+  if (!test_append<cdf97>(20, 8, 0))    pass = false;
+
+  if (!test_encode(150, 64)) pass = false;
+  if (!test_float(77, 50))   pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_batch.h"
+#include "ezw_encoder.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+template <class T>
+void fill_batch(vector<T>& data, size_t count, size_t rows, size_t cols) {
+  data.resize(count * rows * cols);
+  srand(20);
+  for (size_t m=0; m < count; m++) {
+    for (size_t i=0; i < rows; i++) {
+      for (size_t j=0; j < cols; j++) {
+        data[(m * rows + i) * cols + j] = (T)(sin(0.1 * (m + 1) * i) + cos(0.2 * j) 
+                                              + 0.1 * (rand() / (double)RAND_MAX));
+      }
+    }
+  }
+}
+
+
+/// Transforms a batch, and checks each matrix against wt_lift on it alone.  Then
+/// inverts <iwt_level> levels of the batch and checks against wt_lift again.
+template <class T, class S>
+bool test_batch(size_t count, size_t rows, size_t cols, int level = -1, int iwt_level = -1,
+                size_t group = 0, size_t threads = 1) {
+  vector<T> data, orig;
+  fill_batch(data, count, rows, cols);
+  orig = data;
+
+  basic_wt_batch<T> batch;
+  batch.template set_scheme<S>();
+  batch.set_group_size(group);
+  batch.set_threads(threads);
+  const int levels = batch.fwt_2d(&data[0], count, rows, cols, level);
+
+  basic_wt_lift<T> lift;
+  lift.template set_scheme<S>();
+  double err = 0;
+  vector<T> expected(orig);
+  for (size_t m=0; m < count; m++) {
+    basic_matrix_view<T> mat(&expected[m * rows * cols], rows, cols);
+    lift.fwt_2d(mat, level);
+  }
+  for (size_t i=0; i < data.size(); i++) {
+    err = max(err, (double)fabs(data[i] - expected[i]));
+  }
+
+  batch.iwt_2d(&data[0], count, rows, cols, levels, iwt_level);
+  double inv_err = 0;
+  for (size_t m=0; m < count; m++) {
+    basic_matrix_view<T> mat(&expected[m * rows * cols], rows, cols);
+    lift.iwt_2d(mat, levels, iwt_level);
+  }
+  for (size_t i=0; i < data.size(); i++) {
+    inv_err = max(inv_err, (double)fabs(data[i] - expected[i]));
+  }
+
+  bool pass = (err == 0 && inv_err == 0);
+  if (verbose) cout << setw(6) << S::name() << (sizeof(T) == 4 ? " float  " : " double ") 
+                    << setw(4) << count << " x " << rows << " x " << cols << ", " 
+                    << levels << " levels, group " << group << ", " << threads 
+                    << " threads:  \t" << err << "\t" << inv_err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// The batched encoder writes the same streams as encoding each matrix alone.
+template <class T>
+bool test_encode(size_t count, size_t rows, size_t cols) {
+  vector<T> data;
+  fill_batch(data, count, rows, cols);
+  basic_wt_batch<T> batch;
+  batch.fwt_2d(&data[0], count, rows, cols);
+
+  ezw_encoder encoder;
+  encoder.set_scale(1000);
+  vector<ostringstream*> streams(count);
+  vector<ostream*> out(count);
+  for (size_t m=0; m < count; m++) {
+    out[m] = streams[m] = new ostringstream();
+  }
+  const size_t bytes = encoder.encode(&data[0], count, rows, cols, out);
+
+  bool pass = true;
+  size_t total = 0;
+  for (size_t m=0; m < count; m++) {
+    ezw_encoder single;
+    single.set_scale(1000);
+    ostringstream expected;
+    basic_matrix_view<T> mat(&data[m * rows * cols], rows, cols);
+    single.encode(mat, expected);
+    if (expected.str() != streams[m]->str()) pass = false;
+    total += streams[m]->str().size();
+    delete streams[m];
+  }
+  if (total != bytes) pass = false;
+
+  if (verbose) cout << "encode " << count << " x " << rows << " x " << cols << ": " 
+                    << bytes << " bytes\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks wt_batch and the batched encoder against wt_lift and 
+/// ezw_encoder on each matrix alone.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_batch<double, cdf97>(100, 32, 32))          pass = false;
+  if (!test_batch<double, cdf97>(20, 64, 64))           pass = false;
+  if (!test_batch<double, cdf97>(7, 128, 128))          pass = false;
+  if (!test_batch<double, cdf97>(13, 37, 50))           pass = false;
+  if (!test_batch<double, cdf97>(10, 1, 16))            pass = false;
+  if (!test_batch<double, cdf97>(10, 16, 1))            pass = false;
+  if (!test_batch<double, cdf97>(40, 32, 32, 3, 1))     pass = false;
+  if (!test_batch<double, cdf97>(40, 32, 32, 2, -1, 3)) pass = false;
+  if (!test_batch<double, cdf97>(50, 32, 32, -1, -1, 5, 4)) pass = false;
+  if (!test_batch<double, cdf53>(30, 33, 32))           pass = false;
+  if (!test_batch<double, haar>(30, 16, 16))            pass = false;
+  if (!test_batch<float,  cdf97>(60, 64, 64))           pass = false;
+
+  if (!test_encode<double>(25, 32, 32)) pass = false;
+  if (!test_encode<float>(10, 64, 64))  pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -87,7 +87,7 @@ bool test_ezw(size_t rows, size_t cols) {
   // read in same file and deocde
   ifstream in(FILENAME);
   nami_matrix decoded;
-  level = decoder.decode(in, decoded);
+  int decoded_level = decoder.decode(in, decoded);
 
   // check that we get out what we put in.
   double nerr = matrix_utils::nrmse(trans, decoded);
@@ -106,7 +106,40 @@ bool test_ezw(size_t rows, size_t cols) {
   test_err_sum += nerr;
   test_ratio_sum += ratio;
 
-  return (nerr == 0);
+  return (nerr == 0 && decoded_level == level);
+}
+
+
+/// Transforms a rows x cols matrix at its default level, codes it, decodes it, and 
+/// inverts the transform at the level the decoder returns.  Sides that aren't 
+/// divisible by 2 as often as the transform goes deep still get all their levels
+/// undone.
+bool test_round_trip(size_t rows, size_t cols) {
+  nami_matrix mat(rows, cols);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = 5+i+0.4*i*i-0.02*i*j;
+    }
+  }
+
+  nami_matrix trans = mat;
+  int level = lift.fwt_2d(trans);
+
+  ofstream out(FILENAME);
+  encoder.encode(trans, out, level);
+  out.close();
+
+  ifstream in(FILENAME);
+  nami_matrix decoded;
+  int decoded_level = decoder.decode(in, decoded);
+  lift.iwt_2d(decoded, decoded_level);
+
+  double nerr = matrix_utils::nrmse(mat, decoded);
+  if (verbose) {
+    cout << "Round trip " << rows << " x " << cols << ", level " << level 
+         << " decoded as " << decoded_level << ":  \t" << nerr << endl;
+  }
+  return (decoded_level == level && nerr < 1e-3);
 }
 
 
@@ -142,6 +175,14 @@ int main(int argc, char **argv) {
             pass = false;
           }
   
+  size_t odd_sizes[] = {40, 37, 52, 41, 64};
+  size_t num_odd_sizes = (sizeof(odd_sizes) / sizeof(size_t));
+  for (size_t r=0; r < num_odd_sizes; r++) {
+    for (size_t c=0; c < num_odd_sizes; c++) {
+      if (!test_round_trip(odd_sizes[r], odd_sizes[c])) pass = false;
+    }
+  }
+
   if (verbose) {
     cout << endl;
     cout << "Mean Normalized RMSE:  \t" << setw(10) << test_err_sum/test_count << endl;
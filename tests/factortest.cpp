@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "lift_factor.h"
+#include "cdf97.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+/// Steps come from taps given to about 12 digits.
+static const double STEP_TOLERANCE = 1.0e-9;
+
+/// Factored lifting and direct convolution agree to roughly the precision of the taps.
+static const double TOLERANCE = 1.0e-9;
+
+bool verbose = false;
+
+
+/// CDF 5/3 in the layout of filter_bank, with synthesis filters to match.
+static const double cdf53_lpf[]  = { -0.125, 0.25, 0.75, 0.25, -0.125 };
+static const double cdf53_hpf[]  = { 0, -0.5, 1, -0.5, 0 };
+static const double cdf53_ilpf[] = { 0, 0.5, 1, 0.5, 0 };
+static const double cdf53_ihpf[] = { -0.125, -0.25, 0.75, -0.25, -0.125 };
+
+
+/// Checks that factoring a bank gives the steps of static scheme S, and the
+/// expected scaling of each band.
+template <class S>
+bool test_steps(const filter_bank& bank, double low_scale, double high_scale) {
+  lift_scheme scheme;
+  bool pass = factor_lifting(bank, scheme) && scheme.steps() == S::steps;
+  for (int k=0; pass && k < S::steps; k++) {
+    if (scheme.type(k) != S::type(k))                             pass = false;
+    if (fabs(scheme.coeff(k) - S::coeff(k)) > STEP_TOLERANCE)     pass = false;
+  }
+  if (pass) {
+    if (fabs(scheme.low_scale()  - low_scale)  > STEP_TOLERANCE) pass = false;
+    if (fabs(scheme.high_scale() - high_scale) > STEP_TOLERANCE) pass = false;
+  }
+
+  if (verbose) cout << setw(8) << S::name() << " steps:\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Transforms a rows x cols matrix with wt_direct on the bank and with wt_lift on 
+/// its factored scheme, and checks that both directions agree.
+bool test_transform(const char *name, filter_bank& bank, size_t rows, size_t cols, int level) {
+  nami_matrix mat(rows, cols);
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  lift_scheme scheme;
+  if (!factor_lifting(bank, scheme)) return false;
+  wt_lift lift;
+  lift.set_scheme(scheme);
+  wt_direct direct(bank);
+
+  nami_matrix lifted = mat, convolved = mat;
+  lift.fwt_2d(lifted, level);
+  direct.fwt_2d(convolved, level);
+  double fwt_err = matrix_utils::nrmse(convolved, lifted);
+  bool fwt_pass = (fwt_err <= TOLERANCE);
+
+  // invert the same coefficients both ways
+  lifted = convolved;
+  lift.iwt_2d(lifted, level);
+  direct.iwt_2d(convolved, level);
+  double iwt_err = max(matrix_utils::nrmse(convolved, lifted), matrix_utils::nrmse(mat, lifted));
+  bool iwt_pass = (iwt_err <= TOLERANCE);
+
+  if (verbose) cout << setw(8) << name << " " << rows << " x " << cols 
+                    << ", " << level << " levels:\t"
+                    << setw(16) << fwt_err 
+                    << "\t" << (fwt_pass ? "PASS" : "FAIL") 
+                    << setw(16) << iwt_err 
+                    << "\t" << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// Banks that two-tap symmetric steps can't express are refused, and the scheme 
+/// passed in is left alone.
+bool test_refused() {
+  const double lpf[] = { 0, 0, 0.5, 0.5, 0 };      // Haar, not symmetric about its center
+  const double hpf[] = { 0, 0, -0.5, 0.5, 0 };
+  filter_bank haar_bank(5, lpf, hpf);
+
+  const double wide_lpf[] = { 0.1, 0, 0, 0, 0.8, 0, 0, 0, 0.1 };   // lengths differ by 8
+  const double wide_hpf[] = { 0, 0, 0, 0, 1, 0, 0, 0, 0 };
+  filter_bank wide_bank(9, wide_lpf, wide_hpf);
+
+  lift_scheme scheme = lift_scheme::of<cdf53>();
+  bool pass = !factor_lifting(haar_bank, scheme) && !factor_lifting(wide_bank, scheme)
+    && !strcmp(scheme.name(), "cdf53");
+
+  if (verbose) cout << " refused:\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks that filter banks factored into lifting steps give the 
+/// hand-written schemes, and transform like the banks themselves.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  filter_bank& cdf97_bank = filter::getCDF97();
+  filter_bank cdf53_bank(5, cdf53_lpf, cdf53_hpf, cdf53_ilpf, cdf53_ihpf);
+
+  // getCDF97() is scaled to match the lifting scheme; the 5/3 bank is not scaled.
+  if (!test_steps<cdf97>(cdf97_bank, cdf97::scale(), cdf97::scale())) pass = false;
+  if (!test_steps<cdf53>(cdf53_bank, 1.0, 1.0))                       pass = false;
+  if (!test_refused()) pass = false;
+
+  size_t sizes[] = {16, 17, 40, 45, 136, 256};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t r=0; r < num_sizes; r++) {
+    for (size_t c=0; c < num_sizes; c++) {
+      for (int level=1; level <= 3; level += 2) {
+        if (!test_transform("cdf97", cdf97_bank, sizes[r], sizes[c], level)) pass = false;
+        if (!test_transform("cdf53", cdf53_bank, sizes[r], sizes[c], level)) pass = false;
+      }
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,134 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-5;   // single precision vs. double
+
+bool verbose = false;
+
+ezw_encoder encoder;
+ezw_decoder decoder;
+
+
+/// Runs the float instantiation of transform W_F alongside the double one, W, on a 
+/// rows x cols matrix.  Checks that the coefficients agree to single precision, that
+/// the float inverse undoes the transform, and that float data goes through the 
+/// EZW coder like double data does.
+template <class W, class W_F>
+bool test_float(const char *name, size_t rows, size_t cols) {
+  W wt;
+  W_F wt_f;
+  nami_matrix mat(rows, cols);
+  nami_matrix_f mat_f(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat_f(i,j) = mat(i,j) = (float)((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  nami_matrix trans = mat;
+  nami_matrix_f trans_f = mat_f;
+  int level = wt.fwt_2d(trans);
+  wt_f.fwt_2d(trans_f, level);
+  double fwt_err = matrix_utils::nrmse(trans, trans_f);
+  bool fwt_pass = (fwt_err <= TOLERANCE);
+
+  nami_matrix_f iwt_f = trans_f;
+  wt_f.iwt_2d(iwt_f, level);
+  double iwt_err = matrix_utils::nrmse(mat_f, iwt_f);
+  bool iwt_pass = (iwt_err <= TOLERANCE);
+
+  // float and double coefficients should code to the same size and quality.
+  ostringstream out, out_f;
+  encoder.encode(trans, out, level);
+  encoder.encode(trans_f, out_f, level);
+
+  istringstream in(out.str()), in_f(out_f.str());
+  nami_matrix decoded;
+  nami_matrix_f decoded_f;
+  decoder.decode(in, decoded);
+  decoder.decode(in_f, decoded_f);
+  double ezw_err = matrix_utils::nrmse(decoded, decoded_f);
+  bool ezw_pass = (decoded_f.size1() == rows && decoded_f.size2() == cols && 
+                   ezw_err <= TOLERANCE);
+
+  if (verbose) cout << setw(10) << name << " " << rows << " x " << cols << ":  \t"
+                    << setw(16) << fwt_err 
+                    << "\t" << (fwt_pass ? "PASS" : "FAIL") 
+                    << setw(16) << iwt_err 
+                    << "\t" << (iwt_pass ? "PASS" : "FAIL")
+                    << setw(16) << ezw_err 
+                    << "\t" << (ezw_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass && ezw_pass);
+}
+
+
+/// This test checks that the single-precision transforms and EZW coding path 
+/// agree with the double-precision ones.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t sizes[] = {4, 16, 34, 64, 136, 256};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t r=0; r < num_sizes; r++) {
+    for (size_t c=0; c < num_sizes; c++) {
+      if (!test_float<wt_lift, wt_lift_f>("lift", sizes[r], sizes[c]))       pass = false;
+      if (!test_float<wt_direct, wt_direct_f>("direct", sizes[r], sizes[c])) pass = false;
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+template <class T>
+void fill(boost::numeric::ublas::matrix<T>& mat, size_t rows, size_t cols) {
+  mat.resize(rows, cols);
+  srand(22);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = (T)(10 * sin(0.05 * i) + 5 * cos(0.1 * j) + rand() / (double)RAND_MAX);
+    }
+  }
+}
+
+
+/// Transforming and quantizing in one pass gives the same stream as transforming
+/// and then encoding.  Sizes are padded by <pad> columns to check the pitch.
+template <class T>
+bool test_fused(size_t rows, size_t cols, int level = -1, size_t threads = 1, size_t pad = 0) {
+  boost::numeric::ublas::matrix<T> mat, wide(rows, cols + pad);
+  fill(mat, rows, cols);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      wide(i,j) = mat(i,j);
+    }
+  }
+
+  basic_wt_lift<T> wt;
+  wt.set_threads(threads);
+  ezw_encoder encoder;
+  encoder.set_scale(1000);
+
+  ostringstream expected;
+  level = wt.fwt_2d(mat, level);
+  encoder.encode(mat, expected, level);
+
+  ostringstream fused;
+  basic_matrix_view<T> view(&wide(0,0), rows, cols, cols + pad);
+  const size_t bytes = encoder.encode(wt, view, fused, level);
+
+  bool pass = (fused.str() == expected.str() && bytes == fused.str().size());
+  if (verbose) cout << (sizeof(T) == 4 ? "float  " : "double ") << setw(4) << rows 
+                    << " x " << setw(4) << cols << ", level " << level << ", " << threads 
+                    << " threads, pad " << pad << ":\t" << bytes << " bytes\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// A constant matrix codes as just its mean.
+bool test_constant() {
+  nami_matrix mat(16, 16);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = 3;
+    }
+  }
+  wt_lift wt;
+  ezw_encoder encoder;
+  encoder.set_scale(1000);
+  stringstream code;
+  const int level = wt.fwt_2d(mat);
+  encoder.encode(mat, code, level);
+
+  ezw_decoder decoder;
+  nami_matrix decoded;
+  decoder.decode(code, decoded);
+  wt.iwt_2d(decoded, level);
+  
+  double err = 0;
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      err = max(err, fabs(decoded(i,j) - 3));
+    }
+  }
+  bool pass = (err < 1e-3);
+  if (verbose) cout << "constant matrix:\terr " << err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks that ezw_encoder::encode() with a transform writes the same
+/// stream as transforming with wt_lift and encoding afterwards.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_fused<double>(64, 64))            pass = false;
+  if (!test_fused<double>(256, 256))          pass = false;
+  if (!test_fused<double>(256, 256, 3))       pass = false;
+  if (!test_fused<double>(100, 70))           pass = false;
+  if (!test_fused<double>(70, 100, 2))        pass = false;
+  if (!test_fused<double>(1, 64))             pass = false;
+  if (!test_fused<double>(64, 1))             pass = false;
+  if (!test_fused<double>(129, 255, -1, 4))   pass = false;
+  if (!test_fused<double>(128, 96, -1, 1, 5)) pass = false;
+  if (!test_fused<float>(200, 200))           pass = false;
+  if (!test_fused<float>(33, 65, 4, 2, 3))    pass = false;
+  if (!test_constant())                       pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,149 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.
+//
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <iomanip>
+#include <string.h>
+
+#include <mpi.h>
+
+#include "par_wt.h"
+#include "wt_direct.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+/// Transforms blocks of a matrix distributed over a process grid of the given
+/// dimensions at all levels, and checks them against the sequential transform.
+/// Also checks that scatter() undoes gather().
+bool test_grid(int dims[2], bool verbose) {
+  int periods[2] = { 0, 0 };
+  MPI_Comm grid;
+  MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 0, &grid);
+
+  int rank, coords[2];
+  MPI_Comm_rank(grid, &rank);
+  MPI_Cart_coords(grid, rank, 2, coords);
+
+  bool pass = true;
+  par_wt pwt;
+  wt_direct dwt;
+
+  nami_matrix mat(64, 64);  // this process's block of the matrix
+  for (int level = -1; level != 0; level--) {
+    for (size_t i=0; i < mat.size1(); i++) {
+      for (size_t j=0; j < mat.size2(); j++) {
+        double gi = coords[0] * mat.size1() + i;
+        double gj = coords[1] * mat.size2() + j;
+        mat(i,j) = 5 + gi + 0.4*gi*gi - 0.02*gi*gj + 0.3*gj;
+      }
+    }
+
+    nami_matrix original;
+    par_wt::gather(original, mat, grid);
+
+    // scattering the gathered matrix gives each process back its own block.
+    nami_matrix block;
+    par_wt::scatter(block, original, grid);
+    int local_scatter = (matrix_utils::nrmse(mat, block) == 0), all_scatter;
+    MPI_Allreduce(&local_scatter, &all_scatter, 1, MPI_INT, MPI_MIN, grid);
+    if (!all_scatter) pass = false;
+
+    level = pwt.fwt_2d(mat, level, grid);
+
+    nami_matrix localwt;
+    nami_matrix par_fwt;
+    par_wt::gather(par_fwt, mat, grid);
+    if (rank == 0) {
+      localwt = original;
+      dwt.fwt_2d(localwt, level);
+      par_wt::reassemble(par_fwt, dims[0], dims[1], level);
+
+      double err = matrix_utils::nrmse(localwt, par_fwt);
+      if (err > 0) pass = false;
+      if (verbose) {
+        cout << dims[0] << "x" << dims[1] << " grid level " << level 
+             << " NRMSE: " << setw(12) << err;
+      }
+    }
+
+    pwt.iwt_2d(mat, level, grid);
+
+    nami_matrix par_iwt;
+    par_wt::gather(par_iwt, mat, grid);
+    if (rank == 0) {
+      dwt.iwt_2d(localwt, level);
+      double err = matrix_utils::nrmse(localwt, par_iwt);
+      if (err > 0) pass = false;
+      if (verbose) {
+        cout << setw(12) << err << "   scatter " << (all_scatter ? "PASS" : "FAIL") << endl;
+      }
+    }
+  }
+
+  MPI_Comm_free(&grid);
+  return pass;
+}
+
+
+/// This verifies that the parallel wavelet transform on a 2d process grid 
+/// produces exactly the same output as the convolving transform.
+int main(int argc, char **argv) {
+  MPI_Init(&argc, &argv);
+
+  bool verbose = false;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // grid as square as possible, then the same grid turned on its side.
+  int dims[2] = { 0, 0 };
+  MPI_Dims_create(size, 2, dims);
+  bool pass = test_grid(dims, verbose);
+
+  swap(dims[0], dims[1]);
+  pass = test_grid(dims, verbose) && pass;
+
+  if (verbose && rank == 0) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  int exit_code = (pass ? 0 : 1);
+  MPI_Bcast(&exit_code, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Finalize();
+
+  exit(exit_code);
+}
@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "filter_kernels.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+/// Checks sym_fir_kernel<N> against fir_kernel on random data, for a random
+/// symmetric filter of length N, with contiguous and strided input.
+template <class T, size_t N>
+bool test_kernel(const char *type, double tolerance) {
+  double f[N];
+  for (size_t d=0; d < (N+1)/2; d++) {
+    f[d] = f[N-1-d] = (rand()/(double)RAND_MAX) - 0.5;
+  }
+
+  const size_t stride = 3;
+  vector<T> x(N * stride);
+  for (size_t i=0; i < x.size(); i++) {
+    x[i] = T((rand()/(double)RAND_MAX) * 10 - 5);
+  }
+
+  sym_fir_kernel<N> folded;
+  fir_kernel generic(N);
+  double err = 0;
+  for (size_t s=1; s <= stride; s += stride-1) {
+    err = max(err, fabs(double(folded(f, &x[0], s) - generic(f, &x[0], s))));
+  }
+
+  bool pass = is_symmetric(f, N) && err <= tolerance;
+  if (N > 1) {
+    f[0] += 1;
+    if (is_symmetric(f, N)) pass = false;
+  }
+
+  if (verbose) cout << setw(6) << type << " " << setw(2) << N << " taps:  \t"
+                    << "error " << err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+template <class T>
+bool test_type(const char *type, double tolerance) {
+  bool pass = true;
+  pass &= test_kernel<T, 1>(type, tolerance);
+  pass &= test_kernel<T, 2>(type, tolerance);
+  pass &= test_kernel<T, 3>(type, tolerance);
+  pass &= test_kernel<T, 4>(type, tolerance);
+  pass &= test_kernel<T, 5>(type, tolerance);
+  pass &= test_kernel<T, 8>(type, tolerance);
+  pass &= test_kernel<T, 9>(type, tolerance);
+  pass &= test_kernel<T, 13>(type, tolerance);
+  return pass;
+}
+
+
+/// This test checks that the folded, fixed-length convolution kernels agree
+/// with the generic tap loop.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  srand(100);
+  pass &= test_type<double>("double", 1e-12);
+  pass &= test_type<float>("float", 1e-4);
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,144 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "wt_lift.h"
+#include "lift_scheme.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+/// wt_lift with wt_2d's level-by-level loop exposed, for comparison.
+template <class T>
+struct loop_lift : public basic_wt_lift<T> {
+  typedef typename basic_wt_lift<T>::matrix_type matrix_type;
+
+  int loop_fwt_2d(matrix_type& mat, int level = -1) {
+    return basic_wt_2d<T>::do_fwt_2d(mat, level);
+  }
+
+  int loop_iwt_2d(matrix_type& mat, int fwt_level = -1, int iwt_level = -1) {
+    return basic_wt_2d<T>::do_iwt_2d(mat, fwt_level, iwt_level);
+  }
+};
+
+
+/// True if a and b hold exactly the same values.
+template <class M>
+bool same(const M& a, const M& b) {
+  return equal(a.data().begin(), a.data().end(), b.data().begin());
+}
+
+
+/// Transforms a rows x cols matrix with wt_lift's fused fwt_2d() and iwt_2d(), and
+/// with the level-by-level loop in wt_2d, and checks that they agree exactly.  The
+/// inverse is checked one level at a time, then for all remaining levels.
+template <class T, class S>
+bool test_levels(size_t threads, size_t rows, size_t cols) {
+  typedef typename basic_wt_lift<T>::matrix_type matrix_type;
+  loop_lift<T> wt;
+  wt.template set_scheme<S>();
+  wt.set_threads(threads);
+  matrix_type mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  matrix_type expected = mat;
+  matrix_type actual = mat;
+  int level = wt.loop_fwt_2d(expected);
+  wt.fwt_2d(actual);
+  bool fwt_pass = same(expected, actual);
+
+  bool iwt_pass = true;
+  if (level > 1) {
+    wt.loop_iwt_2d(expected, level, 1);
+    wt.iwt_2d(actual, level, 1);
+    iwt_pass = same(expected, actual);
+    level--;
+  }
+  wt.loop_iwt_2d(expected, level);
+  wt.iwt_2d(actual, level);
+  iwt_pass = iwt_pass && same(expected, actual);
+
+  if (verbose) cout << setw(8) << wt.scheme_name() << " " << setw(6) << sizeof(T) 
+                    << " bytes, " << threads << " threads, " << rows << " x " << cols 
+                    << ":  \t" << "FWT " << (fwt_pass ? "PASS" : "FAIL") 
+                    << "\tIWT " << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// This test checks that wt_lift's fused multi-level 2d transforms give exactly
+/// the same coefficients as the level-by-level loop.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t threads[] = {1, 3};
+  size_t num_threads = (sizeof(threads) / sizeof(size_t));
+
+  size_t sizes[] = {2, 6, 17, 34, 136, 256, 394, 1024, 2050};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t t=0; t < num_threads; t++) {
+    for (size_t r=0; r < num_sizes; r++) {
+      for (size_t c=0; c < num_sizes; c++) {
+        if (sizes[r] * sizes[c] > (1 << 20)) continue;
+        if (!test_levels<double, cdf97>(threads[t], sizes[r], sizes[c])) pass = false;
+        if (!test_levels<double, cdf53>(threads[t], sizes[r], sizes[c])) pass = false;
+        if (!test_levels<double, haar>(threads[t], sizes[r], sizes[c]))  pass = false;
+        if (!test_levels<float, cdf97>(threads[t], sizes[r], sizes[c]))  pass = false;
+      }
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,186 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "lift_scheme.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-12;
+
+bool verbose = false;
+
+wt_lift lift;
+
+
+/// Straightforward lifting of one signal, one step at a time, for reference.
+/// Odd lengths have one more low value than high; the samples past either end
+/// are mirrored.
+template <class S>
+void reference_fwt(vector<double>& x) {
+  const size_t h  = (x.size() + 1) / 2;
+  const size_t hd = x.size() / 2;
+  vector<double> s(h), d(hd);
+  for (size_t i=0; i < h; i++)  s[i] = x[2*i];
+  for (size_t i=0; i < hd; i++) d[i] = x[2*i+1];
+
+  for (int k=0; k < S::steps; k++) {
+    const double a = S::coeff(k);
+    switch (S::type(k)) {
+    case PREDICT_1: 
+      for (size_t i=0; i < hd; i++) d[i] += a * s[i];
+      break;
+    case PREDICT_2: 
+      for (size_t i=0; i < hd; i++) d[i] += a * (s[i] + s[(i+1 < h) ? i+1 : i]);
+      break;
+    case UPDATE_1: 
+      for (size_t i=0; i < h; i++) s[i] += a * d[min(i, hd-1)];
+      break;
+    case UPDATE_2: 
+      for (size_t i=0; i < h; i++) s[i] += a * (d[i ? i-1 : 0] + d[min(i, hd-1)]);
+      break;
+    }
+  }
+
+  for (size_t i=0; i < h; i++)  x[i]   = s[i] * S::scale();
+  for (size_t i=0; i < hd; i++) x[h+i] = d[i] / S::scale();
+}
+
+
+/// Compares a one-level transform with scheme S on a rows x cols matrix to the 
+/// reference transform, and checks that the inverse undoes it.  Large sizes go
+/// through the sweeps in several blocks.
+template <class S>
+bool test_scheme(size_t rows, size_t cols) {
+  nami_matrix mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  nami_matrix expected = mat;
+  vector<double> v;
+  if (cols > 1) {
+    for (size_t i=0; i < rows; i++) {
+      v.assign(&expected(i,0), &expected(i,0) + cols);
+      reference_fwt<S>(v);
+      copy(v.begin(), v.end(), &expected(i,0));
+    }
+  }
+  if (rows > 1) {
+    v.resize(rows);
+    for (size_t j=0; j < cols; j++) {
+      for (size_t i=0; i < rows; i++) v[i] = expected(i,j);
+      reference_fwt<S>(v);
+      for (size_t i=0; i < rows; i++) expected(i,j) = v[i];
+    }
+  }
+
+  lift.set_scheme<S>();
+  nami_matrix actual = mat;
+  lift.fwt_2d(actual, 1);
+  double fwt_err = matrix_utils::nrmse(expected, actual);
+  bool fwt_pass = (fwt_err <= TOLERANCE);
+
+  lift.iwt_2d(actual, 1);
+  double iwt_err = matrix_utils::nrmse(mat, actual);
+  bool iwt_pass = (iwt_err <= TOLERANCE);
+
+  if (verbose) cout << setw(8) << lift.scheme_name() 
+                    << " " << rows << " x " << cols << ":  \t"
+                    << setw(16) << fwt_err 
+                    << "\t" << (fwt_pass ? "PASS" : "FAIL") 
+                    << setw(16) << iwt_err 
+                    << "\t" << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// Haar coefficients are simple enough to check by hand.
+bool test_haar() {
+  double data[] = { 1, 3, 4, 8 };
+  wt_1d_lift haar_1d;
+  haar_1d.set_scheme<haar>();
+  haar_1d.fwt_1d(data, 4, 1);
+
+  double expected[] = { 4/M_SQRT2, 12/M_SQRT2, 2/M_SQRT2, 4/M_SQRT2 };
+  bool pass = true;
+  for (size_t i=0; i < 4; i++) {
+    if (fabs(data[i] - expected[i]) > TOLERANCE) pass = false;
+  }
+
+  if (verbose) cout << "haar by hand:\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks the fused lifting sweeps for each scheme in lift_scheme.h
+/// against a plain step-by-step lifting transform.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_haar()) pass = false;
+
+  size_t sizes[] = {2, 3, 4, 6, 12, 17, 34, 136, 394, 1025, 2050, 4096};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t r=0; r < num_sizes; r++) {
+    for (size_t c=0; c < num_sizes; c++) {
+      if (sizes[r] * sizes[c] > (1 << 20)) continue;
+      if (!test_scheme<haar>(sizes[r], sizes[c]))  pass = false;
+      if (!test_scheme<cdf53>(sizes[r], sizes[c])) pass = false;
+      if (!test_scheme<cdf97>(sizes[r], sizes[c])) pass = false;
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
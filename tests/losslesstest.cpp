@@ -0,0 +1,121 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+#include "wt_int53.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+wt_int53 wt;
+ezw_encoder encoder;
+ezw_decoder decoder;
+
+
+/// Runs integer data through the reversible transform and the EZW coder and 
+/// checks that it comes back bit-for-bit.
+bool test_lossless(size_t rows, size_t cols) {
+  quantized_matrix mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = (quantized_t)(1000 * ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*i*j));
+    }
+  }
+
+  // transform alone must be exact
+  quantized_matrix trans = mat;
+  int level = wt.fwt_2d(trans);
+  quantized_matrix iwt = trans;
+  wt.iwt_2d(iwt, level);
+  bool wt_pass = equal(mat.data().begin(), mat.data().end(), iwt.data().begin());
+
+  // so must transform + coding
+  ostringstream out;
+  size_t size = encoder.encode(trans, out, level);
+
+  istringstream in(out.str());
+  quantized_matrix decoded;
+  decoder.decode(in, decoded);
+  wt.iwt_2d(decoded, level);
+  bool ezw_pass = (decoded.size1() == rows && decoded.size2() == cols &&
+                   equal(mat.data().begin(), mat.data().end(), decoded.data().begin()));
+
+  double ratio = (double)(rows * cols * sizeof(quantized_t))/size;
+  if (verbose) cout << rows << " x " << cols << ":  \t"
+                    << "WT " << (wt_pass ? "PASS" : "FAIL") 
+                    << "\tWT_EZW " << (ezw_pass ? "PASS" : "FAIL") 
+                    << "   (" << ratio << ":1)"
+                    << endl;
+
+  return (wt_pass && ezw_pass);
+}
+
+
+/// This test checks that the reversible integer transform and the integer EZW
+/// coding path round-trip data exactly.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  for (size_t r=1; r < 9; r++) {
+    for (size_t c=1; c < 9; c++) {
+      if (!test_lossless(1 << r, 1 << c)) pass = false;
+    }
+  }
+
+  size_t primes[] = {17, 67};
+  size_t num_primes = (sizeof(primes) / sizeof(size_t));
+  for (size_t r=0; r < 4; r++)
+    for (size_t p=0; p < num_primes; p++)
+      for (size_t c=0; c < 4; c++)
+        for (size_t q=0; q < num_primes; q++)
+          if (!test_lossless(primes[p] * (1<<r), primes[q] * (1<<c))) {
+            pass = false;
+          }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,285 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_packet.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+#include "matrix_utils.h"
+#include "two_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-10;
+
+bool verbose = false;
+
+wt_lift lift;
+wt_packet packets(lift);
+ezw_encoder encoder;
+ezw_decoder decoder;
+
+
+/// Smooth data plus a pattern that repeats every 4 columns, like ranks that 
+/// alternate between kinds of work.
+void fill_matrix(nami_matrix& mat, size_t rows, size_t cols) {
+  mat.resize(rows, cols);
+  srand(200);
+  const double pattern[] = {3.0, -1.0, 2.0, -4.0};
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX) * 0.01 + 0.1*i + 0.02*i*j 
+                  + pattern[j % 4] * (1 + 0.01*i));
+    }
+  }
+}
+
+
+/// Scales every value to an integer, so coding is lossless.
+void quantize(nami_matrix& mat) {
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = (long long)(mat(i,j) * 1000);
+    }
+  }
+}
+
+
+/// Trees survive preorder flags and headers, and pyramids look like pyramids.
+bool test_tree() {
+  bool pass = true;
+  
+  packet_tree pyramid(3);
+  pass = pass && (pyramid.size() == 13 && pyramid.depth() == 3 && pyramid.pyramid_level() == 3);
+  pass = pass && (packet_tree(pyramid.preorder()) == pyramid);
+
+  // split the high-high band of the pyramid, and one of its quadrants.
+  vector<bool> flags = pyramid.preorder();
+  flags[flags.size() - 1] = true;
+  flags.insert(flags.end(), 4, false);
+  flags[flags.size() - 2] = true;
+  flags.insert(flags.end(), 4, false);
+  packet_tree tree(flags);
+  pass = pass && (tree.depth() == 3 && tree.pyramid_level() == 3 && tree != pyramid);
+
+  ostringstream out;
+  size_t size = tree.write_out(out);
+  istringstream in(out.str());
+  packet_tree read;
+  packet_tree::read_in(in, read);
+  pass = pass && (size == out.str().size() && read == tree);
+
+  bool threw = false;
+  try {
+    flags.pop_back();
+    packet_tree bad(flags);
+  } catch (std::exception& e) {
+    threw = true;
+  }
+  pass = pass && threw;
+
+  if (verbose) cout << "packet_tree:  \t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// A pyramid basis gives the same coefficients as fwt_2d().
+bool test_pyramid(size_t rows, size_t cols, int level) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  nami_matrix expected = mat;
+  lift.fwt_2d(expected, level);
+  nami_matrix actual = mat;
+  packets.fwt_packet(actual, packet_tree(level));
+  
+  double err = matrix_utils::nrmse(expected, actual);
+  bool pass = (err <= TOLERANCE);
+  if (verbose) cout << "pyramid " << rows << " x " << cols << ", " << level << " levels:  \t" 
+                    << setw(16) << err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// iwt_packet() undoes best_basis(), and fwt_packet() in the chosen basis gives the
+/// same coefficients.
+bool test_best_basis(size_t rows, size_t cols, basis_cost_t cost) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  nami_matrix trans = mat;
+  packet_tree basis = packets.best_basis(trans, -1, cost);
+  nami_matrix again = mat;
+  packets.fwt_packet(again, basis);
+  double fwt_err = matrix_utils::nrmse(trans, again);
+
+  packets.iwt_packet(trans, basis);
+  double err = matrix_utils::nrmse(mat, trans);
+
+  bool pass = (err <= TOLERANCE && fwt_err <= TOLERANCE && basis != packet_tree(basis.depth()));
+  if (verbose) cout << "best basis " << (cost == ENTROPY ? "entropy " : "l1 ") 
+                    << rows << " x " << cols << ", " << basis.size() << " nodes:  \t" 
+                    << setw(16) << err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Counts visits to each value, and never prunes trees.
+struct count_visitor {
+  quantized_matrix *visits;
+  count_visitor(quantized_matrix *v) : visits(v) { }
+  ezw_code operator()(const dom_elt& e) {
+    (*visits)(e.row, e.col)++;
+    return ZERO;
+  }
+};
+
+
+/// Zerotrees over the chosen basis visit every value once.
+bool test_traversal(size_t rows, size_t cols) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+  packet_tree basis = packets.best_basis(mat, min(times_divisible_by_2(rows), 
+                                                  times_divisible_by_2(cols)));
+
+  quantized_matrix visits(rows, cols);
+  visits.clear();
+  depth_first_traversal_packet(count_visitor(&visits), packet_zerotree(basis, rows, cols));
+  
+  bool pass = true;
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      if (visits(i,j) != 1) pass = false;
+    }
+  }
+  if (verbose) cout << "traversal " << rows << " x " << cols << ":  \t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Codes data in its best basis and checks that it decodes exactly, in the same
+/// basis.  The packet code must be smaller than coding the pyramid transform.
+bool test_coding(size_t rows, size_t cols, basis_cost_t cost) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+  const int level = min(times_divisible_by_2(rows), times_divisible_by_2(cols));
+
+  nami_matrix trans = mat;
+  packet_tree basis = packets.best_basis(trans, level, cost);
+  quantize(trans);
+
+  ostringstream out;
+  size_t packet_size = encoder.encode(trans, basis, out);
+  istringstream in(out.str());
+  nami_matrix decoded;
+  decoder.decode(in, decoded);
+  bool exact = (decoder.basis() == basis && matrix_utils::nrmse(trans, decoded) == 0);
+
+  nami_matrix pyramid = mat;
+  lift.fwt_2d(pyramid, level);
+  quantize(pyramid);
+  ostringstream pyramid_out;
+  size_t pyramid_size = encoder.encode(pyramid, pyramid_out, level);
+  bool smaller = (packet_size < pyramid_size);
+
+  if (verbose) cout << "coding " << (cost == ENTROPY ? "entropy " : "l1 ") << rows << " x " << cols << ":  \t" 
+                    << "packets " << packet_size << " bytes, pyramid " << pyramid_size << " bytes\t"
+                    << (exact ? "PASS" : "FAIL") << "\t" << (smaller ? "PASS" : "FAIL") << endl;
+  return exact && smaller;
+}
+
+
+/// Coding in a pyramid basis is the same as coding without one.
+bool test_pyramid_coding(size_t rows, size_t cols, int level) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+  lift.fwt_2d(mat, level);
+  quantize(mat);
+
+  ostringstream packet_out, pyramid_out;
+  size_t packet_size = encoder.encode(mat, packet_tree(level), packet_out);
+  size_t pyramid_size = encoder.encode(mat, pyramid_out, level);
+
+  istringstream in(packet_out.str());
+  nami_matrix decoded;
+  decoder.decode(in, decoded);
+
+  // only the header differs, by the flags of the tree.
+  const size_t tree_bytes = 1 + (packet_tree(level).size() + 7) / 8;
+  bool pass = (packet_size == pyramid_size + tree_bytes && matrix_utils::nrmse(mat, decoded) == 0);
+  if (verbose) cout << "pyramid coding " << rows << " x " << cols << ":  \t" 
+                    << packet_size << " / " << pyramid_size << " bytes\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks wavelet packet bases, best-basis search, and their zerotree 
+/// coding.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_tree()) pass = false;
+
+  if (!test_pyramid(64, 64, 3))  pass = false;
+  if (!test_pyramid(37, 20, 4))  pass = false;
+
+  if (!test_best_basis(64, 64, ENTROPY)) pass = false;
+  if (!test_best_basis(64, 64, L1_NORM)) pass = false;
+  if (!test_best_basis(45, 30, ENTROPY)) pass = false;
+
+  if (!test_traversal(64, 64))  pass = false;
+  if (!test_traversal(32, 128)) pass = false;
+
+  if (!test_pyramid_coding(64, 64, 4)) pass = false;
+
+  if (!test_coding(64, 64, ENTROPY))   pass = false;
+  if (!test_coding(128, 128, ENTROPY)) pass = false;
+  if (!test_coding(128, 64, L1_NORM))  pass = false;
+  if (!test_coding(32, 32, L1_NORM))   pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,188 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+
+#include "nami_matrix.h"
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+/// True if padded holds exactly the values in mat.
+template <class T>
+bool same(const basic_padded_matrix<T>& padded, const boost::numeric::ublas::matrix<T>& mat) {
+  if (padded.size1() != mat.size1() || padded.size2() != mat.size2()) return false;
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      if (padded(i,j) != mat(i,j)) return false;
+    }
+  }
+  return true;
+}
+
+
+/// Checks that rows of a padded matrix are aligned and an odd number of cache 
+/// lines apart, and that copies are aligned too.
+template <class T>
+bool test_pitch(size_t cols) {
+  basic_padded_matrix<T> mat(3, cols);
+  basic_padded_matrix<T> copy(mat);
+  const size_t line = basic_padded_matrix<T>::alignment;
+  const size_t bytes = mat.pitch() * sizeof(T);
+
+  bool pass = (mat.pitch() >= cols) 
+    && (bytes % line == 0) && ((bytes / line) % 2 == 1)
+    && (reinterpret_cast<uintptr_t>(mat.data()) % line == 0)
+    && (reinterpret_cast<uintptr_t>(copy.data()) % line == 0)
+    && (copy.pitch() == mat.pitch());
+
+  if (verbose) cout << setw(6) << cols << " x " << sizeof(T) << " bytes: pitch " 
+                    << setw(6) << mat.pitch() << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Transforms a rows x cols matrix with W, once as a ublas matrix and once as a 
+/// padded matrix, and checks that the results are identical.
+template <class W>
+bool test_transform(const char *name, size_t rows, size_t cols) {
+  typedef typename W::matrix_type matrix_type;
+  typedef typename W::padded_type padded_type;
+  W wt;
+  matrix_type mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+  padded_type padded(mat);
+
+  int level = wt.fwt_2d(mat);
+  wt.fwt_2d(padded);
+  bool fwt_pass = same(padded, mat);
+
+  wt.iwt_2d(mat, level);
+  wt.iwt_2d(padded, level);
+  bool iwt_pass = same(padded, mat);
+
+  if (verbose) cout << setw(8) << name << " " << rows << " x " << cols << ":  \t"
+                    << "FWT " << (fwt_pass ? "PASS" : "FAIL") 
+                    << "\tIWT " << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// Checks that a padded matrix encodes to the same bytes as a ublas matrix, and
+/// decodes to the same values.
+bool test_ezw(size_t rows, size_t cols) {
+  nami_matrix mat(rows, cols);
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*i*j);
+    }
+  }
+
+  wt_lift lift;
+  int level = lift.fwt_2d(mat);
+  padded_matrix padded(mat);
+
+  ezw_encoder encoder;
+  ostringstream plain_out, padded_out;
+  encoder.encode(mat, plain_out, level);
+  encoder.encode(padded, padded_out, level);
+  bool encode_pass = (plain_out.str() == padded_out.str());
+
+  ezw_decoder decoder;
+  istringstream plain_in(plain_out.str()), padded_in(padded_out.str());
+  nami_matrix plain_decoded;
+  padded_matrix padded_decoded;
+  decoder.decode(plain_in, plain_decoded);
+  decoder.decode(padded_in, padded_decoded);
+  bool decode_pass = same(padded_decoded, plain_decoded);
+
+  if (verbose) cout << "     ezw " << rows << " x " << cols << ":  \t"
+                    << "ENCODE " << (encode_pass ? "PASS" : "FAIL") 
+                    << "\tDECODE " << (decode_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (encode_pass && decode_pass);
+}
+
+
+/// This test checks that padded matrices transform and code exactly like 
+/// unpadded ones.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t widths[] = {1, 7, 8, 16, 100, 128, 4096};
+  size_t num_widths = (sizeof(widths) / sizeof(size_t));
+  for (size_t i=0; i < num_widths; i++) {
+    if (!test_pitch<double>(widths[i])) pass = false;
+    if (!test_pitch<float>(widths[i]))  pass = false;
+  }
+
+  size_t sizes[] = {16, 136, 256, 394};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t r=0; r < num_sizes; r++) {
+    for (size_t c=0; c < num_sizes; c++) {
+      if (!test_transform<wt_lift>("lift", sizes[r], sizes[c]))     pass = false;
+      if (!test_transform<wt_lift_f>("lift_f", sizes[r], sizes[c])) pass = false;
+      if (!test_transform<wt_direct>("direct", sizes[r], sizes[c])) pass = false;
+      if (!test_ezw(sizes[r], sizes[c])) pass = false;
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
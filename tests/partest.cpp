@@ -42,6 +42,16 @@
 using namespace std;
 using namespace nami;
 
+/// True if padded holds exactly the values in mat.
+bool same(const padded_matrix& padded, const nami_matrix& mat) {
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      if (padded(i,j) != mat(i,j)) return false;
+    }
+  }
+  return true;
+}
+
 /// This verifies that the parallel wavelet transform produces
 /// exactly the same output as the convolving transform.
 int main(int argc, char **argv) {
@@ -77,8 +87,13 @@ int main(int argc, char **argv) {
     par_wt::gather(original, mat, MPI_COMM_WORLD);
 
     // do parallel transform on all data, record parallel transform's level
+    padded_matrix padded(mat);
     level = pwt.fwt_2d(mat, level);
 
+    // padded matrices exchange halos with their own pitch, but should match
+    pwt.fwt_2d(padded, level);
+    bool padded_pass = same(padded, mat);
+
     // do local transform at same level
     nami_matrix localwt;
     if (rank == 0) {
@@ -103,6 +118,12 @@ int main(int argc, char **argv) {
 
     // do parallel inverse transform, compare to local inverse
     pwt.iwt_2d(mat, level);
+    pwt.iwt_2d(padded, level);
+    padded_pass = padded_pass && same(padded, mat);
+
+    int local_padded = padded_pass, all_padded;
+    MPI_Allreduce(&local_padded, &all_padded, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!all_padded) pass = false;
     nami_matrix par_iwt;
     par_wt::gather(par_iwt, mat, MPI_COMM_WORLD);
     if (rank == 0) {
@@ -114,13 +135,68 @@ int main(int argc, char **argv) {
       }
 
       if (verbose) {
-        cout << setw(12) << matrix_utils::nrmse(localwt, par_iwt);
+        cout << setw(12) << matrix_utils::nrmse(localwt, par_iwt)
+             << "   padded " << (all_padded ? "PASS" : "FAIL");
       }
     }
 
     if (verbose && rank == 0) cout << endl;
   }
 
+  // Transforms of one shape reuse the communication set up by the first one, 
+  // and give the same results every time.
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((.06 + rank) * (5+i+0.4*i*i-0.02*i*i*j));
+    }
+  }
+  nami_matrix input = mat;
+  int level = pwt.fwt_2d(mat);
+  nami_matrix fwt = mat;
+  pwt.iwt_2d(mat, level);
+  nami_matrix iwt = mat;
+
+  bool repeat_pass = true;
+  for (int i=0; i < 3; i++) {
+    mat = input;
+    pwt.fwt_2d(mat, level);
+    if (matrix_utils::nrmse(fwt, mat) > 0) repeat_pass = false;
+    pwt.iwt_2d(mat, level);
+    if (matrix_utils::nrmse(iwt, mat) > 0) repeat_pass = false;
+  }
+  int local_repeat = repeat_pass, all_repeat;
+  MPI_Allreduce(&local_repeat, &all_repeat, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  if (!all_repeat) pass = false;
+  if (verbose && rank == 0) {
+    cout << "Repeated transforms " << (all_repeat ? "PASS" : "FAIL") << endl;
+  }
+
+  // The plan outlives the communicator it was made for.  Once that's freed, a new
+  // one with the ranks reversed (which may reuse its handle) must be planned afresh,
+  // and transform just like a new par_wt on it.
+  {
+    MPI_Comm first, reversed;
+    MPI_Comm_dup(MPI_COMM_WORLD, &first);
+    mat = input;
+    pwt.fwt_2d(mat, level, first);
+    MPI_Comm_free(&first);
+    MPI_Comm_split(MPI_COMM_WORLD, 0, size - rank, &reversed);
+
+    par_wt fresh_wt;
+    nami_matrix fresh = input;
+    fresh_wt.fwt_2d(fresh, level, reversed);
+    mat = input;
+    pwt.fwt_2d(mat, level, reversed);
+    MPI_Comm_free(&reversed);
+
+    int local_comm = (matrix_utils::nrmse(fresh, mat) == 0), all_comm;
+    MPI_Allreduce(&local_comm, &all_comm, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!all_comm) pass = false;
+    if (verbose && rank == 0) {
+      cout << "Freed communicator " << (all_comm ? "PASS" : "FAIL") << endl;
+    }
+  }
+
 
   if (verbose && rank == 0) {
     cout << (pass ? "PASSED" : "FAILED") << endl;
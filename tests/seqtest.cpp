@@ -151,6 +151,12 @@ int main(int argc, char **argv) {
     }
   } 
 
+  // odd sizes, whose low bands are one longer than their high bands
+  for (size_t p=0; p < num_primes; p++) {
+    if (!test_1d(primes[p])) pass = false;
+    if (!test_1d(primes[p] * 4 + 1)) pass = false;
+  }
+
   if (verbose) {
     cerr << endl << "===== 2 Dimensional Tranform =====" << endl;
   }
@@ -170,6 +176,14 @@ int main(int argc, char **argv) {
           if (!test_2d(primes[p] * (1<<r), primes[q] * (1 << c))) {
             pass = false;
           }
+
+  // odd sizes, and odd by even
+  for (size_t p=0; p < num_primes-1; p++) {
+    for (size_t q=0; q < num_primes-1; q++) {
+      if (!test_2d(primes[p], primes[q])) pass = false;
+      if (!test_2d(primes[p] * 4 + 1, primes[q] * 2)) pass = false;
+    }
+  }
   
   if (verbose) {
     cout << (pass ? "PASSED" : "FAILED") << endl;
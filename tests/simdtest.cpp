@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+
+#include "wt_lift.h"
+#include "simd_lift.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE   = 1.0e-12;
+static const double TOLERANCE_F = 1.0e-5;   // for single precision
+
+bool verbose = false;
+
+
+/// Compares the transform done with <isa> kernels to the scalar transform for
+/// a rows x cols matrix.  Also checks that the vector inverse undoes the transform.
+/// W is wt_lift or wt_lift_f.
+template <class W>
+bool test_isa(simd::isa_t isa, size_t rows, size_t cols, double tolerance) {
+  static W scalar;
+  static W vectorized;
+  typename W::matrix_type mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  scalar.set_isa(simd::SCALAR);
+  vectorized.set_isa(isa);
+
+  typename W::matrix_type expected = mat;
+  typename W::matrix_type actual = mat;
+
+  scalar.fwt_2d(expected);
+  vectorized.fwt_2d(actual);
+  double fwt_err = matrix_utils::nrmse(expected, actual);
+  bool fwt_pass = (fwt_err <= tolerance);
+
+  vectorized.iwt_2d(actual);
+  double iwt_err = matrix_utils::nrmse(mat, actual);
+  bool iwt_pass = (iwt_err <= tolerance);
+
+  const bool single = (sizeof(typename W::matrix_type::value_type) == sizeof(float));
+  if (verbose) cout << setw(8) << simd::isa_to_str(vectorized.isa()) 
+                    << setw(7) << (single ? "float" : "double")
+                    << " " << rows << " x " << cols << ":  \t"
+                    << setw(16) << fwt_err 
+                    << "\t" << (fwt_pass ? "PASS" : "FAIL") 
+                    << setw(16) << iwt_err 
+                    << "\t" << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// This test checks that all vectorized lifting kernels supported by the CPU
+/// agree with the scalar kernels, including on sizes that leave vector remainders.
+/// Both double and float kernels are checked.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  simd::isa_t best = simd::detect_isa();
+  if (verbose) cout << "Detected " << simd::isa_to_str(best) << endl;
+
+  size_t sizes[] = {2, 4, 6, 12, 24, 34, 64, 136, 256, 394};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (int isa = simd::SSE2; isa <= best; isa++) {
+    for (size_t r=0; r < num_sizes; r++) {
+      for (size_t c=0; c < num_sizes; c++) {
+        simd::isa_t i = (simd::isa_t)isa;
+        if (!test_isa<wt_lift>(i, sizes[r], sizes[c], TOLERANCE))     pass = false;
+        if (!test_isa<wt_lift_f>(i, sizes[r], sizes[c], TOLERANCE_F)) pass = false;
+      }
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,222 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_1d_lift.h"
+#include "wt_1d_stream.h"
+#include "ezw_stream.h"
+#include "two_utils.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+/// A timeline: a slow trend, a periodic part, some noise, and a jump.
+template <class T>
+void fill_signal(vector<T>& signal, size_t n) {
+  signal.resize(n);
+  srand(19);
+  for (size_t i=0; i < n; i++) {
+    signal[i] = (T)(0.001 * i + sin(i * 0.05) + 0.05 * (rand() / (double)RAND_MAX) 
+                    + ((i > n / 3) ? 2.0 : 0.0));
+  }
+}
+
+
+template <class T>
+double max_diff(const vector<T>& a, const vector<T>& b) {
+  if (a.size() != b.size()) return HUGE_VAL;
+  double diff = 0;
+  for (size_t i=0; i < a.size(); i++) {
+    diff = max(diff, (double)fabs(a[i] - b[i]));
+  }
+  return diff;
+}
+
+
+/// Pushes a signal a sample at a time, and checks the coefficients against 
+/// wt_1d_lift on the whole signal, and that they invert back to the signal.
+template <class S>
+bool test_transform(size_t n, int levels) {
+  vector<double> signal;
+  fill_signal(signal, n);
+
+  wt_1d_stream wt;
+  wt.set_scheme<S>();
+  coeff_vector coeffs;
+  wt.start(coeffs, levels);
+  for (size_t i=0; i < n; i++) {
+    wt.push(signal[i]);
+  }
+  wt.finish();
+
+  wt_1d_lift lift;
+  lift.set_scheme<S>();
+  vector<double> expected(signal);
+  lift.fwt_1d(&expected[0], n, levels);
+  const double err = max_diff(expected, coeffs.data());
+
+  lift.iwt_1d(&coeffs.data()[0], n, levels);
+  const double inv_err = max_diff(signal, coeffs.data());
+
+  bool pass = (err == 0 && inv_err < 1e-10 && wt.size() == n);
+  if (verbose) cout << setw(6) << S::name() << " " << setw(7) << n << " samples, " 
+                    << levels << " levels:  \t" << err << "\t" << inv_err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Streams a signal through the encoder and back, and checks that the decoded 
+/// coefficients are the quantized ones.  With a pass limit, checks the error 
+/// instead.  Returns the encoded size in size.
+template <class T>
+bool test_coding(size_t n, int levels, size_t block_trees, size_t pass_limit = 0, 
+                 size_t *size = 0) {
+  vector<T> signal;
+  fill_signal(signal, n);
+  const quantized_t scale = 1000;
+
+  basic_wt_1d_stream<T> wt;
+  basic_coeff_vector<T> coeffs;
+  wt.start(coeffs, levels);
+  wt.push(signal.empty() ? 0 : &signal[0], n);
+  wt.finish();
+  vector<T> expected(coeffs.data());
+  for (size_t i=0; i < n; i++) {
+    expected[i] = (T)(round(expected[i] * scale) / (double)scale);
+  }
+
+  ostringstream out;
+  basic_ezw_stream_encoder<T> encoder(out);
+  encoder.set_scale(scale);
+  encoder.set_block_trees(block_trees);
+  encoder.set_pass_limit(pass_limit);
+  wt.start(encoder, levels);
+  for (size_t i=0; i < n; i++) {
+    wt.push(signal[i]);
+  }
+  wt.finish();
+
+  istringstream in(out.str());
+  ezw_stream_decoder decoder;
+  basic_coeff_vector<T> decoded;
+  const size_t decoded_n = decoder.decode(in, decoded);
+  const double err = max_diff(expected, decoded.data());
+
+  // without a pass limit coding is exact; with one, stays near the coefficients.
+  double bound = pass_limit ? 0.2 * max_diff(vector<T>(n), expected) : 0;
+  bool pass = (decoded_n == n && decoded.levels() == levels && err <= bound
+               && encoder.bytes() == out.str().size());
+  if (size) *size = out.str().size();
+  if (verbose) cout << "code " << setw(7) << n << " samples, " << levels << " levels, "
+                    << block_trees << " trees/block, " << pass_limit << " passes: " 
+                    << setw(8) << out.str().size() << " bytes, err " << err << "\t"
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Blocks are written while the signal streams, not held until it ends.
+bool test_streaming(size_t n, int levels) {
+  vector<double> signal;
+  fill_signal(signal, n);
+
+  ostringstream out;
+  ezw_stream_encoder encoder(out);
+  encoder.set_scale(1000);
+  wt_1d_stream wt;
+  wt.start(encoder, levels);
+
+  size_t half_bytes = 0;
+  for (size_t i=0; i < n; i++) {
+    wt.push(signal[i]);
+    if (i == n / 2) half_bytes = encoder.bytes();
+  }
+  wt.finish();
+
+  const size_t total = encoder.bytes();
+  bool pass = (half_bytes > total / 4 && total < n * sizeof(double));
+  if (verbose) cout << "streaming " << n << " samples: " << half_bytes << " bytes at half, " 
+                    << total << " at end\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks the streaming 1d transform against wt_1d_lift, and the 
+/// streaming EZW coder against the quantized coefficients.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_transform<cdf97>(1024, 6))  pass = false;
+  if (!test_transform<cdf97>(1001, 5))  pass = false;
+  if (!test_transform<cdf97>(777, 9))   pass = false;
+  if (!test_transform<cdf97>(37, 3))    pass = false;
+  if (!test_transform<cdf97>(9, 3))     pass = false;
+  if (!test_transform<cdf97>(2, 1))     pass = false;
+  if (!test_transform<cdf97>(100, 0))   pass = false;
+  if (!test_transform<cdf53>(515, 4))   pass = false;
+  if (!test_transform<haar>(333, 8))    pass = false;
+
+  if (!test_coding<double>(5000, 6, 0))  pass = false;
+  if (!test_coding<double>(4099, 5, 3))  pass = false;
+  if (!test_coding<double>(1001, 4, 1))  pass = false;
+  if (!test_coding<double>(37, 3, 2))    pass = false;
+  if (!test_coding<double>(3, 3, 0))     pass = false;
+  if (!test_coding<double>(1, 2, 0))     pass = false;
+  if (!test_coding<double>(0, 2, 0))     pass = false;
+  if (!test_coding<double>(500, 0, 16))  pass = false;
+  if (!test_coding<float>(3000, 5, 0))   pass = false;
+
+  size_t full, limited;
+  if (!test_coding<double>(20000, 8, 0, 0, &full))    pass = false;
+  if (!test_coding<double>(20000, 8, 0, 8, &limited)) pass = false;
+  if (!(limited < full)) pass = false;
+
+  if (!test_streaming(100000, 6)) pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_stream.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-12;
+
+bool verbose = false;
+
+
+/// Rows of a matrix in memory, as a source.
+struct matrix_row_source : public row_source {
+  nami_matrix& mat;
+  size_t row;
+  matrix_row_source(nami_matrix& m) : mat(m), row(0) { }
+  void read_row(double *values, size_t cols) {
+    copy(&mat(row, 0), &mat(row, 0) + cols, values);
+    row++;
+  }
+};
+
+
+void fill_matrix(nami_matrix& mat, size_t rows, size_t cols) {
+  mat.resize(rows, cols);
+  srand(300);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX) * 0.1 + i + 0.4*i*i - 0.02*i*j + sin(j * 0.3));
+    }
+  }
+}
+
+
+/// Streams a matrix through wt_stream into a matrix, and checks it against wt_lift.
+template <class S>
+bool test_stream(size_t rows, size_t cols, int level) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  wt_lift lift;
+  lift.set_scheme<S>();
+  nami_matrix expected = mat;
+  int expected_level = lift.fwt_2d(expected, level);
+
+  wt_stream stream;
+  stream.set_scheme<S>();
+  nami_matrix actual(rows, cols);
+  actual.clear();
+  matrix_row_source source(mat);
+  matrix_row_sink sink(actual);
+  int actual_level = stream.fwt_2d(source, sink, rows, cols, level);
+
+  double err = matrix_utils::nrmse(expected, actual);
+  bool pass = (err <= TOLERANCE && stream.done() && actual_level == expected_level);
+  if (verbose) cout << setw(6) << S::name() << " " << rows << " x " << cols << ", " 
+                    << actual_level << " levels:  \t" << setw(16) << err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Streams raw rows from one stream to another, as with files, and inverts the
+/// result with wt_lift.
+bool test_files(size_t rows, size_t cols) {
+  nami_matrix mat;
+  fill_matrix(mat, rows, cols);
+
+  // string streams can't seek past their end, so the output starts out full size.
+  stringstream in, out;
+  vector<double> zeros(cols, 0.0);
+  for (size_t i=0; i < rows; i++) {
+    in.write((char*)&mat(i, 0), cols * sizeof(double));
+    out.write((char*)&zeros[0], cols * sizeof(double));
+  }
+
+  wt_stream stream;
+  istream_row_source source(in);
+  ostream_row_sink sink(out, cols);
+  int level = stream.fwt_2d(source, sink, rows, cols);
+
+  nami_matrix trans(rows, cols);
+  out.seekg(0);
+  for (size_t i=0; i < rows; i++) {
+    out.read((char*)&trans(i, 0), cols * sizeof(double));
+  }
+  wt_lift lift;
+  lift.iwt_2d(trans, level);
+
+  double err = matrix_utils::nrmse(mat, trans);
+  bool pass = (err <= TOLERANCE && out.good());
+  if (verbose) cout << "files " << rows << " x " << cols << ":  \t" << setw(16) << err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Rows pushed one at a time into a single-precision stream.
+bool test_float(size_t rows, size_t cols) {
+  nami_matrix_f mat(rows, cols);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = (float)(i * 0.5 + cos(j * 0.2));
+    }
+  }
+
+  wt_lift_f lift;
+  nami_matrix_f expected = mat;
+  lift.fwt_2d(expected);
+
+  wt_stream_f stream;
+  nami_matrix_f actual(rows, cols);
+  matrix_row_sink_f sink(actual);
+  stream.start(rows, cols, sink);
+  for (size_t i=0; i < rows; i++) {
+    stream.push_row(&mat(i, 0));
+  }
+
+  double err = 0;
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      err = max(err, (double)fabs(expected(i,j) - actual(i,j)));
+    }
+  }
+  bool pass = (err <= 1e-3 && stream.done());
+  if (verbose) cout << "float " << rows << " x " << cols << ":  \t" << setw(16) << err << "\t" 
+                    << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks that the line-based transform in wt_stream matches wt_lift.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t sizes[][2] = {{64, 64}, {128, 32}, {37, 20}, {300, 257}, {1, 50}, {50, 1}, {3, 5}, {2, 2}};
+  size_t num_sizes = (sizeof(sizes) / sizeof(sizes[0]));
+  for (size_t s=0; s < num_sizes; s++) {
+    if (!test_stream<cdf97>(sizes[s][0], sizes[s][1], -1)) pass = false;
+    if (!test_stream<cdf53>(sizes[s][0], sizes[s][1], -1)) pass = false;
+    if (!test_stream<haar>(sizes[s][0], sizes[s][1], -1))  pass = false;
+  }
+  if (!test_stream<cdf97>(256, 256, 3)) pass = false;
+  if (!test_stream<cdf97>(99, 64, 1))   pass = false;
+  if (!test_stream<cdf97>(64, 64, 0))   pass = false;
+
+  if (!test_files(200, 120)) pass = false;
+  if (!test_float(90, 70))   pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "thread_utils.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+/// Transforms a rows x cols matrix with W on one thread and on several, and checks
+/// that the threaded forward and inverse transforms give identical results.
+template <class W>
+bool test_threads(const char *name, size_t threads, size_t rows, size_t cols) {
+  W sequential, threaded;
+  threaded.set_threads(threads);
+  nami_matrix mat(rows, cols);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  nami_matrix expected = mat;
+  nami_matrix actual = mat;
+  int level = sequential.fwt_2d(expected);
+  threaded.fwt_2d(actual);
+  bool fwt_pass = equal(expected.data().begin(), expected.data().end(), actual.data().begin());
+
+  sequential.iwt_2d(expected, level);
+  threaded.iwt_2d(actual, level);
+  bool iwt_pass = equal(expected.data().begin(), expected.data().end(), actual.data().begin());
+
+  if (verbose) cout << setw(8) << name << " " << threads << " threads, " 
+                    << rows << " x " << cols << ":  \t"
+                    << "FWT " << (fwt_pass ? "PASS" : "FAIL") 
+                    << "\tIWT " << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// Makes 2d (W) and 1d (W1) transforms on each thread of the application's own 
+/// parallel region, and checks that each thread's transforms match ones made 
+/// outside of it.
+template <class W, class W1>
+bool test_app_threads(const char *name, size_t threads, size_t rows, size_t cols) {
+  nami_matrix mat(rows, cols);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = (i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  W sequential;
+  nami_matrix expected = mat;
+  int level = sequential.fwt_2d(expected);
+  nami_matrix inverse = expected;
+  sequential.iwt_2d(inverse, level);
+
+  vector<double> signal(mat.data().begin(), mat.data().begin() + cols);
+  vector<double> expected_1d = signal;
+  W1 sequential_1d;
+  int level_1d = sequential_1d.fwt_1d(&expected_1d[0], cols);
+  vector<double> inverse_1d = expected_1d;
+  sequential_1d.iwt_1d(&inverse_1d[0], cols, level_1d);
+
+  vector<int> passed(threads, 1);   // without OpenMP, only the first is set
+  const int nthreads = threads;
+  #pragma omp parallel num_threads(nthreads)
+  {
+    W wt;
+    nami_matrix actual = mat;
+    wt.fwt_2d(actual);
+    bool ok = equal(expected.data().begin(), expected.data().end(), actual.data().begin());
+    wt.iwt_2d(actual, level);
+    ok = ok && equal(inverse.data().begin(), inverse.data().end(), actual.data().begin());
+
+    W1 wt_1d;
+    vector<double> actual_1d = signal;
+    wt_1d.fwt_1d(&actual_1d[0], cols);
+    ok = ok && equal(expected_1d.begin(), expected_1d.end(), actual_1d.begin());
+    wt_1d.iwt_1d(&actual_1d[0], cols, level_1d);
+    ok = ok && equal(inverse_1d.begin(), inverse_1d.end(), actual_1d.begin());
+    passed[thread_num()] = ok;
+  }
+  bool pass = (count(passed.begin(), passed.end(), 0) == 0);
+
+  if (verbose) cout << setw(8) << name << " in " << threads << " application threads, "
+                    << rows << " x " << cols << ":  \t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks that threaded 2d transforms match single-threaded ones exactly.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t threads[] = {0, 2, 3, 4};
+  size_t num_threads = (sizeof(threads) / sizeof(size_t));
+
+  size_t sizes[] = {16, 136, 256, 394};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t t=0; t < num_threads; t++) {
+    for (size_t r=0; r < num_sizes; r++) {
+      for (size_t c=0; c < num_sizes; c++) {
+        if (!test_threads<wt_lift>("lift", threads[t], sizes[r], sizes[c]))     pass = false;
+        if (!test_threads<wt_direct>("direct", threads[t], sizes[r], sizes[c])) pass = false;
+      }
+    }
+  }
+
+  if (!test_app_threads<wt_lift, wt_1d_lift>("lift", 4, 136, 394))       pass = false;
+  if (!test_app_threads<wt_direct, wt_1d_direct>("direct", 4, 136, 394)) pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,190 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "tiled_ezw.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+#include "matrix_utils.h"
+#include "two_utils.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+
+template <class T>
+void fill_matrix(boost::numeric::ublas::matrix<T>& mat, size_t rows, size_t cols) {
+  mat.resize(rows, cols);
+  srand(21);
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      mat(i,j) = (T)(sin(i * 0.05) * cos(j * 0.03) * 10 + 0.01 * (rand() / (double)RAND_MAX));
+    }
+  }
+}
+
+
+/// What the tiled coder should give for tile i: the tile transformed, coded and 
+/// decoded on its own with the plain classes.
+template <class T>
+void expected_tile(const boost::numeric::ublas::matrix<T>& mat, const tile_grid& grid, 
+                   size_t i, int level, boost::numeric::ublas::matrix<T>& out) {
+  size_t row, col, rows, cols;
+  grid.tile(i, row, col, rows, cols);
+  boost::numeric::ublas::matrix<T> tile(rows, cols);
+  for (size_t r=0; r < rows; r++) {
+    for (size_t c=0; c < cols; c++) tile(r, c) = mat(row + r, col + c);
+  }
+
+  const int l = (level < 0) ? levels_to_one(max(rows, cols)) 
+                            : min(level, levels_to_one(max(rows, cols)));
+  basic_wt_lift<T> wt;
+  wt.fwt_2d(tile, l);
+  ezw_encoder encoder;
+  encoder.set_scale(10000);
+  stringstream code;
+  encoder.encode(tile, code, l);
+  ezw_decoder decoder;
+  decoder.decode(code, out);
+  wt.iwt_2d(out, l);
+}
+
+
+/// Codes mat in tiles with 1 and 4 threads, and checks that the outputs are the
+/// same, that each tile decodes as it would alone, and that decode_tile() gives 
+/// the same tile as decode().
+template <class T>
+bool test_tiles(size_t rows, size_t cols, size_t tile_rows, size_t tile_cols, int level = -1) {
+  boost::numeric::ublas::matrix<T> mat;
+  fill_matrix(mat, rows, cols);
+
+  tiled_ezw_encoder encoder;
+  encoder.set_tile_size(tile_rows, tile_cols);
+  encoder.coder().set_scale(10000);
+  ostringstream serial, parallel;
+  const size_t bytes = encoder.encode(basic_matrix_view<T>(mat), serial, level);
+  encoder.set_threads(4);
+  encoder.encode(basic_matrix_view<T>(mat), parallel, level);
+  bool pass = (serial.str() == parallel.str() && bytes == serial.str().size());
+
+  tiled_ezw_decoder decoder;
+  decoder.set_threads(4);
+  boost::numeric::ublas::matrix<T> decoded;
+  istringstream in(serial.str());
+  decoder.decode(in, decoded);
+  const tile_grid& grid = decoder.grid();
+  if (decoded.size1() != rows || decoded.size2() != cols || grid.size() == 0) return false;
+
+  double tile_err = 0;
+  for (size_t i=0; i < grid.size(); i++) {
+    size_t row, col, trows, tcols;
+    grid.tile(i, row, col, trows, tcols);
+    boost::numeric::ublas::matrix<T> expected, single;
+    expected_tile(mat, grid, i, level, expected);
+
+    istringstream tile_in(serial.str());
+    decoder.decode_tile(tile_in, i, single);
+    for (size_t r=0; r < trows; r++) {
+      for (size_t c=0; c < tcols; c++) {
+        tile_err = max(tile_err, (double)fabs(decoded(row + r, col + c) - expected(r, c)));
+        tile_err = max(tile_err, (double)fabs(single(r, c) - expected(r, c)));
+      }
+    }
+  }
+
+  double err = 0;
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      err = max(err, (double)fabs(decoded(i, j) - mat(i, j)));
+    }
+  }
+  pass = pass && (tile_err == 0) && (err < 1e-3);
+
+  if (verbose) cout << (sizeof(T) == 4 ? "float  " : "double ") << rows << " x " << cols 
+                    << " in " << grid.size() << " tiles of " << tile_rows << " x " 
+                    << tile_cols << ": " << setw(8) << bytes << " bytes, err " << err 
+                    << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// ezw_decoder refuses tiled data rather than decoding garbage.
+bool test_plain_decoder() {
+  nami_matrix mat;
+  fill_matrix(mat, 64, 64);
+  tiled_ezw_encoder encoder;
+  encoder.set_tile_size(32, 32);
+  stringstream code;
+  encoder.encode(matrix_view(mat), code);
+
+  bool pass = false;
+  try {
+    ezw_decoder decoder;
+    decoder.decode(code, mat);
+  } catch (const runtime_error& e) {
+    pass = true;
+  }
+  if (verbose) cout << "ezw_decoder on tiled data throws:\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// This test checks tiled_ezw_encoder and tiled_ezw_decoder against coding each
+/// tile with the plain coder.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  if (!test_tiles<double>(256, 256, 64, 64))     pass = false;
+  if (!test_tiles<double>(300, 500, 64, 128))    pass = false;
+  if (!test_tiles<double>(100, 70, 32, 32, 3))   pass = false;
+  if (!test_tiles<double>(128, 128, 256, 256))   pass = false;
+  if (!test_tiles<double>(33, 65, 16, 16))       pass = false;
+  if (!test_tiles<float>(200, 200, 64, 64))      pass = false;
+  if (!test_plain_decoder())                     pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
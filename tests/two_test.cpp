@@ -25,6 +25,24 @@ int main(int argc, char **argv) {
     }
   }
 
+  // halving with rounding up: 1000 -> 500 -> 250 -> 125 -> 63 -> 32 -> 16 -> 8 -> 4 -> 2 -> 1
+  size_t lengths[] = {0, 1, 2, 3, 4, 5, 1000, 1024, 1025};
+  int levels[]     = {0, 0, 1, 2, 2, 3, 10,   10,   11};
+  for (size_t i=0; i < sizeof(lengths) / sizeof(size_t); i++) {
+    int result = levels_to_one(lengths[i]);
+    if (result != levels[i]) {
+      cout << "levels_to_one(" << lengths[i] << ") == " << result << endl;
+      if (verbose) cout << "FAILED.  Expected: " << levels[i] << endl;
+      pass = false;
+    }
+  }
+
+  if (low_band_size(1000, 3) != 125 || low_band_size(1000, 4) != 63 || 
+      low_band_size(1000, 10) != 1 || low_band_size(1025, 1) != 513) {
+    cout << "low_band_size FAILED." << endl;
+    pass = false;
+  }
+
   if (verbose) {
     cout << (pass ? "PASSED" : "FAILED") << endl;
   }
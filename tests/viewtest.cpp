@@ -0,0 +1,185 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include "nami_matrix.h"
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+
+using namespace std;
+using namespace nami;
+
+bool verbose = false;
+
+/// Extra values at the end of each row of the buffers viewed.
+static const size_t EXTRA = 5;
+
+/// Value left in the extra space, which nothing should touch.
+static const double GUARD = -12345.0;
+
+
+/// True if view holds exactly the values in mat.
+template <class T>
+bool same(const basic_matrix_view<T>& view, const boost::numeric::ublas::matrix<T>& mat) {
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      if (view(i,j) != mat(i,j)) return false;
+    }
+  }
+  return true;
+}
+
+
+/// True if the extra space after each row of the view is untouched.
+template <class T>
+bool guarded(const basic_matrix_view<T>& view) {
+  for (size_t i=0; i < view.size1(); i++) {
+    for (size_t j=view.size2(); j < view.pitch(); j++) {
+      if (view(i,j) != T(GUARD)) return false;
+    }
+  }
+  return true;
+}
+
+
+/// Transforms a rows x cols matrix with W, once as a ublas matrix and once in a
+/// plain buffer with wider rows, and checks that the results are identical and 
+/// that nothing outside the view changed.
+template <class W>
+bool test_transform(const char *name, size_t rows, size_t cols) {
+  typedef typename W::matrix_type matrix_type;
+  typedef typename W::view_type view_type;
+  typedef typename matrix_type::value_type value_type;
+  W wt;
+  matrix_type mat(rows, cols);
+  vector<value_type> buffer(rows * (cols + EXTRA), value_type(GUARD));
+  view_type view(&buffer[0], rows, cols, cols + EXTRA);
+
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = view(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*j*j);
+    }
+  }
+
+  int level = wt.fwt_2d(mat);
+  wt.fwt_2d(view);
+  bool fwt_pass = same(view, mat) && guarded(view);
+
+  wt.iwt_2d(mat, level);
+  wt.iwt_2d(view, level);
+  bool iwt_pass = same(view, mat) && guarded(view);
+
+  if (verbose) cout << setw(8) << name << " " << rows << " x " << cols << ":  \t"
+                    << "FWT " << (fwt_pass ? "PASS" : "FAIL") 
+                    << "\tIWT " << (iwt_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (fwt_pass && iwt_pass);
+}
+
+
+/// Checks that a view encodes to the same bytes as a ublas matrix, and that 
+/// decoding into a view gives the same values.
+bool test_ezw(size_t rows, size_t cols) {
+  nami_matrix mat(rows, cols);
+  srand(100);
+  for (size_t i=0; i < mat.size1(); i++) {
+    for (size_t j=0; j < mat.size2(); j++) {
+      mat(i,j) = ((rand()/(double)RAND_MAX)+i+0.4*i*i-0.02*i*i*j);
+    }
+  }
+
+  wt_lift lift;
+  int level = lift.fwt_2d(mat);
+  vector<double> buffer(rows * (cols + EXTRA), GUARD);
+  matrix_view view(&buffer[0], rows, cols, cols + EXTRA);
+  for (size_t i=0; i < rows; i++) {
+    copy(&mat(i,0), &mat(i,0) + cols, view.row(i));
+  }
+
+  ezw_encoder encoder;
+  ostringstream plain_out, view_out;
+  encoder.encode(mat, plain_out, level);
+  encoder.encode(view, view_out, level);
+  bool encode_pass = (plain_out.str() == view_out.str());
+
+  ezw_decoder decoder;
+  istringstream plain_in(plain_out.str()), view_in(view_out.str());
+  nami_matrix plain_decoded;
+  vector<double> decoded_buffer(rows * (cols + EXTRA), GUARD);
+  matrix_view view_decoded(&decoded_buffer[0], rows, cols, cols + EXTRA);
+  decoder.decode(plain_in, plain_decoded);
+  decoder.decode(view_in, view_decoded);
+  bool decode_pass = same(view_decoded, plain_decoded) && guarded(view_decoded);
+
+  if (verbose) cout << "     ezw " << rows << " x " << cols << ":  \t"
+                    << "ENCODE " << (encode_pass ? "PASS" : "FAIL") 
+                    << "\tDECODE " << (decode_pass ? "PASS" : "FAIL")
+                    << endl;
+
+  return (encode_pass && decode_pass);
+}
+
+
+/// This test checks that views of plain buffers transform and code exactly like 
+/// ublas matrices, and that nothing outside a view is touched.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  size_t sizes[] = {16, 136, 256, 394};
+  size_t num_sizes = (sizeof(sizes) / sizeof(size_t));
+
+  for (size_t r=0; r < num_sizes; r++) {
+    for (size_t c=0; c < num_sizes; c++) {
+      if (!test_transform<wt_lift>("lift", sizes[r], sizes[c]))     pass = false;
+      if (!test_transform<wt_lift_f>("lift_f", sizes[r], sizes[c])) pass = false;
+      if (!test_transform<wt_direct>("direct", sizes[r], sizes[c])) pass = false;
+      if (!test_ezw(sizes[r], sizes[c])) pass = false;
+    }
+  }
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}
@@ -0,0 +1,202 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC.  
+// Produced at the Lawrence Livermore National Laboratory  
+// Written by Todd Gamblin, tgamblin@llnl.gov.
+// LLNL-CODE-417602
+// All rights reserved.  
+// 
+// This file is part of Nami. For details, see http://github.com/tgamblin/nami.
+// Please also read the LICENSE file for further information.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+//  * Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the disclaimer below.
+//  * Redistributions in binary form must reproduce the above copyright notice, this list of
+//    conditions and the disclaimer (as noted below) in the documentation and/or other materials
+//    provided with the distribution.
+//  * Neither the name of the LLNS/LLNL nor the names of its contributors may be used to endorse
+//    or promote products derived from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "wt_lift.h"
+#include "wt_direct.h"
+#include "wt_3d.h"
+#include "cdf97.h"
+#include "ezw_encoder.h"
+#include "ezw_decoder.h"
+#include "matrix_utils.h"
+
+using namespace std;
+using namespace nami;
+
+static const double TOLERANCE = 1.0e-10;
+
+bool verbose = false;
+
+ezw_encoder encoder;
+ezw_decoder decoder;
+
+
+/// Fills a volume with frames stacked in a matrix.  Each frame is the same smooth
+/// matrix plus noise, drifting slowly over time, like a metric sampled at each 
+/// timestep.
+void fill_volume(nami_matrix& mat, size_t rows, size_t cols, size_t frames) {
+  mat.resize(rows * frames, cols);
+  srand(100);
+  for (size_t f=0; f < frames; f++) {
+    for (size_t i=0; i < rows; i++) {
+      for (size_t j=0; j < cols; j++) {
+        mat(f*rows + i, j) = ((rand()/(double)RAND_MAX) * 0.01 + i + 0.4*i*i - 0.02*i*i*j 
+                              + 0.5*f);
+      }
+    }
+  }
+}
+
+
+/// Checks that iwt_3d() undoes fwt_3d() with the row and column kernels of wt.
+bool test_transform(const char *name, wt_2d& wt, size_t rows, size_t cols, size_t frames) {
+  nami_matrix mat;
+  fill_volume(mat, rows, cols, frames);
+
+  wt_3d wt3(wt);
+  nami_matrix trans = mat;
+  int level = wt3.fwt_3d(volume_view(trans, frames));
+  wt3.iwt_3d(volume_view(trans, frames), level);
+
+  double err = matrix_utils::nrmse(mat, trans);
+  bool pass = (err <= TOLERANCE);
+  if (verbose) cout << setw(8) << name << " " << rows << " x " << cols << " x " << frames 
+                    << ", " << level << " levels:  \t" << setw(16) << err 
+                    << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// One level of fwt_3d() is separable: it matches transforming every frame in 2d
+/// and then every value over time.
+bool test_separable(size_t rows, size_t cols, size_t frames) {
+  nami_matrix mat;
+  fill_volume(mat, rows, cols, frames);
+
+  wt_lift lift;
+  nami_matrix expected = mat;
+  for (size_t f=0; f < frames; f++) {
+    lift.fwt_2d(matrix_view(&expected(f*rows, 0), rows, cols), 1);
+  }
+  for (size_t i=0; i < rows; i++) {
+    for (size_t j=0; j < cols; j++) {
+      lift.fwt_col(&expected(i, j), rows * cols, frames);
+    }
+  }
+
+  wt_3d wt3(lift);
+  nami_matrix actual = mat;
+  wt3.fwt_3d(volume_view(actual, frames), 1);
+
+  double err = matrix_utils::nrmse(expected, actual);
+  bool pass = (err <= TOLERANCE);
+  if (verbose) cout << "separable " << rows << " x " << cols << " x " << frames << ":  \t" 
+                    << setw(16) << err << "\t" << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+
+/// Codes a transformed volume with 3d zerotrees and checks that it decodes exactly.
+/// Coefficients are quantized first so that the coding is lossless.  The volume's
+/// frames are also coded one at a time in 2d, and the 3d code must be smaller.
+bool test_coding(size_t rows, size_t cols, size_t frames) {
+  nami_matrix mat;
+  fill_volume(mat, rows, cols, frames);
+
+  wt_lift lift;
+  wt_3d wt3(lift);
+  nami_matrix trans = mat;
+  int level = wt3.fwt_3d(volume_view(trans, frames));
+  for (size_t i=0; i < trans.size1(); i++) {
+    for (size_t j=0; j < trans.size2(); j++) {
+      trans(i,j) = (long long)(trans(i,j) * 1000);
+    }
+  }
+
+  ostringstream out;
+  size_t size_3d = encoder.encode(volume_view(trans, frames), out, level);
+
+  istringstream in(out.str());
+  nami_matrix decoded;
+  decoder.decode(in, decoded);
+  bool exact = (decoder.frames() == frames && decoded.size1() == trans.size1() &&
+                decoded.size2() == trans.size2() && matrix_utils::nrmse(trans, decoded) == 0);
+
+  // code each frame, transformed and quantized the same way, on its own.
+  size_t size_2d = 0;
+  for (size_t f=0; f < frames; f++) {
+    nami_matrix frame(rows, cols);
+    for (size_t i=0; i < rows; i++) {
+      for (size_t j=0; j < cols; j++) frame(i,j) = mat(f*rows + i, j);
+    }
+    int frame_level = lift.fwt_2d(frame);
+    for (size_t i=0; i < rows; i++) {
+      for (size_t j=0; j < cols; j++) frame(i,j) = (long long)(frame(i,j) * 1000);
+    }
+    ostringstream frame_out;
+    size_2d += encoder.encode(frame, frame_out, frame_level);
+  }
+  bool smaller = (size_3d < size_2d);
+
+  if (verbose) cout << "coding " << rows << " x " << cols << " x " << frames << ":  \t" 
+                    << "3d " << size_3d << " bytes, 2d frames " << size_2d << " bytes\t"
+                    << (exact ? "PASS" : "FAIL") << "\t" << (smaller ? "PASS" : "FAIL") << endl;
+  return exact && smaller;
+}
+
+
+/// This test checks the 3d transform with lifting and convolution kernels, and the
+/// 3d zerotree coding of transformed volumes.
+int main(int argc, char **argv) {
+  bool pass = true;
+  for (int i=1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+  }
+
+  wt_lift lift;
+  wt_direct direct(filter::getCDF97());
+
+  size_t sizes[][3] = {{16, 16, 8}, {64, 32, 16}, {34, 20, 5}, {17, 64, 12}, {1, 64, 8}};
+  size_t num_sizes = (sizeof(sizes) / sizeof(sizes[0]));
+  for (size_t s=0; s < num_sizes; s++) {
+    if (!test_transform("lift", lift, sizes[s][0], sizes[s][1], sizes[s][2]))     pass = false;
+    if (!test_transform("direct", direct, sizes[s][0], sizes[s][1], sizes[s][2])) pass = false;
+  }
+
+  if (!test_separable(16, 24, 8)) pass = false;
+  if (!test_separable(17, 10, 5)) pass = false;
+
+  if (!test_coding(32, 32, 8))   pass = false;
+  if (!test_coding(64, 48, 16))  pass = false;
+  if (!test_coding(40, 24, 4))   pass = false;
+  if (!test_coding(33, 16, 8))   pass = false;
+
+  if (verbose) {
+    cout << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  exit(pass ? 0 : 1);
+}